@@ -0,0 +1,540 @@
+//
+// Kernel benchmark of incflo: times the tile kernels on synthetic data, without the
+// rest of the solver, so that kernel rewrites and compiler upgrades can be checked
+// without full runs.
+//
+//   ./incflo_bench3d.gnu.OMP.ex [inputs] [bench.n_cell=128 ...]
+//
+//   bench.n_cell     cells of the (periodic, unit) domain in each direction (default 64)
+//   bench.tile_size  cells of each box in each direction; each box is one tile (default 32)
+//   bench.geometry   "regular", or "cut" for a lattice of spheres with one sphere per box,
+//                    which also times the cut-cell kernels (default "cut")
+//   bench.radius     radius of the spheres relative to the box size (default 0.35)
+//   bench.repeat     timed sweeps over all the boxes per kernel (default 10)
+//   bench.threads    OpenMP thread counts of the scaling study (default: 1 and the maximum)
+//
+// For each kernel and thread count this prints the time of a sweep, the cells per second
+// and the achieved bandwidth, from an estimate of the bytes a kernel has to move per cell
+// (each array it reads or writes once, 8 bytes per value and 4 per EB cell flag), and the
+// speedup over the first thread count.
+//
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_AllRegular.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EBMultiFabUtil.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <convection_F.H>
+#include <convection_kernels.H>
+#include <derive_F.H>
+#include <derive_kernels.H>
+#include <diffusion_F.H>
+#include <rheology_F.H>
+#include <setup_F.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <functional>
+#include <iomanip>
+
+using namespace amrex;
+
+namespace
+{
+    // Spheres centred in the boxes of a lattice with the given period (the box size),
+    // with the fluid outside: positive in the body, as EB2 expects
+    class LatticeSpheresIF
+    {
+    public:
+        LatticeSpheresIF(Real period, Real radius)
+            : m_period(period), m_radius(radius)
+        {
+        }
+
+        Real operator()(AMREX_D_DECL(Real x, Real y, Real z)) const noexcept
+        {
+            const Real p[AMREX_SPACEDIM] = {AMREX_D_DECL(x, y, z)};
+            Real d2 = 0.0;
+            for(int d = 0; d < AMREX_SPACEDIM; d++)
+            {
+                Real dp = std::fmod(p[d], m_period) - 0.5 * m_period;
+                d2 += dp * dp;
+            }
+            return m_radius * m_radius - d2;
+        }
+
+        Real operator()(const RealArray& p) const noexcept
+        {
+            return this->operator()(AMREX_D_DECL(p[0], p[1], p[2]));
+        }
+
+    private:
+        Real m_period;
+        Real m_radius;
+    };
+
+    struct Kernel
+    {
+        std::string name;
+        Real bytes_per_cell;
+        std::function<void()> sweep;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+    int n_cell = 64;
+    int tile_size = 32;
+    std::string geometry = "cut";
+    Real radius = 0.35;
+    int repeat = 10;
+    Vector<int> threads;
+
+    ParmParse pp("bench");
+    pp.query("n_cell", n_cell);
+    pp.query("tile_size", tile_size);
+    pp.query("geometry", geometry);
+    pp.query("radius", radius);
+    pp.query("repeat", repeat);
+    pp.queryarr("threads", threads);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n_cell % tile_size == 0, "bench.n_cell must be a multiple of bench.tile_size");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(geometry == "regular" || geometry == "cut",
+                                     "bench.geometry must be regular or cut");
+    const bool cut = (geometry == "cut");
+
+    int max_threads = 1;
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+    if(threads.empty())
+    {
+        threads.push_back(1);
+        if(max_threads > 1) threads.push_back(max_threads);
+    }
+
+    // Periodic unit domain, chopped into boxes of tile_size
+    const int ng = 5;
+    Box domain(IntVect(AMREX_D_DECL(0, 0, 0)), IntVect(AMREX_D_DECL(n_cell - 1, n_cell - 1, n_cell - 1)));
+    RealBox rb({AMREX_D_DECL(0.0, 0.0, 0.0)}, {AMREX_D_DECL(1.0, 1.0, 1.0)});
+    Array<int, AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1, 1, 1)};
+    Geometry geom(domain, rb, 0, is_periodic);
+    const Real* dx = geom.CellSize();
+
+    BoxArray ba(domain);
+    ba.maxSize(tile_size);
+    DistributionMapping dm(ba);
+
+    if(cut)
+    {
+        LatticeSpheresIF spheres(tile_size * dx[0], radius * tile_size * dx[0]);
+        EB2::Build(EB2::makeShop(spheres), geom, 0, 30);
+    }
+    else
+    {
+        EB2::Build(EB2::makeShop(EB2::AllRegularIF()), geom, 0, 30);
+    }
+    std::unique_ptr<EBFArrayBoxFactory> factory = makeEBFabFactory(geom, ba, dm, {ng, ng, ng},
+                                                                    EBSupport::full);
+
+    const auto& flags = factory->getMultiEBCellFlagFab();
+    const auto& areafrac = factory->getAreaFrac();
+    const auto& facecent = factory->getFaceCent();
+    const MultiFab& volfrac = factory->getVolFrac();
+    const MultiCutFab& bndrycent = factory->getBndryCent();
+
+    // Fields, with a smooth velocity and uniform density and viscosity
+    MultiFab vel(ba, dm, 3, ng, MFInfo(), *factory);
+    MultiFab ro(ba, dm, 1, ng, MFInfo(), *factory);
+    MultiFab eta(ba, dm, 1, ng, MFInfo(), *factory);
+    MultiFab conv(ba, dm, 3, 0, MFInfo(), *factory);
+    MultiFab divtau(ba, dm, 3, 0, MFInfo(), *factory);
+    MultiFab xslopes(ba, dm, 3, ng, MFInfo(), *factory);
+    MultiFab yslopes(ba, dm, 3, ng, MFInfo(), *factory);
+    MultiFab zslopes(ba, dm, 3, ng, MFInfo(), *factory);
+    MultiFab strainrate(ba, dm, 1, ng, MFInfo(), *factory);
+    MultiFab nu_t(ba, dm, 1, ng, MFInfo(), *factory);
+    MultiFab vort(ba, dm, 1, ng, MFInfo(), *factory);
+    MultiFab eb_vel(ba, dm, 3, ng, MFInfo(), *factory);
+    Array<std::unique_ptr<MultiFab>, 3> mac;
+    for(int dir = 0; dir < 3; dir++)
+    {
+        BoxArray edge_ba = ba;
+        if(dir < AMREX_SPACEDIM) edge_ba.surroundingNodes(dir);
+        mac[dir].reset(new MultiFab(edge_ba, dm, 1, ng, MFInfo(), *factory));
+        mac[dir]->setVal(0.1);
+    }
+
+    for(MFIter mfi(vel); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& v = vel.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+            Real x = 2.0 * M_PI * (i + 0.5) * dx[0];
+            Real y = 2.0 * M_PI * (j + 0.5) * dx[1];
+            Real z = (AMREX_SPACEDIM == 3) ? 2.0 * M_PI * (k + 0.5) * dx[AMREX_SPACEDIM - 1] : 0.0;
+            v(i,j,k,0) =  std::sin(x) * std::cos(y) * std::cos(z);
+            v(i,j,k,1) = -std::cos(x) * std::sin(y) * std::cos(z);
+            v(i,j,k,2) =  0.1 * std::sin(z);
+        }
+    }
+    EB_set_covered(vel, 0.0);
+    vel.FillBoundary(geom.periodicity());
+    ro.setVal(1.0);
+    eta.setVal(0.01);
+    xslopes.setVal(0.0);
+    yslopes.setVal(0.0);
+    zslopes.setVal(0.0);
+    strainrate.setVal(1.0);
+    nu_t.setVal(0.0);
+    eb_vel.setVal(0.0);
+
+    // The kernels are handed a domain larger than the periodic one, so that no tile
+    // touches its boundary and the boundary types (all zero) are never used
+    Box kdomain = amrex::grow(domain, ng + 1);
+    Box domainx = kdomain; domainx.grow(1, ng); domainx.grow(2, ng);
+    Box domainy = kdomain; domainy.grow(0, ng); domainy.grow(2, ng);
+    Box domainz = kdomain; domainz.grow(0, ng); domainz.grow(1, ng);
+    IArrayBox bc_ilo(amrex::adjCellLo(domainx, 0, 1), 2), bc_ihi(amrex::adjCellHi(domainx, 0, 1), 2);
+    IArrayBox bc_jlo(amrex::adjCellLo(domainy, 1, 1), 2), bc_jhi(amrex::adjCellHi(domainy, 1, 1), 2);
+    IArrayBox bc_klo(amrex::adjCellLo(domainz, 2, 1), 2), bc_khi(amrex::adjCellHi(domainz, 2, 1), 2);
+    for(IArrayBox* bc : {&bc_ilo, &bc_ihi, &bc_jlo, &bc_jhi, &bc_klo, &bc_khi})
+    {
+        bc->setVal(0);
+    }
+
+    // Physical constants of the Fortran module, for a given rheology
+    auto set_constants = [&](const std::string& fluid_model)
+    {
+        int is_cyclic[3] = {1, 1, 1};
+        Real delp[3] = {0.0, 0.0, 0.0};
+        Real gravity[3] = {0.0, 0.0, 0.0};
+        Real ro_0 = 1.0, mu = 0.01, ic_u = 0.0, ic_v = 0.0, ic_w = 0.0, ic_p = 0.0;
+        Real n = 0.5, tau_0 = 0.1, papa_reg = 1.0e-3, eta_0 = 1.0, r_lo = 0.0;
+        int redist_type = 0, rz = 0;
+        fortran_get_data(is_cyclic, delp, gravity, &ro_0, &mu, &ic_u, &ic_v, &ic_w, &ic_p,
+                         &n, &tau_0, &papa_reg, &eta_0, fluid_model.c_str(), fluid_model.size(),
+                         &redist_type, &rz, &r_lo);
+    };
+    set_constants("newtonian");
+
+    int les_model = 0;
+    Real les_coef = 0.0;
+    Real idx = 1.0 / dx[0];
+    Real idy = 1.0 / dx[1];
+    Real idz = (AMREX_SPACEDIM == 3) ? 1.0 / dx[AMREX_SPACEDIM - 1] : 0.0;
+
+    // One sweep of a kernel over all the boxes, each box a tile
+    auto sweep = [&](const std::function<void(MFIter&, const Box&)>& tile)
+    {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for(MFIter mfi(vel, false); mfi.isValid(); ++mfi)
+        {
+            tile(mfi, mfi.validbox());
+        }
+    };
+
+    // The cut-cell kernels only run on the boxes that have cut cells
+    auto has_cut_cells = [&](MFIter& mfi, const Box& bx)
+    {
+        return flags[mfi].getType(amrex::grow(bx, ng)) != FabType::regular &&
+               flags[mfi].getType(bx) != FabType::covered;
+    };
+
+    Vector<Kernel> kernels;
+
+    kernels.push_back({"slopes", 12 * 8, [&]()
+    {
+        sweep([&](MFIter& mfi, const Box& bx)
+        {
+            incflo_kernels::compute_slopes(bx, 3, vel.array(mfi), xslopes.array(mfi),
+                                           yslopes.array(mfi), zslopes.array(mfi));
+        });
+    }});
+
+    kernels.push_back({"face_velocities", 9 * 8, [&]()
+    {
+        sweep([&](MFIter& mfi, const Box& bx)
+        {
+            incflo_kernels::compute_face_velocities(mfi.nodaltilebox(0), mfi.nodaltilebox(1),
+                                                    AMREX_SPACEDIM == 3 ? mfi.nodaltilebox(2) : bx,
+                                                    vel.array(mfi), xslopes.array(mfi),
+                                                    yslopes.array(mfi), zslopes.array(mfi),
+                                                    mac[0]->array(mfi), mac[1]->array(mfi),
+                                                    mac[2]->array(mfi), 1.e-10);
+        });
+    }});
+
+    kernels.push_back({"compute_ugradu", 18 * 8, [&]()
+    {
+        sweep([&](MFIter& mfi, const Box& bx)
+        {
+            compute_ugradu(BL_TO_FORTRAN_BOX(bx),
+                           BL_TO_FORTRAN_ANYD(conv[mfi]),
+                           BL_TO_FORTRAN_ANYD(vel[mfi]),
+                           BL_TO_FORTRAN_ANYD((*mac[0])[mfi]),
+                           BL_TO_FORTRAN_ANYD((*mac[1])[mfi]),
+                           BL_TO_FORTRAN_ANYD((*mac[2])[mfi]),
+                           xslopes[mfi].dataPtr(), yslopes[mfi].dataPtr(),
+                           BL_TO_FORTRAN_ANYD(zslopes[mfi]),
+                           BL_TO_FORTRAN_BOX(kdomain),
+                           bc_ilo.dataPtr(), bc_ihi.dataPtr(), bc_jlo.dataPtr(),
+                           bc_jhi.dataPtr(), bc_klo.dataPtr(), bc_khi.dataPtr(),
+                           AMREX_ZFILL(dx), &ng);
+        });
+    }});
+
+    kernels.push_back({"compute_divtau", 8 * 8, [&]()
+    {
+        sweep([&](MFIter& mfi, const Box& bx)
+        {
+            compute_divtau(BL_TO_FORTRAN_BOX(bx),
+                           BL_TO_FORTRAN_ANYD(divtau[mfi]),
+                           BL_TO_FORTRAN_ANYD(vel[mfi]),
+                           eta[mfi].dataPtr(),
+                           BL_TO_FORTRAN_ANYD(ro[mfi]),
+                           BL_TO_FORTRAN_BOX(kdomain),
+                           bc_ilo.dataPtr(), bc_ihi.dataPtr(), bc_jlo.dataPtr(),
+                           bc_jhi.dataPtr(), bc_klo.dataPtr(), bc_khi.dataPtr(),
+                           AMREX_ZFILL(dx), &ng);
+        });
+    }});
+
+    kernels.push_back({"compute_strainrate", 5 * 8, [&]()
+    {
+        sweep([&](MFIter& mfi, const Box& bx)
+        {
+            compute_strainrate(BL_TO_FORTRAN_BOX(bx),
+                               BL_TO_FORTRAN_ANYD(strainrate[mfi]),
+                               BL_TO_FORTRAN_ANYD(nu_t[mfi]),
+                               BL_TO_FORTRAN_ANYD(vel[mfi]),
+                               AMREX_ZFILL(dx), &les_model, &les_coef);
+        });
+    }});
+
+    kernels.push_back({"vorticity", 4 * 8, [&]()
+    {
+        sweep([&](MFIter& mfi, const Box& bx)
+        {
+            incflo_kernels::compute_vorticity(bx, vel.array(mfi), vort.array(mfi), idx, idy, idz);
+        });
+    }});
+
+    // Same loop as incflo::ComputeViscosity, for each rheology
+    for(std::string model : {"newtonian", "powerlaw", "bingham", "hb", "smd"})
+    {
+        kernels.push_back({"viscosity_" + model, 4 * 8, [&, model]()
+        {
+            set_constants(model);
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                const auto& sr_arr = strainrate.array(mfi);
+                const auto& eta_arr = eta.array(mfi);
+                const auto& nu_t_arr = nu_t.array(mfi);
+                const auto& ro_arr = ro.array(mfi);
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+
+                for(int i = lo.x; i <= hi.x; i++)
+                for(int j = lo.y; j <= hi.y; j++)
+                for(int k = lo.z; k <= hi.z; k++)
+                {
+                    eta_arr(i,j,k) = viscosity(sr_arr(i,j,k)) + ro_arr(i,j,k) * nu_t_arr(i,j,k);
+                }
+            });
+        }});
+    }
+
+#if (AMREX_SPACEDIM == 3)
+    if(cut)
+    {
+        // Extra data of the cut-cell kernels: flags, volume and area fractions and centroids
+        const Real eb_bytes = 4 + 13 * 8;
+
+        kernels.push_back({"slopes_eb", 12 * 8 + 4, [&]()
+        {
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                if(!has_cut_cells(mfi, bx)) return;
+                incflo_kernels::compute_slopes_eb(bx, 3, vel.array(mfi), flags[mfi].array(),
+                                                  xslopes.array(mfi), yslopes.array(mfi),
+                                                  zslopes.array(mfi));
+            });
+        }});
+
+        kernels.push_back({"face_velocities_eb", 12 * 8, [&]()
+        {
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                if(!has_cut_cells(mfi, bx)) return;
+                incflo_kernels::compute_face_velocities_eb(mfi.nodaltilebox(0), mfi.nodaltilebox(1),
+                                                           mfi.nodaltilebox(2), vel.array(mfi),
+                                                           xslopes.array(mfi), yslopes.array(mfi),
+                                                           zslopes.array(mfi),
+                                                           areafrac[0]->array(mfi),
+                                                           areafrac[1]->array(mfi),
+                                                           areafrac[2]->array(mfi),
+                                                           mac[0]->array(mfi), mac[1]->array(mfi),
+                                                           mac[2]->array(mfi), 1.e-10, 1.e100);
+            });
+        }});
+
+        kernels.push_back({"compute_ugradu_eb", 18 * 8 + eb_bytes, [&]()
+        {
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                if(!has_cut_cells(mfi, bx)) return;
+                compute_ugradu_eb(BL_TO_FORTRAN_BOX(bx),
+                                  BL_TO_FORTRAN_ANYD(conv[mfi]),
+                                  BL_TO_FORTRAN_ANYD(vel[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*mac[0])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*mac[1])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*mac[2])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*areafrac[0])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*areafrac[1])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*areafrac[2])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*facecent[0])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*facecent[1])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*facecent[2])[mfi]),
+                                  BL_TO_FORTRAN_ANYD(flags[mfi]),
+                                  BL_TO_FORTRAN_ANYD(volfrac[mfi]),
+                                  BL_TO_FORTRAN_ANYD(bndrycent[mfi]),
+                                  xslopes[mfi].dataPtr(), yslopes[mfi].dataPtr(),
+                                  BL_TO_FORTRAN_ANYD(zslopes[mfi]),
+                                  kdomain.loVect(), kdomain.hiVect(),
+                                  bc_ilo.dataPtr(), bc_ihi.dataPtr(), bc_jlo.dataPtr(),
+                                  bc_jhi.dataPtr(), bc_klo.dataPtr(), bc_khi.dataPtr(),
+                                  dx, &ng);
+            });
+        }});
+
+        kernels.push_back({"compute_divtau_eb", 8 * 8 + eb_bytes + 3 * 8, [&]()
+        {
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                if(!has_cut_cells(mfi, bx)) return;
+                compute_divtau_eb(BL_TO_FORTRAN_BOX(bx),
+                                  BL_TO_FORTRAN_ANYD(divtau[mfi]),
+                                  BL_TO_FORTRAN_ANYD(vel[mfi]),
+                                  eta[mfi].dataPtr(),
+                                  BL_TO_FORTRAN_ANYD(ro[mfi]),
+                                  BL_TO_FORTRAN_ANYD(flags[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*areafrac[0])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*areafrac[1])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*areafrac[2])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*facecent[0])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*facecent[1])[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*facecent[2])[mfi]),
+                                  BL_TO_FORTRAN_ANYD(volfrac[mfi]),
+                                  BL_TO_FORTRAN_ANYD(bndrycent[mfi]),
+                                  kdomain.loVect(), kdomain.hiVect(),
+                                  bc_ilo.dataPtr(), bc_ihi.dataPtr(), bc_jlo.dataPtr(),
+                                  bc_jhi.dataPtr(), bc_klo.dataPtr(), bc_khi.dataPtr(),
+                                  BL_TO_FORTRAN_ANYD(eb_vel[mfi]),
+                                  dx, &ng);
+            });
+        }});
+
+        kernels.push_back({"compute_strainrate_eb", 5 * 8 + 4 + 4 * 8, [&]()
+        {
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                if(!has_cut_cells(mfi, bx)) return;
+                compute_strainrate_eb(BL_TO_FORTRAN_BOX(bx),
+                                      BL_TO_FORTRAN_ANYD(strainrate[mfi]),
+                                      BL_TO_FORTRAN_ANYD(nu_t[mfi]),
+                                      BL_TO_FORTRAN_ANYD(vel[mfi]),
+                                      BL_TO_FORTRAN_ANYD(flags[mfi]),
+                                      BL_TO_FORTRAN_ANYD(volfrac[mfi]),
+                                      BL_TO_FORTRAN_ANYD(bndrycent[mfi]),
+                                      dx, &les_model, &les_coef);
+            });
+        }});
+
+        kernels.push_back({"compute_vort_eb", 4 * 8 + 4, [&]()
+        {
+            sweep([&](MFIter& mfi, const Box& bx)
+            {
+                if(!has_cut_cells(mfi, bx)) return;
+                compute_vort_eb(BL_TO_FORTRAN_BOX(bx),
+                                BL_TO_FORTRAN_ANYD(vort[mfi]),
+                                BL_TO_FORTRAN_ANYD(vel[mfi]),
+                                BL_TO_FORTRAN_ANYD(flags[mfi]),
+                                dx);
+            });
+        }});
+    }
+#endif
+
+    // Cells of the boxes the cut-cell kernels run on
+    long ncells = domain.numPts();
+    long ncells_cut = 0;
+    for(MFIter mfi(vel); mfi.isValid(); ++mfi)
+    {
+        if(has_cut_cells(mfi, mfi.validbox())) ncells_cut += mfi.validbox().numPts();
+    }
+
+    amrex::Print() << "incflo kernel benchmark: " << n_cell << "^" << AMREX_SPACEDIM << " cells, "
+                   << ba.size() << " tiles of " << tile_size << "^" << AMREX_SPACEDIM << ", "
+                   << geometry << " geometry (" << ncells_cut << " cells in cut tiles), "
+                   << repeat << " sweeps\n\n"
+                   << std::left << std::setw(24) << "kernel" << std::right
+                   << std::setw(8) << "threads" << std::setw(12) << "ms/sweep"
+                   << std::setw(12) << "Mcells/s" << std::setw(10) << "GB/s"
+                   << std::setw(10) << "speedup" << std::endl;
+
+    for(const Kernel& kernel : kernels)
+    {
+        // The cut-cell kernels are only counted on their tiles
+        const long nc = (kernel.name.find("_eb") != std::string::npos) ? ncells_cut : ncells;
+
+        Real t_first = 0.0;
+        for(int nt : threads)
+        {
+#ifdef _OPENMP
+            omp_set_num_threads(nt);
+#endif
+            // One untimed sweep to warm the caches up
+            kernel.sweep();
+
+            Real strt = ParallelDescriptor::second();
+            for(int r = 0; r < repeat; r++)
+            {
+                kernel.sweep();
+            }
+            Real t = (ParallelDescriptor::second() - strt) / repeat;
+            if(t_first == 0.0) t_first = t;
+
+            amrex::Print() << std::left << std::setw(24) << kernel.name << std::right
+                           << std::setw(8) << nt
+                           << std::fixed << std::setprecision(3)
+                           << std::setw(12) << 1.0e3 * t
+                           << std::setprecision(1)
+                           << std::setw(12) << nc / t * 1.0e-6
+                           << std::setprecision(2)
+                           << std::setw(10) << nc * kernel.bytes_per_cell / t * 1.0e-9
+                           << std::setw(10) << t_first / t << std::endl;
+        }
+    }
+
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    }
+    amrex::Finalize();
+}
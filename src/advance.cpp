@@ -20,6 +20,7 @@ void incflo::Advance()
 
     // Start timing current time step
     Real strt_step = ParallelDescriptor::second();
+    PerfLog::startStep();
 
     if(incflo_verbose > 0)
     {
@@ -41,6 +42,18 @@ void incflo::Advance()
         t_new[lev] = cur_time + dt; 
     }
 
+    // Move the EB to its position at the new time
+    if(eb_moving)
+    {
+        MoveEB(cur_time + dt);
+    }
+
+    // Move the immersed bodies to their position at the new time
+    if(immersed_boundary)
+    {
+        immersed_boundary->moveMarkers(cur_time + dt);
+    }
+
     if(incflo_verbose > 0)
     {
         amrex::Print() << "\nStep " << nstep + 1
@@ -49,16 +62,26 @@ void incflo::Advance()
                        << " with dt = " << dt << ".\n" << std::endl;
     }
 
-    // Backup velocity to old
+    // Backup velocity (and scalars) to old
     for(int lev = 0; lev <= finest_level; lev++)
     {
         MultiFab::Copy(*vel_o[lev], *vel[lev], 0, 0, vel[lev]->nComp(), vel_o[lev]->nGrow());
+        if(nscal > 0)
+        {
+            MultiFab::Copy(*scal_o[lev], *scal[lev], 0, 0, nscal, scal_o[lev]->nGrow());
+        }
     }
 
     ApplyPredictor();
 
     ApplyCorrector();
 
+    // Advect the tracers over the same time step
+    if(tracers)
+    {
+        tracers->Advect(vel_o, vel, ebfactory, cur_time, dt);
+    }
+
     if(incflo_verbose > 1)
     {
         amrex::Print() << "End of time step: " << std::endl;
@@ -67,6 +90,7 @@ void incflo::Advance()
 
     // Stop timing current time step
     Real end_step = ParallelDescriptor::second() - strt_step;
+    PerfLog::addTime(PerfLog::step, end_step);
     ParallelDescriptor::ReduceRealMax(end_step, ParallelDescriptor::IOProcessorNumber());
     if(incflo_verbose > 0)
     {
@@ -89,7 +113,8 @@ void incflo::Advance()
 //
 // V = 2 * max(eta/ro) * (1/dx^2 + 1/dy^2 +1/dz^2) --> Diffusion
 //
-// Fx, Fy, Fz = net acceleration due to external forces
+// Fx, Fy, Fz = net acceleration due to external forces, including the largest
+//              buoyancy acceleration beta max|T - T_ref| |g| in Boussinesq flows
 //
 // WARNING: We use a slightly modified version of C in the implementation below
 //
@@ -103,6 +128,7 @@ void incflo::ComputeDt(int initialisation)
 	Real wmax = 0.0;
 	Real romin = 1.e20;
 	Real etamax = 0.0;
+	Real dTmax = 0.0;
 
     for(int lev = 0; lev <= finest_level; lev++)
     {
@@ -112,12 +138,67 @@ void incflo::ComputeDt(int initialisation)
         wmax   = amrex::max(wmax,   Norm(vel, lev, 2, 0));
         romin  = amrex::min(romin,  Norm( ro, lev, 0, 0));
         etamax = amrex::max(etamax, Norm(eta, lev, 0, 0));
+
+        // Moving walls must not cross more than a cell per step either
+        if(eb_moving)
+        {
+            umax = amrex::max(umax, Norm(eb_vel, lev, 0, 0));
+            vmax = amrex::max(vmax, Norm(eb_vel, lev, 1, 0));
+            wmax = amrex::max(wmax, Norm(eb_vel, lev, 2, 0));
+        }
+
+        // Largest temperature difference driving the buoyancy, over the uncovered
+        // cells, in a single pass over the temperature
+        if(temp_comp >= 0)
+        {
+            const FabArray<EBCellFlagFab>& flags = ebfactory[lev]->getMultiEBCellFlagFab();
+
+    #ifdef _OPENMP
+    #pragma omp parallel reduction(max:dTmax) if (Gpu::notInLaunchRegion())
+    #endif
+            for(MFIter mfi(*scal[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+                const EBCellFlagFab& flag = flags[mfi];
+
+                if(flag.getType(bx) == FabType::covered)
+                    continue;
+
+                const bool regular = (flag.getType(bx) == FabType::regular);
+                const auto& T = scal[lev]->array(mfi);
+
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+
+                for(int k = lo.z; k <= hi.z; k++)
+                for(int j = lo.y; j <= hi.y; j++)
+                for(int i = lo.x; i <= hi.x; i++)
+                {
+                    if(regular || !flag(IntVect(AMREX_D_DECL(i, j, k))).isCovered())
+                    {
+                        dTmax = amrex::max(dTmax, std::abs(T(i, j, k, temp_comp) - T_ref));
+                    }
+                }
+            }
+        }
+    }
+    if(temp_comp >= 0)
+    {
+        // Over all ranks
+        ParallelDescriptor::ReduceRealMax(dTmax);
+    }
+    if(immersed_boundary)
+    {
+        umax = amrex::max(umax, immersed_boundary->maxBodyVelocity(0));
+        vmax = amrex::max(vmax, immersed_boundary->maxBodyVelocity(1));
+        wmax = amrex::max(wmax, immersed_boundary->maxBodyVelocity(2));
     }
 
     const Real* dx = geom[finest_level].CellSize();
     Real idx = 1.0 / dx[0];
     Real idy = 1.0 / dx[1];
-    Real idz = 1.0 / dx[2];
+    // No z-transport in 2D: w is only advected in the plane
+    Real idz = AMREX_D_PICK(0.0, 0.0, 1.0 / dx[2]);
 
     // Convective term
     Real conv_cfl = std::max(std::max(umax * idx, vmax * idy), wmax * idz);
@@ -126,9 +207,10 @@ void incflo::ComputeDt(int initialisation)
     Real diff_cfl = 2.0 * etamax / romin * (idx * idx + idy * idy + idz * idz);
 
     // Forcing term
-    Real forc_cfl = std::abs(gravity[0] - std::abs(gp0[0])) * idx
-                  + std::abs(gravity[1] - std::abs(gp0[1])) * idy
-                  + std::abs(gravity[2] - std::abs(gp0[2])) * idz;
+    Real buoy = thermal_expansion * dTmax;
+    Real forc_cfl = (std::abs(gravity[0] - std::abs(gp0[0])) + buoy * std::abs(gravity[0])) * idx
+                  + (std::abs(gravity[1] - std::abs(gp0[1])) + buoy * std::abs(gravity[1])) * idy
+                  + (std::abs(gravity[2] - std::abs(gp0[2])) + buoy * std::abs(gravity[2])) * idz;
 
     // Combined CFL conditioner
     Real comb_cfl = conv_cfl + diff_cfl + sqrt(pow(conv_cfl + diff_cfl, 2) + 4.0 * forc_cfl);
@@ -194,6 +276,9 @@ void incflo::ComputeDt(int initialisation)
 	{
 		dt = dt_new;
 	}
+
+    // CFL numbers of the step (the forcing one from its acceleration time scale)
+    PerfLog::setCFL(conv_cfl * dt, diff_cfl * dt, std::sqrt(forc_cfl) * dt);
 }
 
 //
@@ -207,17 +292,25 @@ void incflo::ComputeDt(int initialisation)
 //
 //      rhs = u + dt * ( conv + divtau )
 //
-//  2. Add explicit forcing term i.e. gravity + lagged pressure gradient
+//  2. Add explicit forcing term i.e. gravity (with Boussinesq buoyancy) + lagged pressure gradient
 //
-//      rhs += dt * ( g - grad(p + p0) / rho )
+//      rhs += dt * ( g ( 1 - beta (T - T_ref) ) - grad(p + p0) / rho )
+//
+//      The convective, viscous and body force terms are added in a single pass.
 //
 //      Note that in order to add the pressure gradient terms divided by rho, 
 //      we convert the velocity to momentum before adding and then convert them back. 
 //
+//      With immersed bodies, then force rhs to the body velocity at their markers
+//
 //  3. Solve implicit diffusion equation for u* 
 //
 //     ( 1 - dt / rho * div ( eta grad ) ) u* = rhs
 //
+//     The passive scalars are advanced with the MAC velocities of step 1:
+//
+//      ( 1 - dt * D * lap ) s = s_old - dt * div ( u^MAC s_old )
+//
 //  4. Apply projection
 //     
 //     Add pressure gradient term back to u*: 
@@ -252,6 +345,12 @@ void incflo::ApplyPredictor()
     // Compute the explicit advective term: conv = - u dot grad(u)
     ComputeUGradU(conv_old, vel_o, cur_time);
 
+    // The scalars are advected with the MAC velocities just computed
+    if(nscal > 0)
+    {
+        ComputeScalarConvection(conv_scal_old, cur_time);
+    }
+
     // Update the derived quantities, notably strain-rate tensor and viscosity
     UpdateDerivedQuantities();
 
@@ -263,16 +362,39 @@ void incflo::ApplyPredictor()
         // compute only the off-diagonal terms here
         ComputeDivTau(lev, *divtau_old[lev], vel_o);
 
-        // First add the convective term
-        MultiFab::Saxpy(*vel[lev], dt, *conv_old[lev], 0, 0, 3, 0);
-
-        // Add the viscous terms         
-        MultiFab::Saxpy(*vel[lev], dt, *divtau_old[lev], 0, 0, 3, 0);
-
-        // Add gravitational forces
-        for(int dir = 0; dir < 3; dir++)
+        // Add the convective and viscous terms, and the gravitational forces with the
+        // buoyancy of the old temperature (the scalars are only advanced further down)
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi(*vel[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
         {
-            (*vel[lev]).plus(dt * gravity[dir], dir, 1, 0);
+            const Box& bx = mfi.tilebox();
+            const auto& v = vel[lev]->array(mfi);
+            const auto& c = conv_old[lev]->array(mfi);
+            const auto& d = divtau_old[lev]->array(mfi);
+
+            Array4<Real> T;
+            if(temp_comp >= 0)
+            {
+                T = scal_o[lev]->array(mfi);
+            }
+
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                Real b = (temp_comp >= 0) ? thermal_expansion * (T(i,j,k,temp_comp) - T_ref) : 0.0;
+                for(int dir = 0; dir < 3; dir++)
+                {
+                    v(i,j,k,dir) += dt * c(i,j,k,dir);
+                    v(i,j,k,dir) += dt * d(i,j,k,dir);
+                    v(i,j,k,dir) += dt * gravity[dir] * (1.0 - b);
+                }
+            }
         }
 
         // Convert velocities to momenta
@@ -296,8 +418,27 @@ void incflo::ApplyPredictor()
     }
     FillVelocityBC(new_time, 0);
 
+    // Force the velocity at the immersed bodies to the body velocity
+    if(immersed_boundary)
+    {
+        immersed_boundary->applyForcing(vel, dt);
+        FillVelocityBC(new_time, 0);
+    }
+
     // Solve implicit diffusion equation for u*
-    diffusion_equation->solve(vel, ro, eta, dt);
+    diffusion_equation->solve(vel, ro, eta, eb_motion.isMoving() ? &eb_vel : nullptr, dt);
+
+    // Advance the scalars
+    if(nscal > 0)
+    {
+        for(int lev = 0; lev <= finest_level; lev++)
+        {
+            MultiFab::Saxpy(*scal[lev], dt, *conv_scal_old[lev], 0, 0, nscal, 0);
+        }
+        FillScalBC();
+        diffusion_equation->solveScalars(scal, scal_diff, dt);
+        FillScalBC();
+    }
 
 	// Project velocity field, update pressure
 	ApplyProjection(new_time, dt);
@@ -323,17 +464,25 @@ void incflo::ApplyPredictor()
 //
 //     rhs = u + dt * ( conv + divtau )
 //
-//  2. Add explicit forcing term i.e. gravity + lagged pressure gradient
+//  2. Add explicit forcing term i.e. gravity (with Boussinesq buoyancy) + lagged pressure gradient
+//
+//      rhs += dt * ( g ( 1 - beta (T - T_ref) ) - grad(p + p0) / rho )
 //
-//      rhs += dt * ( g - grad(p + p0) / rho )
+//      The convective, viscous and body force terms are added in a single pass.
 //
 //      Note that in order to add the pressure gradient terms divided by rho, 
 //      we convert the velocity to momentum before adding and then convert them back. 
 //
+//      With immersed bodies, then force rhs to the body velocity at their markers
+//
 //  3. Solve implicit diffusion equation for u* 
 //
 //     ( 1 - dt / rho * div ( eta grad ) ) u* = rhs
 //
+//     The passive scalars are advanced with the MAC velocities of step 1:
+//
+//      ( 1 - dt * D * lap ) s = s_old + dt/2 * ( conv_s + conv_s_pred )
+//
 //  4. Apply projection
 //     
 //     Add pressure gradient term back to u*: 
@@ -368,6 +517,12 @@ void incflo::ApplyCorrector()
     // Compute the explicit advective term: conv = - u dot grad(u)
     ComputeUGradU(conv, vel, new_time);
 
+    // The scalars are advected with the MAC velocities just computed
+    if(nscal > 0)
+    {
+        ComputeScalarConvection(conv_scal, new_time);
+    }
+
     // Update the derived quantities, notably strain-rate tensor and viscosity
     UpdateDerivedQuantities();
 
@@ -376,18 +531,47 @@ void incflo::ApplyCorrector()
         // compute only the off-diagonal terms here
         ComputeDivTau(lev, *divtau[lev], vel);
 
-        // First add the convective terms
-        MultiFab::LinComb(*vel[lev], 1.0, *vel_o[lev], 0, dt / 2.0, *conv[lev], 0, 0, 3, 0);
-        MultiFab::Saxpy(*vel[lev], dt / 2.0, *conv_old[lev], 0, 0, 3, 0);
-
-        // Add the viscous terms         
-        MultiFab::Saxpy(*vel[lev], dt / 2.0, *divtau[lev], 0, 0, 3, 0);
-        MultiFab::Saxpy(*vel[lev], dt / 2.0, *divtau_old[lev], 0, 0, 3, 0);
-
-        // Add gravitational forces
-        for(int dir = 0; dir < 3; dir++)
+        // Start from the old velocity and add the averaged convective and viscous terms,
+        // and the gravitational forces with the buoyancy of the averaged old and
+        // predicted temperature (the scalars are only corrected further down)
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi(*vel[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
         {
-            (*vel[lev]).plus(dt * gravity[dir], dir, 1, 0);
+            const Box& bx = mfi.tilebox();
+            const auto& v = vel[lev]->array(mfi);
+            const auto& vo = vel_o[lev]->array(mfi);
+            const auto& c = conv[lev]->array(mfi);
+            const auto& co = conv_old[lev]->array(mfi);
+            const auto& d = divtau[lev]->array(mfi);
+            const auto& dold = divtau_old[lev]->array(mfi);
+
+            Array4<Real> T, To;
+            if(temp_comp >= 0)
+            {
+                T = scal[lev]->array(mfi);
+                To = scal_o[lev]->array(mfi);
+            }
+
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                Real b = (temp_comp >= 0) ?
+                    thermal_expansion * (0.5 * (T(i,j,k,temp_comp) + To(i,j,k,temp_comp)) - T_ref) : 0.0;
+                for(int dir = 0; dir < 3; dir++)
+                {
+                    v(i,j,k,dir) = vo(i,j,k,dir) + dt / 2.0 * c(i,j,k,dir);
+                    v(i,j,k,dir) += dt / 2.0 * co(i,j,k,dir);
+                    v(i,j,k,dir) += dt / 2.0 * d(i,j,k,dir);
+                    v(i,j,k,dir) += dt / 2.0 * dold(i,j,k,dir);
+                    v(i,j,k,dir) += dt * gravity[dir] * (1.0 - b);
+                }
+            }
         }
 
         // Convert velocities to momenta
@@ -414,8 +598,28 @@ void incflo::ApplyCorrector()
     }
     FillVelocityBC(new_time, 0);
 
+    // Force the velocity at the immersed bodies to the body velocity
+    if(immersed_boundary)
+    {
+        immersed_boundary->applyForcing(vel, dt);
+        FillVelocityBC(new_time, 0);
+    }
+
     // Solve implicit diffusion equation for u*
-    diffusion_equation->solve(vel, ro, eta, dt);
+    diffusion_equation->solve(vel, ro, eta, eb_motion.isMoving() ? &eb_vel : nullptr, dt);
+
+    // Advance the scalars
+    if(nscal > 0)
+    {
+        for(int lev = 0; lev <= finest_level; lev++)
+        {
+            MultiFab::LinComb(*scal[lev], 1.0, *scal_o[lev], 0, dt / 2.0, *conv_scal[lev], 0, 0, nscal, 0);
+            MultiFab::Saxpy(*scal[lev], dt / 2.0, *conv_scal_old[lev], 0, 0, nscal, 0);
+        }
+        FillScalBC();
+        diffusion_equation->solveScalars(scal, scal_diff, dt);
+        FillScalBC();
+    }
 
 	// Project velocity field, update pressure
 	ApplyProjection(new_time, dt);
@@ -41,6 +41,8 @@ module bc
    integer, parameter :: pinf_      =  10 ! pressure inflow cell
    integer, parameter :: pout_      =  11 ! pressure outflow cell
    integer, parameter :: minf_      =  20 ! mass flux inflow cell
+   integer, parameter :: axis_      =  30 ! axis r = 0 of an RZ domain
+   integer, parameter :: sym_       =  40 ! symmetry plane (free-slip wall)
    integer, parameter :: nsw_       = 100 ! wall with no-slip b.c.
 
 contains
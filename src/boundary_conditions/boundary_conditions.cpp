@@ -79,10 +79,19 @@ inline void VelFillBox(Box const& bx, FArrayBox& dest, const int dcomp, const in
                      bc_ilo_ptr, bc_ihi_ptr, 
                      bc_jlo_ptr, bc_jhi_ptr, 
                      bc_klo_ptr, bc_khi_ptr, 
-                     domain.loVect(), domain.hiVect(),
+                     BL_TO_FORTRAN_BOX(domain),
                      &nghost, &extrap_dir_bcs, &probtype);
 }
 
+// Same as VelFillBox, for the transported scalars
+inline void ScalFillBox(Box const& bx, FArrayBox& dest, const int dcomp, const int numcomp,
+                        GeometryData const& geom, const Real time_in, const BCRec* bcr,
+                        const int bcomp, const int orig_comp)
+{
+    // The scalar BCs are the same on all levels
+    incflo_for_fillpatching->FillScalDomainBC(dest, bx, geom.Domain(), dcomp, numcomp);
+}
+
 // Compute a new multifab by copying array from valid region and filling ghost cells
 // works for single level and 2-level cases (fill fine grid ghost by interpolating from coarse)
 void
@@ -126,6 +135,47 @@ incflo::FillPatchVel(int lev, Real time, MultiFab& mf, int icomp, int ncomp)
     }
 }
 
+// Same as FillPatchVel, for the transported scalars
+void
+incflo::FillPatchScal(int lev, Real time, MultiFab& mf, int icomp, int ncomp)
+{
+    // There aren't used for anything but need to be defined for the function call
+    Vector<BCRec> bcs(ncomp);
+
+    // Hack so that ghost cells are not undefined
+    mf.setDomainBndry(boundary_val, geom[lev]);
+
+    if (lev == 0)
+    {
+        Vector<MultiFab*> smf;
+        Vector<Real> stime;
+        GetDataScal(0, time, smf, stime);
+
+        CpuBndryFuncFab bfunc(ScalFillBox);
+        PhysBCFunct<CpuBndryFuncFab> physbc(geom[lev], bcs, bfunc);
+        amrex::FillPatchSingleLevel(mf, time, smf, stime, 0, icomp, ncomp,
+                                    geom[lev], physbc, 0);
+    }
+    else
+    {
+        Vector<MultiFab*> cmf, fmf;
+        Vector<Real> ctime, ftime;
+        GetDataScal(lev-1, time, cmf, ctime);
+        GetDataScal(lev  , time, fmf, ftime);
+
+        CpuBndryFuncFab bfunc(ScalFillBox);
+        PhysBCFunct<CpuBndryFuncFab> cphysbc(geom[lev-1],bcs,bfunc);
+        PhysBCFunct<CpuBndryFuncFab> fphysbc(geom[lev  ],bcs,bfunc);
+
+        Interpolater* mapper = &cell_cons_interp;
+
+        amrex::FillPatchTwoLevels(mf, time, cmf, ctime, fmf, ftime,
+                                  0, icomp, ncomp, geom[lev-1], geom[lev],
+                                  cphysbc, 0, fphysbc, 0,
+                                  refRatio(lev-1), mapper, bcs, 0);
+    }
+}
+
 // utility to copy in data from phi_old and/or phi_new into another multifab
 void
 incflo::GetDataVel(int lev, Real time, Vector<MultiFab*>& data, Vector<Real>& datatime)
@@ -161,6 +211,7 @@ incflo::GetDataVel(int lev, Real time, Vector<MultiFab*>& data, Vector<Real>& da
 void incflo::FillVelocityBC(Real time, int extrap_dir_bcs)
 {
     BL_PROFILE("incflo::FillVelocityBC()");
+    PerfLog::Timer perf_timer(PerfLog::fill_vel_bc);
 
     for(int lev = 0; lev <= finest_level; lev++)
     {
@@ -180,7 +231,7 @@ void incflo::FillVelocityBC(Real time, int extrap_dir_bcs)
                              bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
                              bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
                              bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
-                             domain.loVect(), domain.hiVect(),
+                             BL_TO_FORTRAN_BOX(domain),
                              &nghost, &extrap_dir_bcs, &probtype);
         }
         EB_set_covered(*vel[lev], covered_val);
@@ -190,6 +241,119 @@ void incflo::FillVelocityBC(Real time, int extrap_dir_bcs)
     }
 }
 
+// Same as GetDataVel, for the transported scalars
+void
+incflo::GetDataScal(int lev, Real time, Vector<MultiFab*>& data, Vector<Real>& datatime)
+{
+    data.clear();
+    datatime.clear();
+
+    const Real teps = (t_new[lev] - t_old[lev]) * 1.e-3;
+
+    if (time > t_new[lev] - teps && time < t_new[lev] + teps)
+    {
+        data.push_back(scal[lev].get());
+        datatime.push_back(t_new[lev]);
+    }
+    else if (time > t_old[lev] - teps && time < t_old[lev] + teps)
+    {
+        data.push_back(scal_o[lev].get());
+        datatime.push_back(t_old[lev]);
+    }
+    else
+    {
+        data.push_back(scal_o[lev].get());
+        data.push_back(scal[lev].get());
+        datatime.push_back(t_old[lev]);
+        datatime.push_back(t_new[lev]);
+    }
+}
+
+//
+// Fill the ghost cells of bx outside a non-periodic domain: with the Dirichlet values
+// of the face if it has them (the value at the face, as for the velocity), otherwise
+// by copying the value of the nearest cell in the domain (zero normal gradient)
+//
+void incflo::FillScalDomainBC(FArrayBox& fab, const Box& bx, const Box& domain,
+                              int dcomp, int ncomp) const
+{
+    const auto& s = fab.array();
+
+    for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+    {
+        if(geom[0].isPeriodic(dir))
+            continue;
+
+        for(int side = 0; side < 2; side++)
+        {
+            const Vector<Real>& values = scal_bc_values[2 * dir + side];
+
+            // Part of bx beyond this face of the domain
+            Box gbx(bx);
+            int edge;
+            if(side == 0)
+            {
+                edge = domain.smallEnd(dir);
+                gbx.setBig(dir, amrex::min(gbx.bigEnd(dir), edge - 1));
+            }
+            else
+            {
+                edge = domain.bigEnd(dir);
+                gbx.setSmall(dir, amrex::max(gbx.smallEnd(dir), edge + 1));
+            }
+            if(!gbx.ok())
+                continue;
+
+            const auto lo = amrex::lbound(gbx);
+            const auto hi = amrex::ubound(gbx);
+
+            for(int n = 0; n < ncomp; n++)
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                if(values.empty())
+                {
+                    int iv[3] = {i, j, k};
+                    iv[dir] = edge;
+                    s(i,j,k,dcomp+n) = s(iv[0],iv[1],iv[2],dcomp+n);
+                }
+                else
+                {
+                    s(i,j,k,dcomp+n) = values[dcomp+n];
+                }
+            }
+        }
+    }
+}
+
+//
+// Fill the BCs for the transported scalars
+//
+void incflo::FillScalBC()
+{
+    BL_PROFILE("incflo::FillScalBC()");
+
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        Box domain(geom[lev].Domain());
+
+        // Hack so that ghost cells are not undefined
+        scal[lev]->setDomainBndry(boundary_val, geom[lev]);
+
+        scal[lev]->FillBoundary(geom[lev].periodicity());
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        // Not tiled, since the corners are filled from the ghost cells of the other faces
+        for(MFIter mfi(*scal[lev], false); mfi.isValid(); ++mfi)
+        {
+            FillScalDomainBC((*scal[lev])[mfi], mfi.growntilebox(nghost), domain, 0, nscal);
+        }
+        EB_set_covered(*scal[lev], covered_val);
+    }
+}
+
 void incflo::FillScalarBC()
 {
     BL_PROFILE("incflo:FillScalarBC()");
@@ -217,7 +381,7 @@ void incflo::FillScalarBC()
                      bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
                      bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
                      bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
-                     domain.loVect(), domain.hiVect(),
+                     BL_TO_FORTRAN_BOX(domain),
                      &nghost);
 
             // Viscosity
@@ -225,7 +389,7 @@ void incflo::FillScalarBC()
                      bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
                      bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
                      bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
-                     domain.loVect(), domain.hiVect(),
+                     BL_TO_FORTRAN_BOX(domain),
                      &nghost);
         }
     }
@@ -244,9 +408,15 @@ void incflo::GetInputBCs()
     SetInputBCs("ylo", 3, cyclic, geom[0].ProbLo(1));
     SetInputBCs("yhi", 4, cyclic, geom[0].ProbHi(1));
 
+#if (AMREX_SPACEDIM == 3)
     cyclic = geom[0].isPeriodic(2) ? 1 : 0;
     SetInputBCs("zlo", 5, cyclic, geom[0].ProbLo(2));
     SetInputBCs("zhi", 6, cyclic, geom[0].ProbHi(2));
+#else
+    // In 2D the z direction is homogeneous, i.e. periodic
+    SetInputBCs("zlo", 5, 1, 0.0);
+    SetInputBCs("zhi", 6, 1, 0.0);
+#endif
 }
 
 void incflo::SetInputBCs(const std::string bcID, const int index,
@@ -256,6 +426,8 @@ void incflo::SetInputBCs(const std::string bcID, const int index,
     const int pinf_ =  10;
     const int pout_ =  11;
     const int minf_ =  20;
+    const int axis_ =  30;
+    const int sym_  =  40;
     const int nsw_  = 100;
 
     // Default a BC to undefined.
@@ -311,14 +483,33 @@ void incflo::SetInputBCs(const std::string bcID, const int index,
       pp.query("direction", direction);
       pp.query("location", location);
 
+    } else if (bc_type == "symmetry"        || bc_type == "sym" ||
+               bc_type == "SYMMETRY"        || bc_type == "SYM" ||
+               bc_type == "slip_wall"       || bc_type == "SLIP_WALL" ) {
+
+      // Flag that this is a symmetry plane: no normal velocity, no shear stress
+      amrex::Print() << bcID <<" set to symmetry. "  << std::endl;
+      itype = sym_;
+
     }
 
     if ( cyclic == 1 && itype != und_){
       amrex::Abort("Cannot mix periodic BCs and Wall/Flow BCs.\n");
     }
 
-    const Real* plo = geom[0].ProbLo();
-    const Real* phi = geom[0].ProbHi();
+    // In RZ coordinates the low radial face of a domain starting at r = 0 is the axis
+    if(index == 1 && geom[0].IsRZ() && geom[0].ProbLo(0) == 0.0)
+    {
+      if(itype != und_){
+        amrex::Abort("xlo of an RZ domain starting at r = 0 is the axis: it takes no type.\n");
+      }
+      amrex::Print() << bcID <<" set to axis. "  << std::endl;
+      itype = axis_;
+    }
+
+    // The Fortran side always takes three coordinates (the third one is zero in 2D)
+    const Real plo[3] = {AMREX_D_DECL(geom[0].ProbLo(0), geom[0].ProbLo(1), geom[0].ProbLo(2))};
+    const Real phi[3] = {AMREX_D_DECL(geom[0].ProbHi(0), geom[0].ProbHi(1), geom[0].ProbHi(2))};
 
     set_bc_mod(&index, &itype, plo, phi,
                &location, &pressure, &velocity[0]);
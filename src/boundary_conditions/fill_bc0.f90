@@ -25,6 +25,7 @@ subroutine fill_bc0(s, slo, shi, &
    use iso_c_binding , only: c_int
    use amrex_fort_module, only : rt => amrex_real
    use bc
+   use constant, only: kz
 
    implicit none
 
@@ -40,10 +41,10 @@ subroutine fill_bc0(s, slo, shi, &
    ! Arrays
    real(rt), intent(inout) :: s(slo(1):shi(1), slo(2):shi(2), slo(3):shi(3))
 
-   integer(c_int), intent(in) :: bc_ilo_type(domlo(2)-ng:domhi(2)+ng, domlo(3)-ng:domhi(3)+ng, 2)
-   integer(c_int), intent(in) :: bc_ihi_type(domlo(2)-ng:domhi(2)+ng, domlo(3)-ng:domhi(3)+ng, 2)
-   integer(c_int), intent(in) :: bc_jlo_type(domlo(1)-ng:domhi(1)+ng, domlo(3)-ng:domhi(3)+ng, 2)
-   integer(c_int), intent(in) :: bc_jhi_type(domlo(1)-ng:domhi(1)+ng, domlo(3)-ng:domhi(3)+ng, 2)
+   integer(c_int), intent(in) :: bc_ilo_type(domlo(2)-ng:domhi(2)+ng, domlo(3)-ng*kz:domhi(3)+ng*kz, 2)
+   integer(c_int), intent(in) :: bc_ihi_type(domlo(2)-ng:domhi(2)+ng, domlo(3)-ng*kz:domhi(3)+ng*kz, 2)
+   integer(c_int), intent(in) :: bc_jlo_type(domlo(1)-ng:domhi(1)+ng, domlo(3)-ng*kz:domhi(3)+ng*kz, 2)
+   integer(c_int), intent(in) :: bc_jhi_type(domlo(1)-ng:domhi(1)+ng, domlo(3)-ng*kz:domhi(3)+ng*kz, 2)
    integer(c_int), intent(in) :: bc_klo_type(domlo(1)-ng:domhi(1)+ng, domlo(2)-ng:domhi(2)+ng, 2)
    integer(c_int), intent(in) :: bc_khi_type(domlo(1)-ng:domhi(1)+ng, domlo(2)-ng:domhi(2)+ng, 2)
 
@@ -51,7 +52,7 @@ subroutine fill_bc0(s, slo, shi, &
    integer :: nlft, nrgt, nbot, ntop, nup, ndwn
    integer :: ilo, ihi, jlo, jhi, klo, khi
    integer :: i, j, k
-   integer :: valid_bcs(4) = [nsw_, minf_, pinf_, pout_]
+   integer :: valid_bcs(6) = [nsw_, minf_, pinf_, pout_, axis_, sym_]
 
    !......................................................................
 
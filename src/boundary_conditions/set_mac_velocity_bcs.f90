@@ -19,7 +19,7 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
 
    use amrex_fort_module,  only: ar => amrex_real
    use iso_c_binding ,     only: c_int
-   use constant,           only: zero, one, two, half
+   use constant,           only: zero, one, two, half, kz
    use bc
 
    implicit none
@@ -41,10 +41,10 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
 
    ! BCs type
    integer(c_int), intent(in   ) :: &
-      bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-      bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-      bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-      bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+      bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+      bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+      bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+      bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
       bct_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
       bct_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
@@ -100,6 +100,18 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
                v(vlo(1):domlo(1)-1,j,k) = -v(domlo(1),j,k)
                w(wlo(1):domlo(1)-1,j,k) = -w(domlo(1),j,k)
 
+            case ( axis_)
+
+               u(ulo(1):domlo(1)  ,j,k) = 0.0d0
+               v(vlo(1):domlo(1)-1,j,k) =  v(domlo(1),j,k)
+               w(wlo(1):domlo(1)-1,j,k) = -w(domlo(1),j,k)
+
+            case ( sym_ )
+
+               u(ulo(1):domlo(1)  ,j,k) = 0.0d0
+               v(vlo(1):domlo(1)-1,j,k) =  v(domlo(1),j,k)
+               w(wlo(1):domlo(1)-1,j,k) =  w(domlo(1),j,k)
+
             end select
 
          end do
@@ -133,6 +145,12 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
                v(domhi(1)+1:vhi(1),j,k) = -v(domhi(1),j,k)
                w(domhi(1)+1:whi(1),j,k) = -w(domhi(1),j,k)
 
+            case ( sym_ )
+
+               u(domhi(1)+1:uhi(1),j,k) = 0.0d0
+               v(domhi(1)+1:vhi(1),j,k) =  v(domhi(1),j,k)
+               w(domhi(1)+1:whi(1),j,k) =  w(domhi(1),j,k)
+
             end select
 
          end do
@@ -166,6 +184,12 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
                v(i,vlo(2):domlo(2)  ,k) = 0.0d0
                w(i,wlo(2):domlo(2)-1,k) = -w(i,domlo(2),k)
 
+            case ( sym_ )
+
+               u(i,ulo(2):domlo(2)-1,k) =  u(i,domlo(2),k)
+               v(i,vlo(2):domlo(2)  ,k) = 0.0d0
+               w(i,wlo(2):domlo(2)-1,k) =  w(i,domlo(2),k)
+
             end select
 
          end do
@@ -199,6 +223,12 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
                v(i,domhi(2)+1:vhi(2),k) = 0.0d0
                w(i,domhi(2)+1:whi(2),k) = -w(i,domhi(2),k)
 
+            case ( sym_ )
+
+               u(i,domhi(2)+1:uhi(2),k) =  u(i,domhi(2),k)
+               v(i,domhi(2)+1:vhi(2),k) = 0.0d0
+               w(i,domhi(2)+1:whi(2),k) =  w(i,domhi(2),k)
+
             end select
          end do
       end do
@@ -231,6 +261,12 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
                v(i,j,vlo(3):domlo(3)-1) = -v(i,j,domlo(3))
                w(i,j,wlo(3):domlo(3)  ) = 0.0d0
 
+            case ( sym_ )
+
+               u(i,j,ulo(3):domlo(3)-1) =  u(i,j,domlo(3))
+               v(i,j,vlo(3):domlo(3)-1) =  v(i,j,domlo(3))
+               w(i,j,wlo(3):domlo(3)  ) = 0.0d0
+
             end select
          end do
       end do
@@ -263,6 +299,12 @@ subroutine set_mac_velocity_bcs(time, slo, shi, &
                v(i,j,domhi(3)+1:vhi(3)) = -v(i,j,domhi(3))
                w(i,j,domhi(3)+1:whi(3)) = 0.0d0
 
+            case ( sym_ )
+
+               u(i,j,domhi(3)+1:uhi(3)) =  u(i,j,domhi(3))
+               v(i,j,domhi(3)+1:vhi(3)) =  v(i,j,domhi(3))
+               w(i,j,domhi(3)+1:whi(3)) = 0.0d0
+
             end select
          end do
       end do
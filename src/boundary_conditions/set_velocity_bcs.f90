@@ -13,7 +13,7 @@ subroutine set_velocity_bcs(time, &
    use iso_c_binding,      only: c_int
 
    use bc
-   use constant,           only: zero, half, one, two
+   use constant,           only: zero, half, one, two, kz
 
    implicit none
 
@@ -33,10 +33,10 @@ subroutine set_velocity_bcs(time, &
 
    ! BCs type
    integer(c_int), intent(in   )  ::                                 &
-        & bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-        & bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-        & bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-        & bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+        & bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+        & bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+        & bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+        & bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
         & bct_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
         & bct_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
@@ -103,6 +103,22 @@ subroutine set_velocity_bcs(time, &
                vel(ulo(1):domlo(1)-1,j,k,2) = bc_v(bcv)
                vel(ulo(1):domlo(1)-1,j,k,3) = bc_w(bcv)
 
+            case ( axis_)
+
+               ! Mirror image across r = 0: the radial and swirl velocities change sign
+               do i = 1, nlft
+                  vel(domlo(1)-i,j,k,1) = -vel(domlo(1)+i-1,j,k,1)
+                  vel(domlo(1)-i,j,k,2) =  vel(domlo(1)+i-1,j,k,2)
+                  vel(domlo(1)-i,j,k,3) = -vel(domlo(1)+i-1,j,k,3)
+               end do
+
+            case ( sym_ )
+
+               ! Mirror plane: no normal velocity, the tangential velocities have no gradient
+               vel(ulo(1):domlo(1)-1,j,k,1) = zero
+               vel(ulo(1):domlo(1)-1,j,k,2) = vel(domlo(1),j,k,2)
+               vel(ulo(1):domlo(1)-1,j,k,3) = vel(domlo(1),j,k,3)
+
             end select
 
             if (extrap_dir_bcs .gt. 0) then
@@ -111,6 +127,10 @@ subroutine set_velocity_bcs(time, &
                   vel(domlo(1)-1,j,k,1:3) = c0 * vel(domlo(1)-1,j,k,1:3) &
                                           + c1 * vel(domlo(1)  ,j,k,1:3) &
                                           + c2 * vel(domlo(1)+1,j,k,1:3)
+               case ( sym_ )
+                  vel(domlo(1)-1,j,k,1) = c0 * vel(domlo(1)-1,j,k,1) &
+                                        + c1 * vel(domlo(1)  ,j,k,1) &
+                                        + c2 * vel(domlo(1)+1,j,k,1)
                end select
             end if
 
@@ -145,6 +165,13 @@ subroutine set_velocity_bcs(time, &
                vel(domhi(1)+1:uhi(1),j,k,2) = bc_v(bcv)
                vel(domhi(1)+1:uhi(1),j,k,3) = bc_w(bcv)
 
+            case ( sym_ )
+
+               ! Mirror plane: no normal velocity, the tangential velocities have no gradient
+               vel(domhi(1)+1:uhi(1),j,k,1) = zero
+               vel(domhi(1)+1:uhi(1),j,k,2) = vel(domhi(1),j,k,2)
+               vel(domhi(1)+1:uhi(1),j,k,3) = vel(domhi(1),j,k,3)
+
             end select
 
             if (extrap_dir_bcs .gt. 0) then
@@ -153,6 +180,10 @@ subroutine set_velocity_bcs(time, &
                   vel(domhi(1)+1,j,k,1:3) = c0*vel(domhi(1)+1,j,k,1:3) &
                                           + c1*vel(domhi(1)  ,j,k,1:3) &
                                           + c2*vel(domhi(1)-1,j,k,1:3)
+               case ( sym_ )
+                  vel(domhi(1)+1,j,k,1) = c0 * vel(domhi(1)+1,j,k,1) &
+                                        + c1 * vel(domhi(1)  ,j,k,1) &
+                                        + c2 * vel(domhi(1)-1,j,k,1)
                end select
             end if
 
@@ -187,6 +218,13 @@ subroutine set_velocity_bcs(time, &
                vel(i,ulo(2):domlo(2)-1,k,2) = zero
                vel(i,ulo(2):domlo(2)-1,k,3) = bc_w(bcv)
 
+            case ( sym_ )
+
+               ! Mirror plane: no normal velocity, the tangential velocities have no gradient
+               vel(i,ulo(2):domlo(2)-1,k,1) = vel(i,domlo(2),k,1)
+               vel(i,ulo(2):domlo(2)-1,k,2) = zero
+               vel(i,ulo(2):domlo(2)-1,k,3) = vel(i,domlo(2),k,3)
+
             end select
 
             if (extrap_dir_bcs .gt. 0) then
@@ -195,6 +233,10 @@ subroutine set_velocity_bcs(time, &
                   vel(i,domlo(2)-1,k,1:3) = c0 * vel(i,domlo(2)-1,k,1:3) &
                                           + c1 * vel(i,domlo(2)  ,k,1:3) &
                                           + c2 * vel(i,domlo(2)+1,k,1:3)
+               case ( sym_ )
+                  vel(i,domlo(2)-1,k,2) = c0 * vel(i,domlo(2)-1,k,2) &
+                                        + c1 * vel(i,domlo(2)  ,k,2) &
+                                        + c2 * vel(i,domlo(2)+1,k,2)
                end select
             end if
 
@@ -229,6 +271,13 @@ subroutine set_velocity_bcs(time, &
                vel(i,domhi(2)+1:uhi(2),k,2) = zero
                vel(i,domhi(2)+1:uhi(2),k,3) = bc_w(bcv)
 
+            case ( sym_ )
+
+               ! Mirror plane: no normal velocity, the tangential velocities have no gradient
+               vel(i,domhi(2)+1:uhi(2),k,1) = vel(i,domhi(2),k,1)
+               vel(i,domhi(2)+1:uhi(2),k,2) = zero
+               vel(i,domhi(2)+1:uhi(2),k,3) = vel(i,domhi(2),k,3)
+
             end select
 
             if (extrap_dir_bcs .gt. 0) then
@@ -237,6 +286,10 @@ subroutine set_velocity_bcs(time, &
                   vel(i,domhi(2)+1,k,1:3) = c0 * vel(i,domhi(2)+1,k,1:3) &
                                           + c1 * vel(i,domhi(2)  ,k,1:3) &
                                           + c2 * vel(i,domhi(2)-1,k,1:3)
+               case ( sym_ )
+                  vel(i,domhi(2)+1,k,2) = c0 * vel(i,domhi(2)+1,k,2) &
+                                        + c1 * vel(i,domhi(2)  ,k,2) &
+                                        + c2 * vel(i,domhi(2)-1,k,2)
                end select
             end if
 
@@ -271,6 +324,13 @@ subroutine set_velocity_bcs(time, &
                vel(i,j,ulo(3):domlo(3)-1,2) = bc_v(bcv)
                vel(i,j,ulo(3):domlo(3)-1,3) = zero
 
+            case ( sym_ )
+
+               ! Mirror plane: no normal velocity, the tangential velocities have no gradient
+               vel(i,j,ulo(3):domlo(3)-1,1) = vel(i,j,domlo(3),1)
+               vel(i,j,ulo(3):domlo(3)-1,2) = vel(i,j,domlo(3),2)
+               vel(i,j,ulo(3):domlo(3)-1,3) = zero
+
             end select
 
             if (extrap_dir_bcs .gt. 0) then
@@ -279,6 +339,10 @@ subroutine set_velocity_bcs(time, &
                   vel(i,j,domlo(3)-1,1:3) = c0 * vel(i,j,domlo(3)-1,1:3) &
                                           + c1 * vel(i,j,domlo(3)  ,1:3) &
                                           + c2 * vel(i,j,domlo(3)+1,1:3)
+               case ( sym_ )
+                  vel(i,j,domlo(3)-1,3) = c0 * vel(i,j,domlo(3)-1,3) &
+                                        + c1 * vel(i,j,domlo(3)  ,3) &
+                                        + c2 * vel(i,j,domlo(3)+1,3)
                end select
             end if
 
@@ -313,6 +377,13 @@ subroutine set_velocity_bcs(time, &
                vel(i,j,domhi(3)+1:uhi(3),2) = bc_v(bcv)
                vel(i,j,domhi(3)+1:uhi(3),3) = zero
 
+            case ( sym_ )
+
+               ! Mirror plane: no normal velocity, the tangential velocities have no gradient
+               vel(i,j,domhi(3)+1:uhi(3),1) = vel(i,j,domhi(3),1)
+               vel(i,j,domhi(3)+1:uhi(3),2) = vel(i,j,domhi(3),2)
+               vel(i,j,domhi(3)+1:uhi(3),3) = zero
+
             end select
 
             if (extrap_dir_bcs .gt. 0) then
@@ -321,6 +392,10 @@ subroutine set_velocity_bcs(time, &
                   vel(i,j,domhi(3)+1,1:3) = c0 * vel(i,j,domhi(3)+1,1:3) &
                                           + c1 * vel(i,j,domhi(3)  ,1:3) &
                                           + c2 * vel(i,j,domhi(3)-1,1:3)
+               case ( sym_ )
+                  vel(i,j,domhi(3)+1,3) = c0 * vel(i,j,domhi(3)+1,3) &
+                                        + c1 * vel(i,j,domhi(3)  ,3) &
+                                        + c2 * vel(i,j,domhi(3)-1,3)
                end select
             end if
 
@@ -1,19 +1,25 @@
 #include <AMReX_EBFArrayBox.H>
+#include <AMReX_EBFabFactory.H>
 #include <AMReX_EBMultiFabUtil.H>
 #include <AMReX_MacProjector.H>
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParmParse.H>
 
+#include <FFTPoisson.H>
 #include <MacProjection.H>
 #include <boundary_conditions_F.H>
 #include <mac_F.H>
+#include <MemReport.H>
+#include <PerfLog.H>
+#include <SolverTuning.H>
 #include <projection_F.H>
 #include <setup_F.H>
 
 // Define unit vectors to easily convert indices
-extern const amrex::IntVect e_x(1, 0, 0);
-extern const amrex::IntVect e_y(0, 1, 0);
-extern const amrex::IntVect e_z(0, 0, 1);
+// In 2D e_z is the zero vector: there are no z-faces and w_mac is cell-centred
+extern const amrex::IntVect e_x(AMREX_D_DECL(1, 0, 0));
+extern const amrex::IntVect e_y(AMREX_D_DECL(0, 1, 0));
+extern const amrex::IntVect e_z(AMREX_D_DECL(0, 0, 1));
 
 using namespace amrex;
 
@@ -46,10 +52,15 @@ void MacProjection::read_inputs()
 	pp.query("mg_verbose", mg_verbose);
 	pp.query("mg_rtol", mg_rtol);
 	pp.query("mg_atol", mg_atol);
-
-   // Default bottom solver is bicgcg, but alternatives are 
-   // "smoother", "hypre", "cg", "cgbicg", "bicgstab"
-   bottom_solver_type = "bicgcg";
+	pp.query("mg_max_coarsening_level", mg_max_coarsening_level);
+	pp.query("mg_pre_smooth", mg_pre_smooth);
+	pp.query("mg_post_smooth", mg_post_smooth);
+	pp.query("mg_agglomeration", mg_agglomeration);
+	pp.query("use_fft", use_fft);
+
+   // Default bottom solver is bicgstab, but alternatives are 
+   // "smoother", "hypre", "cg", "bicgcg", "cgbicg"
+   bottom_solver_type = "bicgstab";
    pp.query( "bottom_solver_type",  bottom_solver_type );
 }
 
@@ -73,14 +84,14 @@ void MacProjection::set_bcs(Vector<std::unique_ptr<IArrayBox>>& a_bc_ilo,
 	Box domain(m_amrcore->Geom(0).Domain());
 
     set_ppe_bc(bc_lo, bc_hi,
-               domain.loVect(), domain.hiVect(),
+               BL_TO_FORTRAN_BOX(domain),
                &m_nghost,
                (*m_bc_ilo)[lev]->dataPtr(), (*m_bc_ihi)[lev]->dataPtr(),
                (*m_bc_jlo)[lev]->dataPtr(), (*m_bc_jhi)[lev]->dataPtr(),
                (*m_bc_klo)[lev]->dataPtr(), (*m_bc_khi)[lev]->dataPtr());
 
-    m_lobc = {(LinOpBCType)bc_lo[0], (LinOpBCType)bc_lo[1], (LinOpBCType)bc_lo[2]};
-    m_hibc = {(LinOpBCType)bc_hi[0], (LinOpBCType)bc_hi[1], (LinOpBCType)bc_hi[2]};
+    m_lobc = {AMREX_D_DECL((LinOpBCType)bc_lo[0], (LinOpBCType)bc_lo[1], (LinOpBCType)bc_lo[2])};
+    m_hibc = {AMREX_D_DECL((LinOpBCType)bc_hi[0], (LinOpBCType)bc_hi[1], (LinOpBCType)bc_hi[2])};
 }
 
 // redefine working arrays if amrcore has changed
@@ -90,6 +101,7 @@ void MacProjection::update_internals()
 	if(m_divu.size() != (m_amrcore->finestLevel() + 1))
 	{
 		m_divu.resize(m_amrcore->finestLevel() + 1);
+		m_divu_eb.resize(m_amrcore->finestLevel() + 1);
 		 m_phi.resize(m_amrcore->finestLevel() + 1);
 		   m_b.resize(m_amrcore->finestLevel() + 1);
 		  m_ro.resize(m_amrcore->finestLevel() + 1);
@@ -98,7 +110,12 @@ void MacProjection::update_internals()
 	for(int lev = 0; lev <= m_amrcore->finestLevel(); ++lev)
 	{
 
-		if(m_divu[lev] == nullptr ||
+		// A factory made again (on restart) comes with new flags on the same grids
+		bool same_eb = m_divu[lev] != nullptr &&
+			&(dynamic_cast<const EBFArrayBoxFactory&>(m_divu[lev]->Factory()).getMultiEBCellFlagFab())
+			== &((*m_ebfactory)[lev]->getMultiEBCellFlagFab());
+
+		if(m_divu[lev] == nullptr || !same_eb ||
 		   !BoxArray::SameRefs(m_divu[lev]->boxArray(), m_amrcore->boxArray(lev)) ||
 		   !DistributionMapping::SameRefs(m_divu[lev]->DistributionMap(),
 										  m_amrcore->DistributionMap(lev)))
@@ -108,6 +125,10 @@ void MacProjection::update_internals()
                                            m_amrcore->DistributionMap(lev), 1, m_nghost, 
                                            MFInfo(), *((*m_ebfactory)[lev])));
 
+            m_divu_eb[lev].reset(new MultiFab(m_amrcore->boxArray(lev),
+                                              m_amrcore->DistributionMap(lev), 1, 0,
+                                              MFInfo(), *((*m_ebfactory)[lev])));
+
 			m_phi[lev].reset(new MultiFab(m_amrcore->boxArray(lev),
                                           m_amrcore->DistributionMap(lev), 1, m_nghost,
                                           MFInfo(), *((*m_ebfactory)[lev])));
@@ -130,12 +151,14 @@ void MacProjection::update_internals()
             m_ro[lev][1].reset(new MultiFab(y_ba, m_amrcore->DistributionMap(lev), 1, m_nghost,
                                            MFInfo(), *((*m_ebfactory)[lev])));
 
+#if (AMREX_SPACEDIM == 3)
 			BoxArray z_ba = m_amrcore->boxArray(lev);
 			z_ba = z_ba.surroundingNodes(2);
              m_b[lev][2].reset(new MultiFab(z_ba, m_amrcore->DistributionMap(lev), 1, m_nghost,
                                            MFInfo(), *((*m_ebfactory)[lev])));
             m_ro[lev][2].reset(new MultiFab(z_ba, m_amrcore->DistributionMap(lev), 1, m_nghost,
                                            MFInfo(), *((*m_ebfactory)[lev])));
+#endif
 		};
 	}
 }
@@ -162,15 +185,20 @@ void MacProjection::update_internals()
 //
 //       div(grad(phi)/ro) = div(u*)
 //
+//  With moving EB walls (eb_vel not null), the flow through the walls is added:
+//  the projected faces then carry div(u*) = - (flow out through the EB) / volume
+//
 //  WARNING: this method returns the MAC velocity with up-to-date BCs in place
 //
 void MacProjection::apply_projection(Vector<std::unique_ptr<MultiFab>>& u,
 									 Vector<std::unique_ptr<MultiFab>>& v,
 									 Vector<std::unique_ptr<MultiFab>>& w,
 									 const Vector<std::unique_ptr<MultiFab>>& ro, 
-                                     Real time, int steady_state)
+                                     Real time, int steady_state,
+                                     const Vector<std::unique_ptr<MultiFab>>* eb_vel)
 {
     BL_PROFILE("MacProjection::apply_projection()");
+    PerfLog::Timer perf_timer(PerfLog::mac_projection);
 
 	if(verbose)
 		Print() << "MAC Projection:\n";
@@ -189,7 +217,7 @@ void MacProjection::apply_projection(Vector<std::unique_ptr<MultiFab>>& u,
 	    // Compute beta coefficients ( div(beta*grad(phi)) = RHS )
         average_cellcenter_to_face(GetArrOfPtrs(m_ro[lev]), *ro[lev], m_amrcore->Geom(lev));
 
-        for(int dir = 0; dir < 3; dir++)
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
         {
             m_b[lev][dir]->setVal(1.0);
             MultiFab::Divide(*m_b[lev][dir], *m_ro[lev][dir], 0, 0, 1, 0);
@@ -201,12 +229,14 @@ void MacProjection::apply_projection(Vector<std::unique_ptr<MultiFab>>& u,
 		// Store in temporaries
 		(vel[lev])[0] = u[lev].get();
 		(vel[lev])[1] = v[lev].get();
+#if (AMREX_SPACEDIM == 3)
 		(vel[lev])[2] = w[lev].get();
+#endif
 
 		if(verbose)
 		{
             // Fill boundaries before printing div(u) 
-            for(int i = 0; i < 3; i++)
+            for(int i = 0; i < AMREX_SPACEDIM; i++)
                 (vel[lev])[i]->FillBoundary(m_amrcore->Geom(lev).periodicity());
 
 			EB_computeDivergence(*m_divu[lev], GetArrOfConstPtrs(vel[lev]), m_amrcore->Geom(lev));
@@ -216,10 +246,184 @@ void MacProjection::apply_projection(Vector<std::unique_ptr<MultiFab>>& u,
         }
     }
 
+	// Constant density on a fully periodic single level without EB: exact FFT projection
+	Real b0 = 1.0;
+	bool fft = use_fft && FFTPoisson::applies(*m_amrcore, *(*m_ebfactory)[0]);
+	for(int dir = 0; fft && dir < AMREX_SPACEDIM; dir++)
+	{
+		fft = FFTPoisson::isConstant(*m_b[0][dir], b0);
+	}
+
+	// Whether any level has cut cells
+	bool all_regular = true;
+	for(int lev = 0; lev <= m_amrcore->finestLevel(); ++lev)
+	{
+		all_regular = all_regular && (*m_ebfactory)[lev]->isAllRegular();
+	}
+
+	// MacProjector picks the EB operator, which has no metric terms, whenever the
+	// velocities carry an EB factory: in RZ coordinates project plain copies instead
+	const bool plain = !fft && m_amrcore->Geom(0).IsRZ();
+	Vector<Array<std::unique_ptr<MultiFab>, AMREX_SPACEDIM>> vel_plain(plain ? vel.size() : 0);
+	for(int lev = 0; plain && lev <= m_amrcore->finestLevel(); ++lev)
+	{
+		for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+		{
+			const MultiFab& src = *(vel[lev])[dir];
+			vel_plain[lev][dir].reset(new MultiFab(src.boxArray(), src.DistributionMap(),
+			                                       1, src.nGrow()));
+			MultiFab::Copy(*vel_plain[lev][dir], src, 0, 0, 1, src.nGrow());
+			(vel[lev])[dir] = vel_plain[lev][dir].get();
+		}
+	}
+
+	// Neither the FFT solver nor the plain copies see the EB, and without
+	// cut cells there is no flow through it
+	m_eb_flux = eb_vel != nullptr && !fft && !plain && !all_regular;
+	if(m_eb_flux)
+	{
+		compute_eb_flux(*eb_vel);
+	}
+
 	//
 	// Perform MAC projection
 	//
-	MacProjector macproj(vel, GetVecOfArrOfPtrsConst(m_b), m_amrcore->Geom());
+	if(fft)
+	{
+		fft_project(vel, b0);
+	}
+	else
+	{
+		if(SolverTuning::needsTuning("mac"))
+		{
+			tune(vel, steady_state);
+		}
+		project(vel, steady_state);
+	}
+
+	if(verbose)
+		Print() << " >> After projection\n";
+
+	for(int lev = 0; plain && lev <= m_amrcore->finestLevel(); ++lev)
+	{
+		MultiFab::Copy(*u[lev], *vel_plain[lev][0], 0, 0, 1, 0);
+		MultiFab::Copy(*v[lev], *vel_plain[lev][1], 0, 0, 1, 0);
+#if (AMREX_SPACEDIM == 3)
+		MultiFab::Copy(*w[lev], *vel_plain[lev][2], 0, 0, 1, 0);
+#endif
+		(vel[lev])[0] = u[lev].get();
+		(vel[lev])[1] = v[lev].get();
+#if (AMREX_SPACEDIM == 3)
+		(vel[lev])[2] = w[lev].get();
+#endif
+	}
+
+	for(int lev = 0; lev <= m_amrcore->finestLevel(); ++lev)
+	{
+		if(verbose)
+		{
+            // Fill boundaries before printing div(u) 
+            for(int i = 0; i < AMREX_SPACEDIM; i++)
+                (vel[lev])[i]->FillBoundary(m_amrcore->Geom(lev).periodicity());
+
+			EB_computeDivergence(*m_divu[lev], GetArrOfConstPtrs(vel[lev]), m_amrcore->Geom(lev));
+
+			Print() << "  * On level " << lev << " max(abs(divu)) = " << norm0(m_divu, lev)
+					<< "\n";
+		}
+        
+		// Set velocity bcs
+		set_velocity_bcs(lev, u, v, w, time);
+	}
+}
+
+//
+// Direct projection on a single fully periodic level with a constant b:
+// solve b lap(phi) = div(u) with the FFT solver and set u = u - b grad(phi)
+//
+void MacProjection::fft_project(Vector<Array<MultiFab*, AMREX_SPACEDIM>>& vel, Real b)
+{
+	BL_PROFILE("MacProjection::fft_project()");
+
+	// The pencils only depend on the domain
+	if(!m_fft)
+	{
+		m_fft.reset(new FFTPoisson(m_amrcore->Geom(0), IndexType::TheCellType()));
+	}
+
+	const Real* dx = m_amrcore->Geom(0).CellSize();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for(MFIter mfi(*m_divu[0], true); mfi.isValid(); ++mfi)
+	{
+		const Box& bx = mfi.tilebox();
+		const auto& div = m_divu[0]->array(mfi);
+		const auto& ux = (vel[0])[0]->array(mfi);
+		const auto& uy = (vel[0])[1]->array(mfi);
+#if (AMREX_SPACEDIM == 3)
+		const auto& uz = (vel[0])[2]->array(mfi);
+#endif
+
+		const auto lo = amrex::lbound(bx);
+		const auto hi = amrex::ubound(bx);
+
+		for(int k = lo.z; k <= hi.z; k++)
+		for(int j = lo.y; j <= hi.y; j++)
+		for(int i = lo.x; i <= hi.x; i++)
+		{
+			div(i, j, k) = (ux(i+1, j, k) - ux(i, j, k)) / dx[0]
+			             + (uy(i, j+1, k) - uy(i, j, k)) / dx[1];
+#if (AMREX_SPACEDIM == 3)
+			div(i, j, k) += (uz(i, j, k+1) - uz(i, j, k)) / dx[2];
+#endif
+		}
+	}
+
+	MultiFab phi(m_amrcore->boxArray(0), m_amrcore->DistributionMap(0), 1, 1);
+	m_fft->solve(phi, *m_divu[0], b);
+
+	for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+	{
+		const int di = (dir == 0);
+		const int dj = (dir == 1);
+		const int dk = (dir == 2);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		for(MFIter mfi(*(vel[0])[dir], true); mfi.isValid(); ++mfi)
+		{
+			const Box& bx = mfi.tilebox();
+			const auto& vel_arr = (vel[0])[dir]->array(mfi);
+			const auto& phi_arr = phi.array(mfi);
+
+			const auto lo = amrex::lbound(bx);
+			const auto hi = amrex::ubound(bx);
+
+			for(int k = lo.z; k <= hi.z; k++)
+			for(int j = lo.y; j <= hi.y; j++)
+			for(int i = lo.x; i <= hi.x; i++)
+			{
+				vel_arr(i, j, k) -= b * (phi_arr(i, j, k) - phi_arr(i-di, j-dj, k-dk)) / dx[dir];
+			}
+		}
+	}
+}
+
+//
+// Solve for phi and correct the velocities
+//
+SolverTuning::Result MacProjection::project(Vector<Array<MultiFab*, AMREX_SPACEDIM>>& vel,
+                                            int steady_state)
+{
+	LPInfo info;
+	info.setMaxCoarseningLevel(mg_max_coarsening_level);
+	info.setAgglomeration(mg_agglomeration);
+
+	MacProjector macproj(vel, GetVecOfArrOfPtrsConst(m_b), m_amrcore->Geom(), info,
+	                     m_eb_flux ? GetVecOfConstPtrs(m_divu_eb) : Vector<const MultiFab*>());
 
 	macproj.setDomainBC(m_lobc, m_hibc);
 
@@ -228,11 +432,34 @@ void MacProjection::apply_projection(Vector<std::unique_ptr<MultiFab>>& u,
     {
        macproj.setBottomSolver(MLMG::BottomSolver::smoother);
     }
+    else if(bottom_solver_type == "bicg" || bottom_solver_type == "bicgstab")
+    {
+       macproj.setBottomSolver(MLMG::BottomSolver::bicgstab);
+    }
+    else if(bottom_solver_type == "cg")
+    {
+       macproj.setBottomSolver(MLMG::BottomSolver::cg);
+    }
+    else if(bottom_solver_type == "bicgcg")
+    {
+       macproj.setBottomSolver(MLMG::BottomSolver::bicgcg);
+    }
+    else if(bottom_solver_type == "cgbicg")
+    {
+       macproj.setBottomSolver(MLMG::BottomSolver::cgbicg);
+    }
     else if(bottom_solver_type == "hypre")
     {
        macproj.setBottomSolver(MLMG::BottomSolver::hypre);
     }
 
+    // Smoothing sweeps on the way down and up the V-cycle
+    macproj.getMLMG().setPreSmooth(mg_pre_smooth);
+    macproj.getMLMG().setPostSmooth(mg_post_smooth);
+
+    // Trial solves of the solver tuning may not converge
+    macproj.getMLMG().setThrowException(SolverTuning::inTrial());
+
     // Verbosity for MultiGrid / ConjugateGradients
 	macproj.setVerbose(mg_verbose);
 
@@ -246,26 +473,113 @@ void MacProjection::apply_projection(Vector<std::unique_ptr<MultiFab>>& u,
         // Solve using initial guess of zero
         macproj.project(mg_rtol, mg_atol);
     }
+    PerfLog::addSolve("mac_projection", macproj.getMLMG().getNumIters(),
+                      macproj.getMLMG().getFinalResidual());
 
-	if(verbose)
-		Print() << " >> After projection\n";
+    return {macproj.getMLMG().getNumIters(), macproj.getMLMG().getFinalResidual()};
+}
 
+void MacProjection::tune(Vector<Array<MultiFab*, AMREX_SPACEDIM>>& vel, int steady_state)
+{
+	// The velocities and phi (the initial guess of a steady state) are overwritten by every solve
+	Vector<Array<std::unique_ptr<MultiFab>, AMREX_SPACEDIM>> vel0(vel.size());
+	Vector<std::unique_ptr<MultiFab>> phi0(m_phi.size());
 	for(int lev = 0; lev <= m_amrcore->finestLevel(); ++lev)
 	{
-		if(verbose)
+		for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
 		{
-            // Fill boundaries before printing div(u) 
-            for(int i = 0; i < 3; i++)
-                (vel[lev])[i]->FillBoundary(m_amrcore->Geom(lev).periodicity());
+			const MultiFab& src = *(vel[lev])[dir];
+			vel0[lev][dir].reset(new MultiFab(src.boxArray(), src.DistributionMap(), 1, src.nGrow()));
+			MultiFab::Copy(*vel0[lev][dir], src, 0, 0, 1, src.nGrow());
+		}
+		phi0[lev].reset(new MultiFab(m_phi[lev]->boxArray(), m_phi[lev]->DistributionMap(),
+		                             1, m_phi[lev]->nGrow()));
+		MultiFab::Copy(*phi0[lev], *m_phi[lev], 0, 0, 1, m_phi[lev]->nGrow());
+	}
 
-			EB_computeDivergence(*m_divu[lev], GetArrOfConstPtrs(vel[lev]), m_amrcore->Geom(lev));
+	auto restore = [&]()
+	{
+		for(int lev = 0; lev <= m_amrcore->finestLevel(); ++lev)
+		{
+			for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+			{
+				MultiFab::Copy(*(vel[lev])[dir], *vel0[lev][dir], 0, 0, 1, vel0[lev][dir]->nGrow());
+			}
+			MultiFab::Copy(*m_phi[lev], *phi0[lev], 0, 0, 1, m_phi[lev]->nGrow());
+		}
+	};
+
+	SolverTuning::tune("mac",
+	                   {bottom_solver_type, mg_max_coarsening_level, mg_pre_smooth, mg_agglomeration},
+	                   [&](const SolverTuning::Settings& s)
+	                   {
+	                       bottom_solver_type = s.bottom_solver;
+	                       mg_max_coarsening_level = s.max_coarsening_level;
+	                       mg_pre_smooth = mg_post_smooth = s.smooth;
+	                       mg_agglomeration = s.agglomeration;
+	                   },
+	                   [&]()
+	                   {
+	                       restore();
+	                       return project(vel, steady_state);
+	                   });
+
+	restore();
+}
 
-			Print() << "  * On level " << lev << " max(abs(divu)) = " << norm0(m_divu, lev)
-					<< "\n";
+//
+// Minus the flux of the wall velocity through the EB of each cut cell, per unit volume:
+// the boundary normal points out of the fluid, and the boundary area is relative to
+// the cell faces
+//
+void MacProjection::compute_eb_flux(const Vector<std::unique_ptr<MultiFab>>& eb_vel)
+{
+	BL_PROFILE("MacProjection::compute_eb_flux()");
+
+	for(int lev = 0; lev <= m_amrcore->finestLevel(); ++lev)
+	{
+		const FabArray<EBCellFlagFab>& flags = (*m_ebfactory)[lev]->getMultiEBCellFlagFab();
+		const MultiFab& volfrac = (*m_ebfactory)[lev]->getVolFrac();
+		const MultiCutFab& bndryarea = (*m_ebfactory)[lev]->getBndryArea();
+		const MultiCutFab& bndrynorm = (*m_ebfactory)[lev]->getBndryNormal();
+		const Real* dx = m_amrcore->Geom(lev).CellSize();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		for(MFIter mfi(*m_divu_eb[lev], true); mfi.isValid(); ++mfi)
+		{
+			const Box& bx = mfi.tilebox();
+			(*m_divu_eb[lev])[mfi].setVal(0.0, bx);
+
+			if(flags[mfi].getType(bx) != FabType::singlevalued)
+				continue;
+
+			const auto& flag = flags[mfi].array();
+			const auto& vf = volfrac.array(mfi);
+			const auto& ba = bndryarea.array(mfi);
+			const auto& bn = bndrynorm.array(mfi);
+			const auto& ev = eb_vel[lev]->array(mfi);
+			const auto& div = m_divu_eb[lev]->array(mfi);
+
+			const auto lo = amrex::lbound(bx);
+			const auto hi = amrex::ubound(bx);
+
+			for(int k = lo.z; k <= hi.z; k++)
+			for(int j = lo.y; j <= hi.y; j++)
+			for(int i = lo.x; i <= hi.x; i++)
+			{
+				if(flag(i, j, k).isSingleValued())
+				{
+					Real flux = 0.0;
+					for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+					{
+						flux += ev(i, j, k, dir) * bn(i, j, k, dir) / dx[dir];
+					}
+					div(i, j, k) = - flux * ba(i, j, k) / vf(i, j, k);
+				}
+			}
 		}
-        
-		// Set velocity bcs
-		set_velocity_bcs(lev, u, v, w, time);
 	}
 }
 
@@ -294,8 +608,7 @@ void MacProjection::set_velocity_bcs(int lev,
 		const Box& bx = (*m_divu[lev])[mfi].box();
 
 		set_mac_velocity_bcs(&time, 
-                             bx.loVect(),
-							 bx.hiVect(),
+                             BL_TO_FORTRAN_BOX(bx),
 							 BL_TO_FORTRAN_ANYD((*u[lev])[mfi]),
 							 BL_TO_FORTRAN_ANYD((*v[lev])[mfi]),
 							 BL_TO_FORTRAN_ANYD((*w[lev])[mfi]),
@@ -305,12 +618,29 @@ void MacProjection::set_velocity_bcs(int lev,
 							 (*m_bc_jhi)[lev]->dataPtr(),
 							 (*m_bc_klo)[lev]->dataPtr(),
 							 (*m_bc_khi)[lev]->dataPtr(),
-							 domain.loVect(),
-							 domain.hiVect(),
+							 BL_TO_FORTRAN_BOX(domain),
 							 &m_nghost, &m_probtype);
 	}
 }
 
+void MacProjection::account_memory() const
+{
+	for(int lev = 0; lev < m_divu.size(); ++lev)
+	{
+		if(m_divu[lev] == nullptr)
+			continue;
+
+		MemReport::add("solver", "mac_divu", lev, *m_divu[lev]);
+		MemReport::add("solver", "mac_divu_eb", lev, *m_divu_eb[lev]);
+		MemReport::add("solver", "mac_phi", lev, *m_phi[lev]);
+		for(int dir = 0; dir < AMREX_SPACEDIM; ++dir)
+		{
+			MemReport::add("solver", std::string("mac_b_") + "xyz"[dir], lev, *m_b[lev][dir]);
+			MemReport::add("solver", std::string("mac_ro_") + "xyz"[dir], lev, *m_ro[lev][dir]);
+		}
+	}
+}
+
 //
 // Norm 0 for EB Multifab
 //
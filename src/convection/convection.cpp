@@ -3,6 +3,7 @@
 #include <incflo.H>
 #include <mac_F.H>
 #include <convection_F.H>
+#include <convection_kernels.H>
 
 //
 // Compute acc using the vel passed in
@@ -12,12 +13,14 @@ void incflo::ComputeUGradU(Vector<std::unique_ptr<MultiFab>>& conv_in,
                            Real time)
 {
 	BL_PROFILE("incflo::ComputeUGradU");
+	PerfLog::Timer perf_timer(PerfLog::ugradu);
 
     // Extrapolate velocity field to cell faces
     ComputeVelocityAtFaces(vel_in, time);
 
     // Do projection on all AMR-level_ins in one shot
-	mac_projection->apply_projection(m_u_mac, m_v_mac, m_w_mac, ro, time, steady_state);
+	mac_projection->apply_projection(m_u_mac, m_v_mac, m_w_mac, ro, time, steady_state,
+	                                 eb_moving ? &eb_vel : nullptr);
 
     for(int lev = 0; lev <= finest_level; lev++)
     {
@@ -45,6 +48,7 @@ void incflo::ComputeUGradU(Vector<std::unique_ptr<MultiFab>>& conv_in,
             // this is to check efficiently if this tile contains any eb stuff
             const EBFArrayBox& vel_in_fab = static_cast<EBFArrayBox const&>((*vel_in[lev])[mfi]);
             const EBCellFlagFab& flags = vel_in_fab.getEBCellFlagFab();
+            TileCost::Timer tile_timer(TileCost::ugradu, lev, mfi, flags);
 
             if(flags.getType(amrex::grow(bx, 0)) == FabType::covered)
             {
@@ -67,19 +71,19 @@ void incflo::ComputeUGradU(Vector<std::unique_ptr<MultiFab>>& conv_in,
                                    (*xslopes[lev])[mfi].dataPtr(),
                                    (*yslopes[lev])[mfi].dataPtr(),
                                    BL_TO_FORTRAN_ANYD((*zslopes[lev])[mfi]),
-                                   domain.loVect(),
-                                   domain.hiVect(),
+                                   BL_TO_FORTRAN_BOX(domain),
                                    bc_ilo[lev]->dataPtr(),
                                    bc_ihi[lev]->dataPtr(),
                                    bc_jlo[lev]->dataPtr(),
                                    bc_jhi[lev]->dataPtr(),
                                    bc_klo[lev]->dataPtr(),
                                    bc_khi[lev]->dataPtr(),
-                                   geom[lev].CellSize(),
+                                   AMREX_ZFILL(geom[lev].CellSize()),
                                    &nghost);
                 }
                 else
                 {
+#if (AMREX_SPACEDIM == 3)
                     compute_ugradu_eb(BL_TO_FORTRAN_BOX(bx),
                                       BL_TO_FORTRAN_ANYD((*conv_in[lev])[mfi]),
                                       BL_TO_FORTRAN_ANYD((*vel_in[lev])[mfi]),
@@ -108,6 +112,9 @@ void incflo::ComputeUGradU(Vector<std::unique_ptr<MultiFab>>& conv_in,
                                       bc_khi[lev]->dataPtr(),
                                       geom[lev].CellSize(),
                                       &nghost);
+#else
+                    amrex::Abort("ComputeUGradU: cut cells are only supported in 3D");
+#endif
                 }
             }
         }
@@ -150,11 +157,13 @@ void incflo::ComputeVelocityAtFaces(Vector<std::unique_ptr<MultiFab>>& vel_in, R
             Box bx = mfi.tilebox();
             Box ubx = mfi.tilebox(e_x);
             Box vbx = mfi.tilebox(e_y);
+            // In 2D this is the cell-centred tilebox of the zero w_mac
             Box wbx = mfi.tilebox(e_z);
 
             // this is to check efficiently if this tile contains any eb stuff
             const EBFArrayBox& vel_in_fab = static_cast<EBFArrayBox const&>(Sborder[mfi]);
             const EBCellFlagFab& flags = vel_in_fab.getEBCellFlagFab();
+            TileCost::Timer tile_timer(TileCost::face_velocities, lev, mfi, flags);
 
             Real small_vel = 1.e-10;
             Real  huge_vel = 1.e100;
@@ -181,163 +190,27 @@ void incflo::ComputeVelocityAtFaces(Vector<std::unique_ptr<MultiFab>>& vel_in, R
             else if(flags.getType(amrex::grow(bx, 1)) == FabType::regular)
             {
                 // No cut cells in tile + 1-cell witdh halo -> use non-eb routine
-                AMREX_CUDA_HOST_DEVICE_FOR_3D(ubx, i, j, k,
-                {
-                    // X-faces
-                    Real upls     = ccvel_fab(i  ,j,k,0) - 0.5 * xslopes_fab(i  ,j,k,0);
-                    Real umns     = ccvel_fab(i-1,j,k,0) + 0.5 * xslopes_fab(i-1,j,k,0);
-                    if ( umns < 0.0 && upls > 0.0 )
-                    {
-                        umac_fab(i,j,k) = 0.0;
-                    }
-                    else
-                    {
-                        Real avg = 0.5 * ( upls + umns );
-                        if (std::abs(avg) <  small_vel)
-                            umac_fab(i,j,k) = 0.0;
-                        else if (avg >= 0)
-                            umac_fab(i,j,k) = umns;
-                        else
-                            umac_fab(i,j,k) = upls;
-                    }
-                });
-
-                AMREX_CUDA_HOST_DEVICE_FOR_3D(vbx, i, j, k,
-                {
-                    // Y-faces
-                    Real upls     = ccvel_fab(i,j  ,k,1) - 0.5 * yslopes_fab(i,j  ,k,1);
-                    Real umns     = ccvel_fab(i,j-1,k,1) + 0.5 * yslopes_fab(i,j-1,k,1);
-                    if ( umns < 0.0 && upls > 0.0 )
-                    {
-                        vmac_fab(i,j,k) = 0.0;
-                    }
-                    else
-                    {
-                        Real avg = 0.5 * ( upls + umns );
-                        if (std::abs(avg) <  small_vel)
-                            vmac_fab(i,j,k) = 0.0;
-                        else if (avg >= 0)
-                            vmac_fab(i,j,k) = umns;
-                        else
-                            vmac_fab(i,j,k) = upls;
-                    }
-                });
-
-                AMREX_CUDA_HOST_DEVICE_FOR_3D(wbx, i, j, k,
-                {
-                    // Z-faces
-                    Real upls     = ccvel_fab(i,j,k  ,2) - 0.5 * zslopes_fab(i,j,k  ,2);
-                    Real umns     = ccvel_fab(i,j,k-1,2) + 0.5 * zslopes_fab(i,j,k-1,2);
-                    if ( umns < 0.0 && upls > 0.0 )
-                    {
-                        wmac_fab(i,j,k) = 0.0;
-                    }
-                    else
-                    {
-                        Real avg = 0.5 * ( upls + umns );
-                        if ( std::abs(avg) <  small_vel)
-                            wmac_fab(i,j,k) = 0.0;
-                        else if (avg >= 0)
-                            wmac_fab(i,j,k) = umns;
-                        else
-                            wmac_fab(i,j,k) = upls;
-                    }
-                });
-
+                incflo_kernels::compute_face_velocities(ubx, vbx, wbx, ccvel_fab,
+                                                        xslopes_fab, yslopes_fab, zslopes_fab,
+                                                        umac_fab, vmac_fab, wmac_fab, small_vel);
             }
             else
             {
-
+#if (AMREX_SPACEDIM == 3)
                 // Face-centered areas
                 const auto& ax_fab = areafrac[0]->array(mfi);
                 const auto& ay_fab = areafrac[1]->array(mfi);
                 const auto& az_fab = areafrac[2]->array(mfi);
 
                 // This FAB has cut cells
-                AMREX_CUDA_HOST_DEVICE_FOR_3D(ubx, i, j, k,
-                {
-                    // X-faces
-                    if (ax_fab(i,j,k) > 0.0)
-                    {
-                        Real upls     = ccvel_fab(i  ,j,k,0) - 0.5 * xslopes_fab(i  ,j,k,0);
-                        Real umns     = ccvel_fab(i-1,j,k,0) + 0.5 * xslopes_fab(i-1,j,k,0);
-                        if ( umns < 0.0 && upls > 0.0 )
-                        {
-                            umac_fab(i,j,k) = 0.0;
-                        }
-                        else
-                        {
-                            Real avg = 0.5 * ( upls + umns );
-                            if (std::abs(avg) <  small_vel)
-                                umac_fab(i,j,k) = 0.0;
-                            else if (avg >= 0)
-                                umac_fab(i,j,k) = umns;
-                            else
-                                umac_fab(i,j,k) = upls;
-                        }
-                    }
-                    else
-                    {
-                        umac_fab(i,j,k) = huge_vel;
-                    }
-                });
-
-                AMREX_CUDA_HOST_DEVICE_FOR_3D(vbx, i, j, k,
-                {
-                    // Y-faces
-                    if (ay_fab(i,j,k) > 0.0)
-                    {
-                        Real upls     = ccvel_fab(i,j  ,k,1) - 0.5 * yslopes_fab(i,j  ,k,1);
-                        Real umns     = ccvel_fab(i,j-1,k,1) + 0.5 * yslopes_fab(i,j-1,k,1);
-                        if ( umns < 0.0 && upls > 0.0 )
-                        {
-                            vmac_fab(i,j,k) = 0.0;
-                        }
-                        else
-                        {
-                            Real avg = 0.5 * ( upls + umns );
-                            if ( std::abs(avg) <  small_vel)
-                                vmac_fab(i,j,k) = 0.0;
-                            else if (avg >= 0)
-                                vmac_fab(i,j,k) = umns;
-                            else
-                                vmac_fab(i,j,k) = upls;
-                        }
-                    }
-                    else
-                    {
-                        vmac_fab(i,j,k) = huge_vel;
-                    }
-                });
-
-                AMREX_CUDA_HOST_DEVICE_FOR_3D(wbx, i, j, k,
-                {
-                    // Z-faces
-                    if (az_fab(i,j,k) > 0.0)
-                    {
-                       Real upls     = ccvel_fab(i,j,k  ,2) - 0.5 * zslopes_fab(i,j,k  ,2);
-                       Real umns     = ccvel_fab(i,j,k-1,2) + 0.5 * zslopes_fab(i,j,k-1,2);
-                       if ( umns < 0.0 && upls > 0.0 )
-                       {
-                            wmac_fab(i,j,k) = 0.0;
-                       }
-                       else
-                       {
-                            Real avg = 0.5 * ( upls + umns );
-                            if (std::abs(avg) <  small_vel)
-                                wmac_fab(i,j,k) = 0.0;
-                            else if (avg >= 0)
-                                wmac_fab(i,j,k) = umns;
-                            else
-                                wmac_fab(i,j,k) = upls;
-                       }
-                    }
-                    else
-                    {
-                        wmac_fab(i,j,k) = huge_vel;
-                    }
-                });
-
+                incflo_kernels::compute_face_velocities_eb(ubx, vbx, wbx, ccvel_fab,
+                                                           xslopes_fab, yslopes_fab, zslopes_fab,
+                                                           ax_fab, ay_fab, az_fab,
+                                                           umac_fab, vmac_fab, wmac_fab,
+                                                           small_vel, huge_vel);
+#else
+                amrex::Abort("ComputeVelocityAtFaces: cut cells are only supported in 3D");
+#endif
             } // Cut cells
         } // MFIter
     } // Levels
@@ -349,6 +222,17 @@ void incflo::ComputeVelocitySlopes(int lev, MultiFab& Sborder)
 {
 	BL_PROFILE("incflo::ComputeVelocitySlopes");
 
+    ComputeSlopes(lev, Sborder, *xslopes[lev], *yslopes[lev], *zslopes[lev]);
+}
+
+//
+// Compute the slopes of all the components of Sborder in all three directions.
+// The slope MultiFabs must have as many components as Sborder.
+//
+void incflo::ComputeSlopes(int lev, MultiFab& Sborder, MultiFab& xs, MultiFab& ys, MultiFab& zs)
+{
+	BL_PROFILE("incflo::ComputeSlopes");
+
     EB_set_covered(Sborder, covered_val);
 
 	Box domain(geom[lev].Domain());
@@ -364,106 +248,36 @@ void incflo::ComputeVelocitySlopes(int lev, MultiFab& Sborder)
 		// this is to check efficiently if this tile contains any eb stuff
 		const EBFArrayBox& vel_in_fab = static_cast<EBFArrayBox const&>(Sborder[mfi]);
 		const EBCellFlagFab& flags = vel_in_fab.getEBCellFlagFab();
+		TileCost::Timer tile_timer(TileCost::slopes, lev, mfi, flags);
 
 		if(flags.getType(amrex::grow(bx, 0)) == FabType::covered)
 		{
 			// If tile is completely covered by EB geometry, set slopes
 			// value to some very large number so we know if
 			// we accidentaly use these covered slopes later in calculations
-			xslopes[lev]->setVal(1.2345e300, bx, 0, 3);
-			yslopes[lev]->setVal(1.2345e300, bx, 0, 3);
-			zslopes[lev]->setVal(1.2345e300, bx, 0, 3);
+			xs.setVal(1.2345e300, bx, 0, Sborder.nComp());
+			ys.setVal(1.2345e300, bx, 0, Sborder.nComp());
+			zs.setVal(1.2345e300, bx, 0, Sborder.nComp());
 		}
 		else
 		{
             const auto&  vel_fab =      Sborder.array(mfi);
-            const auto&   xs_fab = xslopes[lev]->array(mfi);
-            const auto&   ys_fab = yslopes[lev]->array(mfi);
-            const auto&   zs_fab = zslopes[lev]->array(mfi);
+            const auto&   xs_fab = xs.array(mfi);
+            const auto&   ys_fab = ys.array(mfi);
+            const auto&   zs_fab = zs.array(mfi);
 
             int ncomp = Sborder.nComp();
 
 			// No cut cells in tile + 1-cell witdh halo -> use non-eb routine
 			if(flags.getType(amrex::grow(bx, 1)) == FabType::regular)
 			{
-                AMREX_CUDA_HOST_DEVICE_FOR_4D(bx, ncomp, i, j, k, dir,
-                {
-                   // X direction
-                   Real du_xl = 2.0*(vel_fab(i  ,j,k,dir) - vel_fab(i-1,j,k,dir));
-                   Real du_xr = 2.0*(vel_fab(i+1,j,k,dir) - vel_fab(i  ,j,k,dir));
-                   Real du_xc = 0.5*(vel_fab(i+1,j,k,dir) - vel_fab(i-1,j,k,dir));
-
-                   Real xslope = amrex::min(std::abs(du_xl),std::abs(du_xc),std::abs(du_xr));
-                   xslope            = (du_xr*du_xl > 0.0) ? xslope : 0.0;
-                   xs_fab(i,j,k,dir) = (du_xc       > 0.0) ? xslope : -xslope;
-
-                   // Y direction
-                   Real du_yl = 2.0*(vel_fab(i,j  ,k,dir) - vel_fab(i,j-1,k,dir));
-                   Real du_yr = 2.0*(vel_fab(i,j+1,k,dir) - vel_fab(i,j  ,k,dir));
-                   Real du_yc = 0.5*(vel_fab(i,j+1,k,dir) - vel_fab(i,j-1,k,dir));
-
-                   Real yslope = amrex::min(std::abs(du_yl),std::abs(du_yc),std::abs(du_yr));
-                   yslope            = (du_yr*du_yl > 0.0) ? yslope : 0.0;
-                   ys_fab(i,j,k,dir) = (du_yc       > 0.0) ? yslope : -yslope;
-
-                   // Z direction
-                   Real du_zl = 2.0*(vel_fab(i,j,k  ,dir) - vel_fab(i,j,k-1,dir));
-                   Real du_zr = 2.0*(vel_fab(i,j,k+1,dir) - vel_fab(i,j,k  ,dir));
-                   Real du_zc = 0.5*(vel_fab(i,j,k+1,dir) - vel_fab(i,j,k-1,dir));
-
-                   Real zslope = amrex::min(std::abs(du_zl),std::abs(du_zc),std::abs(du_zr));
-                   zslope            = (du_zr*du_zl > 0.0) ? zslope : 0.0;
-                   zs_fab(i,j,k,dir) = (du_zc       > 0.0) ? zslope : -zslope;
-                });
+                incflo_kernels::compute_slopes(bx, ncomp, vel_fab, xs_fab, ys_fab, zs_fab);
 			}
 			else
 			{
                 const auto& flag_fab = flags.array();
 
-                AMREX_CUDA_HOST_DEVICE_FOR_4D(bx, ncomp, i, j, k, dir,
-                {
-                    if (flag_fab(i,j,k).isCovered())
-                    {
-                        xs_fab(i,j,k,dir) = 0.0;
-                        ys_fab(i,j,k,dir) = 0.0;
-                        zs_fab(i,j,k,dir) = 0.0;
-
-                    } else {
-
-                        // X direction
-                        Real du_xl = (flag_fab(i-1,j,k).isCovered()) ? 0.0 :
-                                     2.0*(vel_fab(i  ,j,k,dir) - vel_fab(i-1,j,k,dir));
-                        Real du_xr = (flag_fab(i+1,j,k).isCovered()) ? 0.0 :
-                                     2.0*(vel_fab(i+1,j,k,dir) - vel_fab(i  ,j,k,dir));
-                        Real du_xc = 0.5*(vel_fab(i+1,j,k,dir) - vel_fab(i-1,j,k,dir));
-
-                        Real xslope = amrex::min(std::abs(du_xl),std::abs(du_xc),std::abs(du_xr));
-                        xslope            = (du_xr*du_xl > 0.0) ? xslope : 0.0;
-                        xs_fab(i,j,k,dir) = (du_xc       > 0.0) ? xslope : -xslope;
-
-                        // Y direction
-                        Real du_yl = (flag_fab(i,j-1,k).isCovered()) ? 0.0 :
-                                     2.0*(vel_fab(i,j  ,k,dir) - vel_fab(i,j-1,k,dir));
-                        Real du_yr = (flag_fab(i,j+1,k).isCovered()) ? 0.0 :
-                                     2.0*(vel_fab(i,j+1,k,dir) - vel_fab(i,j  ,k,dir));
-                        Real du_yc = 0.5*(vel_fab(i,j+1,k,dir) - vel_fab(i,j-1,k,dir));
-
-                        Real yslope = amrex::min(std::abs(du_yl),std::abs(du_yc),std::abs(du_yr));
-                        yslope            = (du_yr*du_yl > 0.0) ? yslope : 0.0;
-                        ys_fab(i,j,k,dir) = (du_yc       > 0.0) ? yslope : -yslope;
-
-                        // Z direction
-                        Real du_zl = (flag_fab(i,j,k-1).isCovered()) ? 0.0 :
-                                     2.0*(vel_fab(i,j,k  ,dir) - vel_fab(i,j,k-1,dir));
-                        Real du_zr = (flag_fab(i,j,k+1).isCovered()) ? 0.0 :
-                                     2.0*(vel_fab(i,j,k+1,dir) - vel_fab(i,j,k  ,dir));
-                        Real du_zc = 0.5*(vel_fab(i,j,k+1,dir) - vel_fab(i,j,k-1,dir));
-
-                        Real zslope = amrex::min(std::abs(du_zl),std::abs(du_zc),std::abs(du_zr));
-                        zslope          = (du_zr*du_zl > 0.0) ? zslope : 0.0;
-                        zs_fab(i,j,k,dir) = (du_zc       > 0.0) ? zslope : -zslope;
-                    }
-                });
+                incflo_kernels::compute_slopes_eb(bx, ncomp, vel_fab, flag_fab, xs_fab, ys_fab, zs_fab);
 	        }
 
             // TODO -- do we have domain and ilo_fab, etc on GPU???
@@ -522,6 +336,7 @@ void incflo::ComputeVelocitySlopes(int lev, MultiFab& Sborder)
                     ys_fab(i,j,k,dir) = (du_yc       > 0.0) ? yslope : -yslope;
                 }
 
+#if (AMREX_SPACEDIM == 3)
                 if ( (k == domain.smallEnd(2)) && !flag_fab(i,j,k).isCovered() && klo_ifab(i,j,k-1,0) == 20)
                 {
                     Real du_zl = 2.0*(vel_fab(i,j,k  ,dir) - vel_fab(i,j,k-1,dir));
@@ -542,12 +357,13 @@ void incflo::ComputeVelocitySlopes(int lev, MultiFab& Sborder)
                     zslope            = (du_zr*du_zl > 0.0) ? zslope : 0.0;
                     zs_fab(i,j,k,dir) = (du_zc       > 0.0) ? zslope : -zslope;
                 }
+#endif
             });
 		}
 	}
 
-	xslopes[lev]->FillBoundary(geom[lev].periodicity());
-	yslopes[lev]->FillBoundary(geom[lev].periodicity());
-	zslopes[lev]->FillBoundary(geom[lev].periodicity());
+	xs.FillBoundary(geom[lev].periodicity());
+	ys.FillBoundary(geom[lev].periodicity());
+	zs.FillBoundary(geom[lev].periodicity());
 }
 
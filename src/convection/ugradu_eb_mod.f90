@@ -5,8 +5,8 @@ module ugradu_eb_mod
    use amrex_fort_module,       only: ar => amrex_real
    use iso_c_binding ,          only: c_int
 
-   use bc,                      only: minf_, nsw_, pinf_, pout_
-   use constant,                only: zero, half, my_huge
+   use bc,                      only: minf_, nsw_, sym_, pinf_, pout_
+   use constant,                only: zero, half, my_huge, kz
 
    implicit none
    private
@@ -90,10 +90,10 @@ contains
 
       ! BC types
       integer(c_int), intent(in   ) ::  &
-           & bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+           & bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
            & bc_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
            & bc_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
            & flags(flo(1):fhi(1),flo(2):fhi(2),flo(3):fhi(3))
@@ -117,7 +117,7 @@ contains
          real(ar)               :: u_face, v_face, w_face
          real(ar)               :: upls, umns, vpls, vmns, wpls, wmns
          integer                :: i, j, k, n
-         integer, parameter     :: bc_list(4) = [MINF_, NSW_, PINF_, POUT_]
+         integer, parameter     :: bc_list(5) = [MINF_, NSW_, SYM_, PINF_, POUT_]
 
          do n = 1, 3
 
@@ -212,7 +212,7 @@ contains
          fyhi = hi + nh + [0,1,0]
          fzhi = hi + nh + [0,0,1]
 
-         call compute_divop(lo, hi, &
+         call compute_divop(lo, hi, 3, &
                             ugradu, glo, ghi, &
                             vel, vlo, vhi, &
                             fx, fxlo, fxhi, &
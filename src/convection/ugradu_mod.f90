@@ -9,8 +9,8 @@ module ugradu_mod
    use amrex_fort_module, only: ar => amrex_real
    use iso_c_binding ,    only: c_int
 
-   use bc,                only: minf_, nsw_, pinf_, pout_
-   use constant,          only: zero, half, one, my_huge
+   use bc,                only: minf_, nsw_, sym_, pinf_, pout_
+   use constant,          only: zero, half, one, my_huge, kz, rz, r_lo
 
    implicit none
    public upwind
@@ -65,10 +65,10 @@ contains
 
       ! BC types
       integer(c_int), intent(in   ) ::  &
-           & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+           & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
            & bc_klo_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
            & bc_khi_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
@@ -80,21 +80,35 @@ contains
       real(ar)                       :: v_e, v_w, v_s, v_n, v_b, v_t
       real(ar)                       :: w_e, w_w, w_s, w_n, w_b, w_t
       real(ar)                       :: divumac
-      integer, parameter             :: bc_list(4) = [MINF_, NSW_, PINF_, POUT_]
+      real(ar)                       :: r_c, r_w, r_e
+      integer, parameter             :: bc_list(5) = [MINF_, NSW_, SYM_, PINF_, POUT_]
 
       idx = one / dx(1)
       idy = one / dx(2)
-      idz = one / dx(3)
+      idz = zero
+      if (kz > 0) idz = one / dx(3)
+
+      ! Radii of the cell centre and of the x faces: in RZ coordinates the
+      ! x fluxes and divergence are weighted by r, otherwise all are one
+      r_c = one
+      r_w = one
+      r_e = one
 
       do k = lo(3), hi(3)
          do j = lo(2), hi(2)
             do i = lo(1), hi(1)
 
+               if (rz) then
+                  r_w = r_lo + i * dx(1)
+                  r_e = r_w + dx(1)
+                  r_c = r_w + half * dx(1)
+               end if
+
                ! ****************************************************
                ! West face
                ! ****************************************************
 
-               ! In the case of MINF, NSW, we are using the prescribed Dirichlet value
+               ! In the case of MINF, NSW, SYM we are using the prescribed Dirichlet value
                ! In the case of PINF, POUT          we are using the upwind value
                if (i.eq.domlo(1) .and. any(bc_ilo_type(j,k,1) == bc_list ) ) then
                   u_w =  vel(i-1,j,k,1)
@@ -117,7 +131,7 @@ contains
                ! East face
                ! ****************************************************
 
-               ! In the case of MINF, NSW, we are using the prescribed Dirichlet value
+               ! In the case of MINF, NSW, SYM we are using the prescribed Dirichlet value
                ! In the case of PINF, POUT          we are using the upwind value
                if (i.eq.domhi(1) .and. any(bc_ihi_type(j,k,1) == bc_list ) ) then
                   u_e =  vel(i+1,j,k,1)
@@ -140,7 +154,7 @@ contains
                ! South face
                ! ****************************************************
 
-               ! In the case of MINF, NSW, we are using the prescribed Dirichlet value
+               ! In the case of MINF, NSW, SYM we are using the prescribed Dirichlet value
                ! In the case of PINF, POUT          we are using the upwind value
                if (j.eq.domlo(2) .and. any(bc_jlo_type(i,k,1) == bc_list ) ) then
                   u_s =  vel(i,j-1,k,1)
@@ -163,7 +177,7 @@ contains
                ! North face
                ! ****************************************************
 
-               ! In the case of MINF, NSW, we are using the prescribed Dirichlet value
+               ! In the case of MINF, NSW, SYM we are using the prescribed Dirichlet value
                ! In the case of PINF, POUT          we are using the upwind value
                if (j.eq.domhi(2) .and.  any(bc_jhi_type(i,k,1) == bc_list ) ) then
                   u_n =  vel(i,j+1,k,1)
@@ -186,19 +200,19 @@ contains
                ! Bottom face
                ! ****************************************************
 
-               ! In the case of MINF, NSW, we are using the prescribed Dirichlet value
+               ! In the case of MINF, NSW, SYM we are using the prescribed Dirichlet value
                ! In the case of PINF, POUT          we are using the upwind value
                if (k.eq.domlo(3) .and. any( bc_klo_type(i,j,1) == bc_list ) ) then
-                  u_b =  vel(i,j,k-1,1)
-                  v_b =  vel(i,j,k-1,2)
-                  w_b =  vel(i,j,k-1,3)
+                  u_b =  vel(i,j,k-kz,1)
+                  v_b =  vel(i,j,k-kz,2)
+                  w_b =  vel(i,j,k-kz,3)
                else
                   upls  = vel(i,j,k  ,1) - half * zslopes(i,j,k  ,1)
-                  umns  = vel(i,j,k-1,1) + half * zslopes(i,j,k-1,1)
+                  umns  = vel(i,j,k-kz,1) + half * zslopes(i,j,k-kz,1)
                   vpls  = vel(i,j,k  ,2) - half * zslopes(i,j,k  ,2)
-                  vmns  = vel(i,j,k-1,2) + half * zslopes(i,j,k-1,2)
+                  vmns  = vel(i,j,k-kz,2) + half * zslopes(i,j,k-kz,2)
                   wpls  = vel(i,j,k  ,3) - half * zslopes(i,j,k  ,3)
-                  wmns  = vel(i,j,k-1,3) + half * zslopes(i,j,k-1,3)
+                  wmns  = vel(i,j,k-kz,3) + half * zslopes(i,j,k-kz,3)
 
                   w_b   = upwind( wmns, wpls, w(i,j,k) )
                   u_b   = upwind( umns, upls, w(i,j,k) )
@@ -209,23 +223,23 @@ contains
                ! Top face
                ! ****************************************************
 
-               ! In the case of MINF, NSW, we are using the prescribed Dirichlet value
+               ! In the case of MINF, NSW, SYM we are using the prescribed Dirichlet value
                ! In the case of PINF, POUT          we are using the upwind value
                if (k.eq.domhi(3) .and. any( bc_khi_type(i,j,1) == bc_list ) ) then
-                  u_t =  vel(i,j,k+1,1)
-                  v_t =  vel(i,j,k+1,2)
-                  w_t =  vel(i,j,k+1,3)
+                  u_t =  vel(i,j,k+kz,1)
+                  v_t =  vel(i,j,k+kz,2)
+                  w_t =  vel(i,j,k+kz,3)
                else
-                  upls  = vel(i,j,k+1,1) - half * zslopes(i,j,k+1,1)
+                  upls  = vel(i,j,k+kz,1) - half * zslopes(i,j,k+kz,1)
                   umns  = vel(i,j,k  ,1) + half * zslopes(i,j,k  ,1)
-                  vpls  = vel(i,j,k+1,2) - half * zslopes(i,j,k+1,2)
+                  vpls  = vel(i,j,k+kz,2) - half * zslopes(i,j,k+kz,2)
                   vmns  = vel(i,j,k  ,2) + half * zslopes(i,j,k  ,2)
-                  wpls  = vel(i,j,k+1,3) - half * zslopes(i,j,k+1,3)
+                  wpls  = vel(i,j,k+kz,3) - half * zslopes(i,j,k+kz,3)
                   wmns  = vel(i,j,k  ,3) + half * zslopes(i,j,  k,3)
 
-                  w_t   = upwind( wmns, wpls, w(i,j,k+1) )
-                  u_t   = upwind( umns, upls, w(i,j,k+1) )
-                  v_t   = upwind( vmns, vpls, w(i,j,k+1) )
+                  w_t   = upwind( wmns, wpls, w(i,j,k+kz) )
+                  u_t   = upwind( umns, upls, w(i,j,k+kz) )
+                  v_t   = upwind( vmns, vpls, w(i,j,k+kz) )
                endif
 
                ! ****************************************************
@@ -233,23 +247,29 @@ contains
                !   ugradu = ( div(u^MAC u^cc) - u^cc div(u^MAC) )
                ! ****************************************************
 
-               divumac = (u(i+1,j,k) - u(i,j,k)) * idx + &
+               divumac = (r_e * u(i+1,j,k) - r_w * u(i,j,k)) * idx / r_c + &
                          (v(i,j+1,k) - v(i,j,k)) * idy + &
-                         (w(i,j,k+1) - w(i,j,k)) * idz
+                         (w(i,j,k+kz) - w(i,j,k)) * idz
 
-               ugradu(i,j,k,1) = (u(i+1,j,k) * u_e - u(i,j,k) * u_w) * idx + &
+               ugradu(i,j,k,1) = (r_e * u(i+1,j,k) * u_e - r_w * u(i,j,k) * u_w) * idx / r_c + &
                                  (v(i,j+1,k) * u_n - v(i,j,k) * u_s) * idy + &
-                                 (w(i,j,k+1) * u_t - w(i,j,k) * u_b) * idz - &
+                                 (w(i,j,k+kz) * u_t - w(i,j,k) * u_b) * idz - &
                                  vel(i,j,k,1) * divumac
-               ugradu(i,j,k,2) = (u(i+1,j,k) * v_e - u(i,j,k) * v_w) * idx + &
+               ugradu(i,j,k,2) = (r_e * u(i+1,j,k) * v_e - r_w * u(i,j,k) * v_w) * idx / r_c + &
                                  (v(i,j+1,k) * v_n - v(i,j,k) * v_s) * idy + &
-                                 (w(i,j,k+1) * v_t - w(i,j,k) * v_b) * idz - &
+                                 (w(i,j,k+kz) * v_t - w(i,j,k) * v_b) * idz - &
                                  vel(i,j,k,2) * divumac
-               ugradu(i,j,k,3) = (u(i+1,j,k) * w_e - u(i,j,k) * w_w) * idx + &
+               ugradu(i,j,k,3) = (r_e * u(i+1,j,k) * w_e - r_w * u(i,j,k) * w_w) * idx / r_c + &
                                  (v(i,j+1,k) * w_n - v(i,j,k) * w_s) * idy + &
-                                 (w(i,j,k+1) * w_t - w(i,j,k) * w_b) * idz - &
+                                 (w(i,j,k+kz) * w_t - w(i,j,k) * w_b) * idz - &
                                  vel(i,j,k,3) * divumac
 
+               ! Centrifugal and Coriolis terms of the swirl in RZ coordinates
+               if (rz) then
+                  ugradu(i,j,k,1) = ugradu(i,j,k,1) - vel(i,j,k,3)**2 / r_c
+                  ugradu(i,j,k,3) = ugradu(i,j,k,3) + vel(i,j,k,1) * vel(i,j,k,3) / r_c
+               end if
+
                ! ****************************************************
                ! Return the negative
                ! ****************************************************
@@ -3,11 +3,13 @@
 
 #include <incflo.H>
 #include <derive_F.H>
+#include <derive_kernels.H>
 #include <projection_F.H>
 
 void incflo::UpdateDerivedQuantities()
 {
     BL_PROFILE("incflo::UpdateDerivedQuantities()");
+    PerfLog::Timer perf_timer(PerfLog::derived);
 
     ComputeDivU(cur_time);
     ComputeStrainrate();
@@ -20,12 +22,21 @@ void incflo::ComputeDivU(Real time)
     int extrap_dir_bcs = 0;
     FillVelocityBC(time, extrap_dir_bcs);
 
+    ComputeNodalDivergence(divu, vel);
+}
+
+void incflo::ComputeNodalDivergence(Vector<std::unique_ptr<MultiFab>>& div,
+                                    Vector<std::unique_ptr<MultiFab>>& vel_in)
+{
     // Define the operator in order to compute the multi-level divergence
     //
     //        (del dot b sigma grad)) phi
     //
     LPInfo info;
-    MLNodeLaplacian matrix(geom, grids, dmap, info, amrex::GetVecOfConstPtrs(ebfactory));
+    MLNodeLaplacian matrix(geom, grids, dmap, info,
+                           geom[0].IsRZ() ? Vector<EBFArrayBoxFactory const*>{}
+                                          : amrex::GetVecOfConstPtrs(ebfactory));
+    matrix.setRZCorrection(geom[0].IsRZ());
 
     // Set domain BCs for Poisson's solver
     // The domain BCs refer to level 0 only
@@ -33,16 +44,89 @@ void incflo::ComputeDivU(Real time)
     Box domain(geom[0].Domain());
 
     set_ppe_bc(bc_lo, bc_hi,
-               domain.loVect(), domain.hiVect(),
+               BL_TO_FORTRAN_BOX(domain),
                &nghost,
                bc_ilo[0]->dataPtr(), bc_ihi[0]->dataPtr(),
                bc_jlo[0]->dataPtr(), bc_jhi[0]->dataPtr(),
                bc_klo[0]->dataPtr(), bc_khi[0]->dataPtr());
 
-    matrix.setDomainBC({(LinOpBCType)bc_lo[0], (LinOpBCType)bc_lo[1], (LinOpBCType)bc_lo[2]},
-                       {(LinOpBCType)bc_hi[0], (LinOpBCType)bc_hi[1], (LinOpBCType)bc_hi[2]});
+    matrix.setDomainBC({AMREX_D_DECL((LinOpBCType)bc_lo[0], (LinOpBCType)bc_lo[1], (LinOpBCType)bc_lo[2])},
+                       {AMREX_D_DECL((LinOpBCType)bc_hi[0], (LinOpBCType)bc_hi[1], (LinOpBCType)bc_hi[2])});
+
+    matrix.compDivergence(GetVecOfPtrs(div), GetVecOfPtrs(vel_in)); 
+
+#if (AMREX_SPACEDIM == 3)
+    if(!eb_moving)
+        return;
+
+    // The weak divergence of the operator leaves out the flow through the EB walls,
+    // so that the projection makes it zero. With moving walls, add the flow of their
+    // velocity through the EB of each cut cell, shared among the nodes of the cell
+    // by the trilinear basis functions at the boundary centroid:
+    //
+    //     div(node) += sum_cells N_node(bcent) (eb_vel . n) area / volume
+    //
+    // which makes the projected velocity meet the walls with their normal velocity.
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        const FabArray<EBCellFlagFab>& flags = ebfactory[lev]->getMultiEBCellFlagFab();
+        const MultiCutFab& bndryarea = ebfactory[lev]->getBndryArea();
+        const MultiCutFab& bndrycent = ebfactory[lev]->getBndryCent();
+        const MultiCutFab& bndrynorm = ebfactory[lev]->getBndryNormal();
+        const Real* dx = geom[lev].CellSize();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for(MFIter mfi(*div[lev], true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+
+            // Cells around the nodes of the tile
+            const Box& cells = amrex::grow(amrex::enclosedCells(mfi.validbox()), 1);
+            if(flags[mfi].getType(cells) != FabType::singlevalued)
+                continue;
+
+            const auto& flag = flags[mfi].array();
+            const auto& ba = bndryarea.array(mfi);
+            const auto& bc = bndrycent.array(mfi);
+            const auto& bn = bndrynorm.array(mfi);
+            const auto& ev = eb_vel[lev]->array(mfi);
+            const auto& d = div[lev]->array(mfi);
+
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
 
-    matrix.compDivergence(GetVecOfPtrs(divu), GetVecOfPtrs(vel)); 
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                Real flow = 0.0;
+                for(int c = 0; c < 8; c++)
+                {
+                    // The node is at the high end of the cell in direction d if a[d] = 1
+                    const int a[3] = {c & 1, (c >> 1) & 1, (c >> 2) & 1};
+                    const int ci = i - a[0];
+                    const int cj = j - a[1];
+                    const int ck = k - a[2];
+                    if(!flag(ci,cj,ck).isSingleValued())
+                        continue;
+
+                    Real basis = 1.0;
+                    Real flux = 0.0;
+                    for(int dir = 0; dir < 3; dir++)
+                    {
+                        const Real xi = 0.5 + bc(ci,cj,ck,dir);
+                        basis *= a[dir] ? xi : 1.0 - xi;
+                        flux += ev(ci,cj,ck,dir) * bn(ci,cj,ck,dir) / dx[dir];
+                    }
+                    flow += basis * flux * ba(ci,cj,ck);
+                }
+                d(i,j,k) += flow;
+            }
+        }
+    }
+#endif
 }
 
 void incflo::ComputeStrainrate()
@@ -61,6 +145,10 @@ void incflo::ComputeStrainrate()
         // Copy each FAB back from Sborder into the vel array, complete with filled ghost cells
         MultiFab::Copy(*vel[lev], Sborder, 0, 0, vel[lev]->nComp(), vel[lev]->nGrow());
 
+        // Volume fractions and boundary centroids set the filter width of the cut cells
+        const MultiFab& volfrac = ebfactory[lev]->getVolFrac();
+        const MultiCutFab& bndrycent = ebfactory[lev]->getBndryCent();
+
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
@@ -72,10 +160,12 @@ void incflo::ComputeStrainrate()
             // This is to check efficiently if this tile contains any eb stuff
             const EBFArrayBox& vel_fab = static_cast<EBFArrayBox const&>(Sborder[mfi]);
             const EBCellFlagFab& flags = vel_fab.getEBCellFlagFab();
+            TileCost::Timer tile_timer(TileCost::strainrate, lev, mfi, flags);
 
             if (flags.getType(bx) == FabType::covered)
             {
                 (*strainrate[lev])[mfi].setVal(1.2345e200, bx);
+                (*nu_t[lev])[mfi].setVal(0.0, bx);
             }
             else
             {
@@ -83,16 +173,26 @@ void incflo::ComputeStrainrate()
                 {
                     compute_strainrate(BL_TO_FORTRAN_BOX(bx),
                                        BL_TO_FORTRAN_ANYD((*strainrate[lev])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*nu_t[lev])[mfi]),
                                        BL_TO_FORTRAN_ANYD((*vel[lev])[mfi]),
-                                       geom[lev].CellSize());
+                                       AMREX_ZFILL(geom[lev].CellSize()),
+                                       &les_model, &les_coef);
                 }
                 else
                 {
+#if (AMREX_SPACEDIM == 3)
                     compute_strainrate_eb(BL_TO_FORTRAN_BOX(bx),
                                           BL_TO_FORTRAN_ANYD((*strainrate[lev])[mfi]),
+                                          BL_TO_FORTRAN_ANYD((*nu_t[lev])[mfi]),
                                           BL_TO_FORTRAN_ANYD((*vel[lev])[mfi]),
                                           BL_TO_FORTRAN_ANYD(flags),
-                                          geom[lev].CellSize());
+                                          BL_TO_FORTRAN_ANYD(volfrac[mfi]),
+                                          BL_TO_FORTRAN_ANYD(bndrycent[mfi]),
+                                          geom[lev].CellSize(),
+                                          &les_model, &les_coef);
+#else
+                    amrex::Abort("ComputeStrainrate: cut cells are only supported in 3D");
+#endif
                 }
             }
         }
@@ -108,7 +208,12 @@ void incflo::ComputeVorticity()
         Box domain(geom[lev].Domain());
         Real idx = 1.0 / geom[lev].CellSize()[0];
         Real idy = 1.0 / geom[lev].CellSize()[1];
+#if (AMREX_SPACEDIM == 3)
         Real idz = 1.0 / geom[lev].CellSize()[2];
+#else
+        // No z-derivatives in 2D
+        Real idz = 0.0;
+#endif
 
         // State with ghost cells
         MultiFab Sborder(grids[lev], dmap[lev], vel[lev]->nComp(), nghost, 
@@ -129,6 +234,7 @@ void incflo::ComputeVorticity()
             // This is to check efficiently if this tile contains any eb stuff
             const EBFArrayBox& vel_fab = static_cast<EBFArrayBox const&>(Sborder[mfi]);
             const EBCellFlagFab& flags = vel_fab.getEBCellFlagFab();
+            TileCost::Timer tile_timer(TileCost::vorticity, lev, mfi, flags);
 
             if (flags.getType(bx) == FabType::covered)
             {
@@ -138,31 +244,20 @@ void incflo::ComputeVorticity()
             {
                 if(flags.getType(amrex::grow(bx, 0)) == FabType::regular)
                 {
-                    const auto& vel_arr = Sborder.array(mfi);
-                    const auto& vort_arr = vort[lev]->array(mfi);
-
-                    for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
-                    for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
-                    for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
-                    {
-                        Real vx = (vel_arr(i+1, j  , k  , 1) - vel_arr(i-1, j  , k  , 1)) * idx;
-                        Real wx = (vel_arr(i+1, j  , k  , 2) - vel_arr(i-1, j  , k  , 2)) * idx;
-                        Real uy = (vel_arr(i  , j+1, k  , 0) - vel_arr(i  , j-1, k  , 0)) * idy;
-                        Real wy = (vel_arr(i  , j+1, k  , 2) - vel_arr(i  , j-1, k  , 2)) * idy;
-                        Real uz = (vel_arr(i  , j  , k+1, 0) - vel_arr(i  , j  , k-1, 0)) * idz;
-                        Real vz = (vel_arr(i  , j  , k+1, 1) - vel_arr(i  , j  , k-1, 1)) * idz;
-                        
-                        // The factor half is included here instead of in each of the above
-                        vort_arr(i,j,k) = 0.5 * sqrt(pow(wy - vz, 2) + pow(uz - wx, 2) + pow(vx - uy, 2));
-                    }
+                    incflo_kernels::compute_vorticity(bx, Sborder.array(mfi), vort[lev]->array(mfi),
+                                                      idx, idy, idz);
                 }
                 else
                 {
+#if (AMREX_SPACEDIM == 3)
                     compute_vort_eb(BL_TO_FORTRAN_BOX(bx),
                                     BL_TO_FORTRAN_ANYD((*vort[lev])[mfi]),
                                     BL_TO_FORTRAN_ANYD((*vel[lev])[mfi]),
                                     BL_TO_FORTRAN_ANYD(flags),
                                     geom[lev].CellSize());
+#else
+                    amrex::Abort("ComputeVorticity: cut cells are only supported in 3D");
+#endif
                 }
             }
         }
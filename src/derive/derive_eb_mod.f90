@@ -5,6 +5,7 @@ module derive_eb_module
    use iso_c_binding ,    only: c_int
 
    use constant,          only: zero, half, one, two, my_huge
+   use les_module,        only: turbulent_viscosity, les_none
 
    implicit none
    private
@@ -13,32 +14,51 @@ module derive_eb_module
 
 contains
 
+   !
+   ! Strain-rate magnitude and turbulent viscosity (see compute_strainrate) near the EB.
+   !
+   ! In cut cells the filter width is the cube root of the fluid volume, and it is
+   ! limited to twice the distance from the cell center to the boundary centroid,
+   ! so that the filter does not reach into the wall.
+   !
    subroutine compute_strainrate_eb(lo, hi,  &
                                     sr, slo, shi,    &
+                                    nut, nlo, nhi,    &
                                     vel, vlo, vhi,    &
                                     flags,    flo,  fhi, &
-                                    dx) bind(C)
+                                    vfrac,    vflo, vfhi, &
+                                    bcent,    blo,  bhi, &
+                                    dx, les_model, les_coef) bind(C)
 
       ! Loops bounds
       integer(c_int),  intent(in   ) :: lo(3),  hi(3)
 
       ! Array bounds
       integer(c_int),  intent(in   ) ::  slo(3),  shi(3)
+      integer(c_int),  intent(in   ) ::  nlo(3),  nhi(3)
       integer(c_int),  intent(in   ) ::  vlo(3),  vhi(3)
       integer(c_int),  intent(in   ) ::  flo(3),  fhi(3)
+      integer(c_int),  intent(in   ) :: vflo(3), vfhi(3)
+      integer(c_int),  intent(in   ) ::  blo(3),  bhi(3)
 
-      ! Grid
-      real(rt), intent(in   ) :: dx(3)
+      ! Grid and subgrid-scale model
+      real(rt),       intent(in   ) :: dx(3), les_coef
+      integer(c_int), intent(in   ) :: les_model
 
       ! Arrays
       real(rt), intent(in   ) ::   vel(vlo(1):vhi(1), vlo(2):vhi(2), vlo(3):vhi(3), 3)
       real(rt), intent(inout) ::    sr(slo(1):shi(1), slo(2):shi(2), slo(3):shi(3)   )
+      real(rt), intent(inout) ::   nut(nlo(1):nhi(1), nlo(2):nhi(2), nlo(3):nhi(3)   )
       integer,  intent(in   ) :: flags(flo(1):fhi(1), flo(2):fhi(2), flo(3):fhi(3)   )
+      real(rt), intent(in   ) :: vfrac(vflo(1):vfhi(1), vflo(2):vfhi(2), vflo(3):vfhi(3))
+      real(rt), intent(in   ) :: bcent(blo(1):bhi(1), blo(2):bhi(2), blo(3):bhi(3), 3)
 
       integer(c_int) :: i, j, k
       real(rt)       :: idx, idy, idz
       real(rt)       :: ux, uy, uz, vx, vy, vz, wx, wy, wz
       real(rt)       :: c0, c1, c2
+      real(rt)       :: delta, delta_reg, dwall
+      real(rt)       :: g(3,3)
 
       ! Coefficients for one-sided difference estimation
       c0 = -1.5d0
@@ -49,6 +69,8 @@ contains
       idy = one / dx(2)
       idz = one / dx(3)
 
+      delta_reg = (dx(1) * dx(2) * dx(3))**(one / 3.0d0)
+
       do k = lo(3), hi(3)
          do j = lo(2), hi(2)
             do i = lo(1), hi(1)
@@ -56,6 +78,7 @@ contains
                if (is_covered_cell(flags(i,j,k))) then
 
                   sr(i,j,k) = my_huge
+                  nut(i,j,k) = zero
 
                else if (is_single_valued_cell(flags(i,j,k))) then
 
@@ -133,6 +156,12 @@ contains
                   sr(i,j,k) = sqrt(two * ux**2 + two * vy**2 + two * wz**2 + & 
                                    (uy + vx)**2 + (vz + wy)**2 + (wx + uz)**2)
 
+                  ! Filter width of the cut cell
+                  dwall = sqrt((bcent(i,j,k,1) * dx(1))**2 + &
+                               (bcent(i,j,k,2) * dx(2))**2 + &
+                               (bcent(i,j,k,3) * dx(3))**2)
+                  delta = min(vfrac(i,j,k)**(one / 3.0d0) * delta_reg, two * dwall)
+
                else
 
                   ux = half * (vel(i+1,j,k,1) - vel(i-1,j,k,1)) * idx
@@ -151,6 +180,20 @@ contains
                   sr(i,j,k) = sqrt(two * ux**2 + two * vy**2 + two * wz**2 + & 
                                    (uy + vx)**2 + (vz + wy)**2 + (wx + uz)**2)
 
+                  delta = delta_reg
+
+               end if
+
+               ! Turbulent viscosity from the same gradient
+               if (.not. is_covered_cell(flags(i,j,k))) then
+                  if (les_model == les_none) then
+                     nut(i,j,k) = zero
+                  else
+                     g(1,:) = (/ ux, uy, uz /)
+                     g(2,:) = (/ vx, vy, vz /)
+                     g(3,:) = (/ wx, wy, wz /)
+                     nut(i,j,k) = turbulent_viscosity(g, delta, les_model, les_coef)
+                  end if
                end if
 
             end do
@@ -3,7 +3,8 @@ module derive_module
    use amrex_fort_module,  only : rt => amrex_real
    use iso_c_binding,      only: c_int
 
-   use constant,           only: zero, half, one, two
+   use constant,           only: zero, half, one, two, kz, rz, r_lo
+   use les_module,         only: turbulent_viscosity, les_none
 
    implicit none
    private
@@ -13,18 +14,25 @@ module derive_module
 contains
 
    !
-   ! Compute the magnitude of the rate-of-strain tensor
+   ! Compute the magnitude of the rate-of-strain tensor, and the turbulent viscosity
+   ! of the subgrid-scale model from the same velocity gradient (nu_t = 0 without LES)
+   !
+   ! In RZ coordinates the third direction is the azimuth, along which the gradient
+   ! of (u_r, u_z, u_theta) is ( -u_theta / r, 0, u_r / r )
    !
    subroutine compute_strainrate(lo, hi, &
                                  sr, slo, shi, &
+                                 nut, nlo, nhi, &
                                  vel, vlo, vhi, &
-                                 dx) bind(C)
+                                 dx, les_model, les_coef) bind(C)
       
       integer(c_int), intent(in   ) ::  lo(3), hi(3)
       integer(c_int), intent(in   ) :: slo(3),shi(3)
+      integer(c_int), intent(in   ) :: nlo(3),nhi(3)
       integer(c_int), intent(in   ) :: vlo(3),vhi(3)
+      integer(c_int), intent(in   ) :: les_model
 
-      real(rt),   intent(in   ) :: dx(3)
+      real(rt),   intent(in   ) :: dx(3), les_coef
 
       real(rt), intent(in   ) :: &
          vel(vlo(1):vhi(1),vlo(2):vhi(2),vlo(3):vhi(3),3)
@@ -32,15 +40,27 @@ contains
       real(rt),   intent(  out) :: &
          sr(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3))
 
+      real(rt),   intent(  out) :: &
+         nut(nlo(1):nhi(1),nlo(2):nhi(2),nlo(3):nhi(3))
+
       ! Local variables
       !-----------------------------------------------
       integer      :: i, j, k
-      real(rt) :: idx, idy, idz
+      real(rt) :: idx, idy, idz, delta, r
       real(rt) :: ux, uy, uz, vx, vy, vz, wx, wy, wz
+      real(rt) :: g(3,3)
 
       idx = one / dx(1)
       idy = one / dx(2)
-      idz = one / dx(3)
+      idz = zero
+      if (kz > 0) idz = one / dx(3)
+
+      ! Filter width
+      if (kz > 0) then
+         delta = (dx(1) * dx(2) * dx(3))**(one / 3.0d0)
+      else
+         delta = sqrt(dx(1) * dx(2))
+      end if
 
       do k = lo(3),hi(3)
          do j = lo(2),hi(2)
@@ -54,15 +74,31 @@ contains
                vy = (vel(i  ,j+1,k  ,2) - vel(i  ,j-1,k  ,2)) * idy
                wy = (vel(i  ,j+1,k  ,3) - vel(i  ,j-1,k  ,3)) * idy
                                                                 
-               uz = (vel(i  ,j  ,k+1,1) - vel(i  ,j  ,k-1,1)) * idz
-               vz = (vel(i  ,j  ,k+1,2) - vel(i  ,j  ,k-1,2)) * idz
-               wz = (vel(i  ,j  ,k+1,3) - vel(i  ,j  ,k-1,3)) * idz
+               uz = (vel(i  ,j  ,k+kz,1) - vel(i  ,j  ,k-kz,1)) * idz
+               vz = (vel(i  ,j  ,k+kz,2) - vel(i  ,j  ,k-kz,2)) * idz
+               wz = (vel(i  ,j  ,k+kz,3) - vel(i  ,j  ,k-kz,3)) * idz
+
+               ! Like the differences above, these are twice the derivatives
+               if (rz) then
+                  r  = r_lo + (i + half) * dx(1)
+                  uz = - two * vel(i,j,k,3) / r
+                  wz =   two * vel(i,j,k,1) / r
+               end if
                
                ! The factor half is included here instead of in each of the above
                sr(i,j,k) = half * &
                   sqrt(two * ux**2 + two * vy**2 + two * wz**2 + &
                        (uy + vx)**2 + (vz + wy)**2 + (wx + uz)**2)
 
+               if (les_model == les_none) then
+                  nut(i,j,k) = zero
+               else
+                  g(1,:) = half * (/ ux, uy, uz /)
+                  g(2,:) = half * (/ vx, vy, vz /)
+                  g(3,:) = half * (/ wx, wy, wz /)
+                  nut(i,j,k) = turbulent_viscosity(g, delta, les_model, les_coef)
+               end if
+
             end do
          end do
       end do
@@ -6,6 +6,9 @@
 
 #include <DiffusionEquation.H>
 #include <diffusion_F.H>
+#include <MemReport.H>
+#include <PerfLog.H>
+#include <SolverTuning.H>
 #include <constants.H>
 
 using namespace amrex;
@@ -22,7 +25,7 @@ DiffusionEquation::DiffusionEquation(AmrCore* _amrcore,
                                      Vector<std::unique_ptr<IArrayBox>>& bc_jhi,
                                      Vector<std::unique_ptr<IArrayBox>>& bc_klo,
                                      Vector<std::unique_ptr<IArrayBox>>& bc_khi,
-                                     int _nghost, Real _cyl_speed)
+                                     int _nghost)
 {
     // Get inputs from ParmParse
 	readParameters();
@@ -32,38 +35,64 @@ DiffusionEquation::DiffusionEquation(AmrCore* _amrcore,
         amrex::Print() << "Constructing DiffusionEquation class" << std::endl;
     }
 
-    // Set AmrCore and ebfactory based on input, fetch some data needed in constructor
-    amrcore = _amrcore;
-    ebfactory = _ebfactory;
     nghost = _nghost;
-    Vector<Geometry> geom = amrcore->Geom();
-    Vector<BoxArray> grids = amrcore->boxArray();
-    Vector<DistributionMapping> dmap = amrcore->DistributionMap();
-    int max_level = amrcore->maxLevel();
-
-    // Cylinder speed
-    cyl_speed = _cyl_speed;
 
     // Whole domain
-    Box domain(geom[0].Domain());
+    Box domain(_amrcore->Geom(0).Domain());
 
     // The boundary conditions need only be set at level 0
-    set_diff_bc(bc_lo, bc_hi,
-                domain.loVect(), domain.hiVect(),
+    set_diff_bc(bc_lo, bc_hi, sym_lo, sym_hi,
+                BL_TO_FORTRAN_BOX(domain),
 				&nghost,
                 bc_ilo[0]->dataPtr(), bc_ihi[0]->dataPtr(),
                 bc_jlo[0]->dataPtr(), bc_jhi[0]->dataPtr(),
                 bc_klo[0]->dataPtr(), bc_khi[0]->dataPtr());
 
+    // Allocate the data and define the matrix
+    updateInternals(_amrcore, _ebfactory);
+}
+
+DiffusionEquation::~DiffusionEquation()
+{
+}
+
+void DiffusionEquation::readParameters()
+{
+    ParmParse pp("diffusion");
+
+    pp.query("verbose", verbose);
+    pp.query("mg_verbose", mg_verbose);
+    pp.query("mg_cg_verbose", mg_cg_verbose);
+    pp.query("mg_max_iter", mg_max_iter);
+    pp.query("mg_cg_maxiter", mg_cg_maxiter);
+    pp.query("mg_max_fmg_iter", mg_max_fmg_iter);
+    pp.query("mg_max_coarsening_level", mg_max_coarsening_level);
+    pp.query("mg_pre_smooth", mg_pre_smooth);
+    pp.query("mg_post_smooth", mg_post_smooth);
+    pp.query("mg_agglomeration", mg_agglomeration);
+    pp.query("mg_rtol", mg_rtol);
+    pp.query("mg_atol", mg_atol);
+    pp.query("bottom_solver_type", bottom_solver_type);
+}
+
+void DiffusionEquation::updateInternals(AmrCore* amrcore_in,
+                                        Vector<std::unique_ptr<EBFArrayBoxFactory>>* ebfactory_in)
+{
+    // Set AmrCore and ebfactory based on input
+    amrcore = amrcore_in;
+    ebfactory = ebfactory_in;
+    Vector<BoxArray> grids = amrcore->boxArray();
+    Vector<DistributionMapping> dmap = amrcore->DistributionMap();
+    int max_level = amrcore->maxLevel();
+
     // Resize and reset data
     b.resize(max_level + 1);
     phi.resize(max_level + 1);
     rhs.resize(max_level + 1);
-    ueb.resize(max_level + 1);
-    veb.resize(max_level + 1);
+    phieb.resize(max_level + 1);
     for(int lev = 0; lev <= max_level; lev++)
     {
-        for(int dir = 0; dir < 3; dir++)
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
         {
             BoxArray edge_ba = grids[lev];
             edge_ba.surroundingNodes(dir);
@@ -74,96 +103,168 @@ DiffusionEquation::DiffusionEquation(AmrCore* _amrcore,
                                     MFInfo(), *(*ebfactory)[lev]));
         rhs[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost,
                                     MFInfo(), *(*ebfactory)[lev]));
-        ueb[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost,
-                                    MFInfo(), *(*ebfactory)[lev]));
-        veb[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost,
-                                    MFInfo(), *(*ebfactory)[lev]));
+        phieb[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost,
+                                      MFInfo(), *(*ebfactory)[lev]));
     }
 
-    // Fill the Dirichlet values on the EB surface
-    for(int lev = 0; lev <= max_level; lev++)
-    {
-        // Get EB normal vector
-        const amrex::MultiCutFab*                 bndrynormal;
-        bndrynormal = &((*ebfactory)[lev] -> getBndryNormal());
+    defineMatrix();
+}
 
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-        for(MFIter mfi(*ueb[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
-        {
-            // Tilebox
-            Box bx = mfi.tilebox();
+//
+// The EB operators make the EB factories of their coarse levels when they are defined:
+// they are defined again for a moved EB
+//
+void DiffusionEquation::updateEB()
+{
+    BL_PROFILE("DiffusionEquation::updateEB()");
 
-            // This is to check efficiently if this tile contains any eb stuff
-            const EBFArrayBox& ueb_fab = static_cast<EBFArrayBox const&>((*ueb[lev])[mfi]);
-            const EBCellFlagFab& flags = ueb_fab.getEBCellFlagFab();
+    defineMatrix();
+}
 
-            if (flags.getType(bx) == FabType::covered || flags.getType(bx) == FabType::regular)
-            {
-                (*ueb[lev])[mfi].setVal(0.0, bx);
-                (*veb[lev])[mfi].setVal(0.0, bx);
-            }
-            else
-            {
-                const auto& ueb_arr = ueb[lev]->array(mfi);
-                const auto& veb_arr = veb[lev]->array(mfi);
-                const auto& nrm_fab = bndrynormal->array(mfi);
-
-                for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
-                for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
-                for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
-                {
-                    Real theta = atan2(-nrm_fab(i,j,k,1), -nrm_fab(i,j,k,0));
-                    ueb_arr(i,j,k) =   cyl_speed * sin(theta);
-                    veb_arr(i,j,k) = - cyl_speed * cos(theta);
-                }
-            }
-        }
-    }
+void DiffusionEquation::defineMatrix()
+{
+    Vector<Geometry> geom = amrcore->Geom();
+    Vector<BoxArray> grids = amrcore->boxArray();
+    Vector<DistributionMapping> dmap = amrcore->DistributionMap();
+    int max_level = amrcore->maxLevel();
 
 	// Define the matrix.
 	LPInfo info;
     info.setMaxCoarseningLevel(mg_max_coarsening_level);
-    matrix.define(geom, grids, dmap, info, GetVecOfConstPtrs(*ebfactory));
+    info.setAgglomeration(mg_agglomeration);
+    if(geom[0].IsRZ())
+    {
+        // The EB operator has no metric terms, and there is no EB in RZ coordinates
+        acoef.resize(max_level + 1);
+        for(int lev = 0; lev <= max_level; lev++)
+        {
+            acoef[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, 0));
+        }
+        rz_matrix.reset(new MLABecLaplacian(geom, grids, dmap, info));
+    }
+    else
+    {
+        matrix.reset(new MLEBABecLap(geom, grids, dmap, info, GetVecOfConstPtrs(*ebfactory)));
+    }
 
     // It is essential that we set MaxOrder to 2 if we want to use the standard
     // phi(i)-phi(i-1) approximation for the gradient at Dirichlet boundaries.
     // The solver's default order is 3 and this uses three points for the gradient.
-	matrix.setMaxOrder(2);
+	velocityOperator().setMaxOrder(2);
 
 	// LinOpBCType Definitions are in amrex/Src/Boundary/AMReX_LO_BCTYPES.H
-	matrix.setDomainBC({(LinOpBCType) bc_lo[0], (LinOpBCType) bc_lo[1], (LinOpBCType) bc_lo[2]},
-					   {(LinOpBCType) bc_hi[0], (LinOpBCType) bc_hi[1], (LinOpBCType) bc_hi[2]});
+	setVelocityDomainBC(0);
+
+    if(has_scal_bc)
+    {
+        defineScalarMatrix();
+    }
 }
 
-DiffusionEquation::~DiffusionEquation()
+void DiffusionEquation::setScalarBC(const int* lo, const int* hi)
 {
+    for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+    {
+        scal_bc_lo[dir] = lo[dir];
+        scal_bc_hi[dir] = hi[dir];
+    }
+    has_scal_bc = true;
+
+    defineScalarMatrix();
 }
 
-void DiffusionEquation::readParameters()
+void DiffusionEquation::defineScalarMatrix()
 {
-    ParmParse pp("diffusion");
+	LPInfo info;
+    info.setMaxCoarseningLevel(mg_max_coarsening_level);
+    info.setAgglomeration(mg_agglomeration);
 
-    pp.query("verbose", verbose);
-    pp.query("mg_verbose", mg_verbose);
-    pp.query("mg_cg_verbose", mg_cg_verbose);
-    pp.query("mg_max_iter", mg_max_iter);
-    pp.query("mg_cg_maxiter", mg_cg_maxiter);
-    pp.query("mg_max_fmg_iter", mg_max_fmg_iter);
-    pp.query("mg_max_coarsening_level", mg_max_coarsening_level);
-    pp.query("mg_rtol", mg_rtol);
-    pp.query("mg_atol", mg_atol);
-    pp.query("bottom_solver_type", bottom_solver_type);
+    MLCellLinOp* op;
+    if(amrcore->Geom(0).IsRZ())
+    {
+        rz_scal_matrix.reset(new MLABecLaplacian(amrcore->Geom(), amrcore->boxArray(),
+                                                 amrcore->DistributionMap(), info));
+        op = rz_scal_matrix.get();
+    }
+    else
+    {
+        scal_matrix.reset(new MLEBABecLap(amrcore->Geom(), amrcore->boxArray(), amrcore->DistributionMap(),
+                                          info, GetVecOfConstPtrs(*ebfactory)));
+        op = scal_matrix.get();
+    }
+
+    // See the velocity matrix above
+	op->setMaxOrder(2);
+
+	op->setDomainBC({AMREX_D_DECL((LinOpBCType) scal_bc_lo[0], (LinOpBCType) scal_bc_lo[1], (LinOpBCType) scal_bc_lo[2])},
+                    {AMREX_D_DECL((LinOpBCType) scal_bc_hi[0], (LinOpBCType) scal_bc_hi[1], (LinOpBCType) scal_bc_hi[2])});
+
+    // Without an EB boundary condition the walls are homogeneous Neumann (insulating)
 }
 
-void DiffusionEquation::updateInternals(AmrCore* amrcore_in,
-                                        Vector<std::unique_ptr<EBFArrayBoxFactory>>* ebfactory_in)
+//
+// Set the domain BCs of the velocity component dir: the same for all the components,
+// except on the symmetry planes normal to dir, where the velocity is zero (Dirichlet)
+//
+void DiffusionEquation::setVelocityDomainBC(int dir)
 {
-    // This must be implemented when we want dynamic meshing
-    //
-    amrex::Print() << "ERROR: DiffusionEquation::updateInternals() not yet implemented" << std::endl;
-    amrex::Abort();
+    int lo[3], hi[3];
+    for(int d = 0; d < 3; d++)
+    {
+        lo[d] = (sym_lo[d] && d == dir) ? static_cast<int>(LinOpBCType::Dirichlet) : bc_lo[d];
+        hi[d] = (sym_hi[d] && d == dir) ? static_cast<int>(LinOpBCType::Dirichlet) : bc_hi[d];
+    }
+
+	velocityOperator().setDomainBC({AMREX_D_DECL((LinOpBCType) lo[0], (LinOpBCType) lo[1], (LinOpBCType) lo[2])},
+					               {AMREX_D_DECL((LinOpBCType) hi[0], (LinOpBCType) hi[1], (LinOpBCType) hi[2])});
+}
+
+MLCellLinOp& DiffusionEquation::velocityOperator()
+{
+    if(rz_matrix)
+    {
+        return *rz_matrix;
+    }
+    return *matrix;
+}
+
+void DiffusionEquation::setRZACoeffs(int dir,
+                                     const Vector<std::unique_ptr<MultiFab>>& ro,
+                                     const Vector<std::unique_ptr<MultiFab>>& eta,
+                                     Real dt)
+{
+    // Only u_r and u_theta have a hoop term
+    const bool hoop = (dir != 1);
+
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        const Real dr = amrcore->Geom(lev).CellSize(0);
+        const Real r_lo = amrcore->Geom(lev).ProbLo(0);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi(*acoef[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            const auto& a = acoef[lev]->array(mfi);
+            const auto& rho = ro[lev]->array(mfi);
+            const auto& e = eta[lev]->array(mfi);
+
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                const Real r = r_lo + (i + 0.5) * dr;
+                a(i,j,k) = rho(i,j,k) + (hoop ? dt * e(i,j,k) / (r * r) : 0.0);
+            }
+        }
+
+        rz_matrix->setACoeffs(lev, *acoef[lev]);
+    }
 }
 
 //
@@ -172,9 +273,28 @@ void DiffusionEquation::updateInternals(AmrCore* amrcore_in,
 void DiffusionEquation::solve(Vector<std::unique_ptr<MultiFab>>& vel,
                               const Vector<std::unique_ptr<MultiFab>>& ro,
                               const Vector<std::unique_ptr<MultiFab>>& eta,
+                              const Vector<std::unique_ptr<MultiFab>>* eb_vel,
                               Real dt)
+{
+    if(SolverTuning::needsTuning("diffusion"))
+    {
+        tune(vel, ro, eta, eb_vel, dt);
+    }
+
+    doSolve(vel, ro, eta, eb_vel, dt);
+}
+
+SolverTuning::Result DiffusionEquation::doSolve(Vector<std::unique_ptr<MultiFab>>& vel,
+                                                const Vector<std::unique_ptr<MultiFab>>& ro,
+                                                const Vector<std::unique_ptr<MultiFab>>& eta,
+                                                const Vector<std::unique_ptr<MultiFab>>* eb_vel,
+                                                Real dt)
 {
 	BL_PROFILE("DiffusionEquation::solve");
+	PerfLog::Timer perf_timer(PerfLog::diffusion);
+
+    // Iterations of the three solves, and the largest final residual
+    SolverTuning::Result result = {0, 0.0};
 
     // Update the coefficients of the matrix going into the solve based on the current state of the
     // simulation. Recall that the relevant matrix is
@@ -189,20 +309,34 @@ void DiffusionEquation::solve(Vector<std::unique_ptr<MultiFab>>& vel,
     //      b: eta
 
     // Set alpha and beta
-    matrix.setScalars(1.0, dt);
+    if(rz_matrix)
+    {
+        rz_matrix->setScalars(1.0, dt);
+    }
+    else
+    {
+        matrix->setScalars(1.0, dt);
+    }
 
     for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
     {
         // Compute the spatially varying b coefficients (on faces) to equal the apparent viscosity
         average_cellcenter_to_face(GetArrOfPtrs(b[lev]), *eta[lev], amrcore->Geom(lev));
-        for(int dir = 0; dir < 3; dir++)
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
         {
             b[lev][dir]->FillBoundary(amrcore->Geom(lev).periodicity());
         }
         
-        // This sets the coefficients
-        matrix.setACoeffs(lev, (*ro[lev]));
-        matrix.setBCoeffs(lev, GetArrOfConstPtrs(b[lev])); 
+        // This sets the coefficients (in RZ the a coefficients depend on the component)
+        if(rz_matrix)
+        {
+            rz_matrix->setBCoeffs(lev, GetArrOfConstPtrs(b[lev]));
+        }
+        else
+        {
+            matrix->setACoeffs(lev, (*ro[lev]));
+            matrix->setBCoeffs(lev, GetArrOfConstPtrs(b[lev])); 
+        }
     }
 
     if(verbose > 0)
@@ -210,9 +344,17 @@ void DiffusionEquation::solve(Vector<std::unique_ptr<MultiFab>>& vel,
         amrex::Print() << "Diffusing velocity..." << std::endl; 
     }
 
-    // Loop over the velocity components
+    // Loop over the velocity components (all three of them, also in 2D)
     for(int dir = 0; dir < 3; dir++)
     {
+        if(rz_matrix)
+        {
+            setRZACoeffs(dir, ro, eta, dt);
+        }
+
+        // The normal velocity is zero on a symmetry plane: this must be set before setLevelBC
+        setVelocityDomainBC(dir);
+
         for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
         {
             // Set the right hand side to equal rho
@@ -228,26 +370,30 @@ void DiffusionEquation::solve(Vector<std::unique_ptr<MultiFab>>& vel,
             // By this point we must have filled the Dirichlet values of phi stored in ghost cells
             phi[lev]->copy(*vel[lev], dir, 0, 1, nghost, nghost);
             phi[lev]->FillBoundary(amrcore->Geom(lev).periodicity());
-            matrix.setLevelBC(lev, GetVecOfConstPtrs(phi)[lev]);
+            velocityOperator().setLevelBC(lev, GetVecOfConstPtrs(phi)[lev]);
 
             // This sets the coefficient on the wall and defines the wall as a Dirichlet bc
-            if(cyl_speed > 0.0 && dir == 0)
+            if(rz_matrix)
             {
-                matrix.setEBDirichlet(lev, *ueb[lev], *eta[lev]);
+                continue;
             }
-            else if(cyl_speed > 0.0 && dir == 1)
+            if(eb_vel != nullptr)
             {
-                matrix.setEBDirichlet(lev, *veb[lev], *eta[lev]);
+                MultiFab::Copy(*phieb[lev], *(*eb_vel)[lev], dir, 0, 1, nghost);
+                matrix->setEBDirichlet(lev, *phieb[lev], *eta[lev]);
             }
             else
             {
-                matrix.setEBHomogDirichlet(lev, *eta[lev]);
+                matrix->setEBHomogDirichlet(lev, *eta[lev]);
             }
         }
 
-        MLMG solver(matrix);
+        MLMG solver(velocityOperator());
         setSolverSettings(solver);
         solver.solve(GetVecOfPtrs(phi), GetVecOfConstPtrs(rhs), mg_rtol, mg_atol);
+        PerfLog::addSolve(std::string("diffusion_") + "uvw"[dir], solver.getNumIters(), solver.getFinalResidual());
+        result.iterations += solver.getNumIters();
+        result.residual = std::max(result.residual, solver.getFinalResidual());
 
         for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
         {
@@ -261,6 +407,129 @@ void DiffusionEquation::solve(Vector<std::unique_ptr<MultiFab>>& vel,
         }
 
     }
+
+    return result;
+}
+
+void DiffusionEquation::tune(Vector<std::unique_ptr<MultiFab>>& vel,
+                             const Vector<std::unique_ptr<MultiFab>>& ro,
+                             const Vector<std::unique_ptr<MultiFab>>& eta,
+                             const Vector<std::unique_ptr<MultiFab>>* eb_vel,
+                             Real dt)
+{
+    // vel holds the right hand side and is overwritten by every solve
+    Vector<std::unique_ptr<MultiFab>> vel0(vel.size());
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        vel0[lev].reset(new MultiFab(vel[lev]->boxArray(), vel[lev]->DistributionMap(),
+                                     vel[lev]->nComp(), vel[lev]->nGrow()));
+        MultiFab::Copy(*vel0[lev], *vel[lev], 0, 0, vel[lev]->nComp(), vel[lev]->nGrow());
+    }
+
+    SolverTuning::tune("diffusion",
+                       {bottom_solver_type, mg_max_coarsening_level, mg_pre_smooth, mg_agglomeration},
+                       [&](const SolverTuning::Settings& s)
+                       {
+                           bottom_solver_type = s.bottom_solver;
+                           mg_max_coarsening_level = s.max_coarsening_level;
+                           mg_pre_smooth = mg_post_smooth = s.smooth;
+                           mg_agglomeration = s.agglomeration;
+                           updateInternals(amrcore, ebfactory);
+                       },
+                       [&]()
+                       {
+                           for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+                           {
+                               MultiFab::Copy(*vel[lev], *vel0[lev], 0, 0, vel[lev]->nComp(), vel[lev]->nGrow());
+                           }
+                           return doSolve(vel, ro, eta, eb_vel, dt);
+                       });
+
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        MultiFab::Copy(*vel[lev], *vel0[lev], 0, 0, vel[lev]->nComp(), vel[lev]->nGrow());
+    }
+}
+
+//
+// Solve the matrix equation of the scalars, one component at a time
+//
+void DiffusionEquation::solveScalars(Vector<std::unique_ptr<MultiFab>>& scal,
+                                     const Vector<Real>& diffusivity,
+                                     Real dt)
+{
+	BL_PROFILE("DiffusionEquation::solveScalars");
+	PerfLog::Timer perf_timer(PerfLog::diffusion);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(has_scal_bc, "setScalarBC must be called before solveScalars");
+
+    // The coefficients are constant, so we use a = b = 1 and the diffusivity goes in beta:
+    //
+    //      alpha a - beta div ( b grad )   <--->   1 - dt D div ( grad )
+    //
+    // The matrix copies the coefficients, so rhs and b can be used to pass them.
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        rhs[lev]->setVal(1.0);
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+        {
+            b[lev][dir]->setVal(1.0);
+        }
+        if(rz_scal_matrix)
+        {
+            rz_scal_matrix->setACoeffs(lev, *rhs[lev]);
+            rz_scal_matrix->setBCoeffs(lev, GetArrOfConstPtrs(b[lev]));
+        }
+        else
+        {
+            scal_matrix->setACoeffs(lev, *rhs[lev]);
+            scal_matrix->setBCoeffs(lev, GetArrOfConstPtrs(b[lev]));
+        }
+    }
+    MLCellLinOp& op = rz_scal_matrix ? static_cast<MLCellLinOp&>(*rz_scal_matrix) : *scal_matrix;
+
+    for(int n = 0; n < diffusivity.size(); n++)
+    {
+        if(diffusivity[n] <= 0.0)
+        {
+            continue;
+        }
+
+        if(verbose > 0)
+        {
+            amrex::Print() << "Diffusing scalar " << n << "..." << std::endl;
+        }
+
+        if(rz_scal_matrix)
+        {
+            rz_scal_matrix->setScalars(1.0, dt * diffusivity[n]);
+        }
+        else
+        {
+            scal_matrix->setScalars(1.0, dt * diffusivity[n]);
+        }
+
+        for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+        {
+            rhs[lev]->copy(*scal[lev], n, 0, 1, nghost, nghost);
+
+            // By this point we must have filled the Dirichlet values of phi stored in ghost cells
+            phi[lev]->copy(*scal[lev], n, 0, 1, nghost, nghost);
+            phi[lev]->FillBoundary(amrcore->Geom(lev).periodicity());
+            op.setLevelBC(lev, GetVecOfConstPtrs(phi)[lev]);
+        }
+
+        MLMG solver(op);
+        setSolverSettings(solver);
+        solver.solve(GetVecOfPtrs(phi), GetVecOfConstPtrs(rhs), mg_rtol, mg_atol);
+        PerfLog::addSolve("diffusion_scalar_" + std::to_string(n), solver.getNumIters(), solver.getFinalResidual());
+
+        for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+        {
+            phi[lev]->FillBoundary(amrcore->Geom(lev).periodicity());
+            scal[lev]->copy(*phi[lev], 0, n, 1, nghost, nghost);
+        }
+    }
 }
 
 //
@@ -274,6 +543,22 @@ void DiffusionEquation::setSolverSettings(MLMG& solver)
     {
        solver.setBottomSolver(MLMG::BottomSolver::smoother);
     }
+    else if(bottom_solver_type == "bicg" || bottom_solver_type == "bicgstab")
+    {
+       solver.setBottomSolver(MLMG::BottomSolver::bicgstab);
+    }
+    else if(bottom_solver_type == "cg")
+    {
+       solver.setBottomSolver(MLMG::BottomSolver::cg);
+    }
+    else if(bottom_solver_type == "bicgcg")
+    {
+       solver.setBottomSolver(MLMG::BottomSolver::bicgcg);
+    }
+    else if(bottom_solver_type == "cgbicg")
+    {
+       solver.setBottomSolver(MLMG::BottomSolver::cgbicg);
+    }
     else if(bottom_solver_type == "hypre")
     {
        solver.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -284,6 +569,13 @@ void DiffusionEquation::setSolverSettings(MLMG& solver)
 	solver.setMaxFmgIter(mg_max_fmg_iter);
 	solver.setCGMaxIter(mg_cg_maxiter);
 
+    // Trial solves of the solver tuning may not converge
+    solver.setThrowException(SolverTuning::inTrial());
+
+    // Smoothing sweeps on the way down and up the V-cycle
+    solver.setPreSmooth(mg_pre_smooth);
+    solver.setPostSmooth(mg_post_smooth);
+
     // Verbosity for MultiGrid / ConjugateGradients
 	solver.setVerbose(mg_verbose);
 	solver.setCGVerbose(mg_cg_verbose);
@@ -292,3 +584,20 @@ void DiffusionEquation::setSolverSettings(MLMG& solver)
 	solver.setFinalFillBC(true);
 }
 
+void DiffusionEquation::accountMemory() const
+{
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+        {
+            MemReport::add("solver", std::string("diffusion_b_") + "xyz"[dir], lev, *b[lev][dir]);
+        }
+        MemReport::add("solver", "diffusion_phi", lev, *phi[lev]);
+        MemReport::add("solver", "diffusion_rhs", lev, *rhs[lev]);
+        MemReport::add("solver", "diffusion_phieb", lev, *phieb[lev]);
+        if(lev < acoef.size())
+        {
+            MemReport::add("solver", "diffusion_acoef", lev, *acoef[lev]);
+        }
+    }
+}
@@ -12,11 +12,15 @@
 // Explicit part of divergence of stress tensor: 
 // div ( eta (grad u)^T )
 //
+// In RZ coordinates this also holds the metric terms of the stress that the
+// implicit solve does not take (see compute_divtau_rz)
+//
 void incflo::ComputeDivTau(int lev,
                            MultiFab& divtau_in,
                            Vector<std::unique_ptr<MultiFab>>& vel_in)
 {
     BL_PROFILE("incflo::ComputeDivTau");
+    PerfLog::Timer perf_timer(PerfLog::divtau);
     Box domain(geom[lev].Domain());
 
     EB_set_covered(*vel[lev], covered_val);
@@ -43,6 +47,7 @@ void incflo::ComputeDivTau(int lev,
         // this is to check efficiently if this tile contains any eb stuff
         const EBFArrayBox&  vel_fab = static_cast<EBFArrayBox const&>((*vel_in[lev])[mfi]);
         const EBCellFlagFab&  flags = vel_fab.getEBCellFlagFab();
+        TileCost::Timer tile_timer(TileCost::divtau, lev, mfi, flags);
 
         if (flags.getType(bx) == FabType::covered)
         {
@@ -50,21 +55,35 @@ void incflo::ComputeDivTau(int lev,
         }
         else
         {
-            if (flags.getType(amrex::grow(bx,nghost)) == FabType::regular)
+            if (geom[lev].IsRZ())
+            {
+                compute_divtau_rz(BL_TO_FORTRAN_BOX(bx),
+                                  BL_TO_FORTRAN_ANYD(divtau_in[mfi]),
+                                  BL_TO_FORTRAN_ANYD((*vel_in[lev])[mfi]),
+                                  (*eta[lev])[mfi].dataPtr(),
+                                  BL_TO_FORTRAN_ANYD((*ro[lev])[mfi]),
+                                  BL_TO_FORTRAN_BOX(domain),
+                                  bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
+                                  bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
+                                  bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
+                                  AMREX_ZFILL(geom[lev].CellSize()), &nghost);
+            }
+            else if (flags.getType(amrex::grow(bx,nghost)) == FabType::regular)
             {
                 compute_divtau(BL_TO_FORTRAN_BOX(bx),
                                BL_TO_FORTRAN_ANYD(divtau_in[mfi]),
                                BL_TO_FORTRAN_ANYD((*vel_in[lev])[mfi]),
                                (*eta[lev])[mfi].dataPtr(),
                                BL_TO_FORTRAN_ANYD((*ro[lev])[mfi]),
-                               domain.loVect (), domain.hiVect (),
+                               BL_TO_FORTRAN_BOX(domain),
                                bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
                                bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
                                bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
-                               geom[lev].CellSize(), &nghost);
+                               AMREX_ZFILL(geom[lev].CellSize()), &nghost);
             }
             else
             {
+#if (AMREX_SPACEDIM == 3)
                 compute_divtau_eb(BL_TO_FORTRAN_BOX(bx),
                                   BL_TO_FORTRAN_ANYD(divtau_in[mfi]),
                                   BL_TO_FORTRAN_ANYD((*vel_in[lev])[mfi]),
@@ -83,7 +102,11 @@ void incflo::ComputeDivTau(int lev,
                                   bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
                                   bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
                                   bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
-                                  geom[lev].CellSize(), &nghost, &cyl_speed);
+                                  BL_TO_FORTRAN_ANYD((*eb_vel[lev])[mfi]),
+                                  geom[lev].CellSize(), &nghost);
+#else
+                amrex::Abort("ComputeDivTau: cut cells are only supported in 3D");
+#endif
             }
         }
    }
@@ -5,7 +5,7 @@ module eb_diffusion_mod
    use amrex_mempool_module,  only: amrex_allocate, amrex_deallocate
    use iso_c_binding,         only: c_int
 
-   use constant,              only: zero, half, one, two
+   use constant,              only: zero, half, one, two, kz
 
    implicit none
    private
@@ -33,7 +33,8 @@ contains
                                 bc_ilo, bc_ihi,      &
                                 bc_jlo, bc_jhi,      &
                                 bc_klo, bc_khi,      &
-                                dx, ng, cyl_speed) bind(C)
+                                ebvel,   evlo, evhi, &
+                                dx, ng) bind(C)
 
       use diffusion_mod, only: fill_vel_diff_bc
       use divop_mod,     only: compute_divop
@@ -57,6 +58,7 @@ contains
       integer(c_int),  intent(in   ) :: czlo(3), czhi(3)
       integer(c_int),  intent(in   ) :: vflo(3), vfhi(3)
       integer(c_int),  intent(in   ) ::  blo(3),  bhi(3)
+      integer(c_int),  intent(in   ) :: evlo(3), evhi(3)
       integer(c_int),  intent(in   ) ::domlo(3),domhi(3)
 
       ! Grid
@@ -74,7 +76,8 @@ contains
            &  cent_y( cylo(1): cyhi(1), cylo(2): cyhi(2), cylo(3): cyhi(3),2), &
            &  cent_z( czlo(1): czhi(1), czlo(2): czhi(2), czlo(3): czhi(3),2), &
            &   vfrac( vflo(1): vfhi(1), vflo(2): vfhi(2), vflo(3): vfhi(3)  ), &
-           &   bcent(  blo(1):  bhi(1),  blo(2):  bhi(2),  blo(3):  bhi(3),3)
+           &   bcent(  blo(1):  bhi(1),  blo(2):  bhi(2),  blo(3):  bhi(3),3), &
+           &   ebvel( evlo(1): evhi(1), evlo(2): evhi(2), evlo(3): evhi(3),3)
 
       real(rt),  intent(inout) ::                                 &
          divtau(dlo(1):dhi(1),dlo(2):dhi(2),dlo(3):dhi(3),3)
@@ -84,16 +87,13 @@ contains
 
       ! BC types
       integer, intent(in   ) ::  &
-         bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-         bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-         bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-         bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+         bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
          bc_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
          bc_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
-      ! Rotating cylinder 
-      real(rt),       intent(in   ) :: cyl_speed
-
       ! Temporary array just to handle bc's
       integer(c_int) :: vlo(3), vhi(3)
       real(rt), dimension(:,:,:,:), pointer, contiguous :: vel
@@ -160,7 +160,7 @@ contains
          fyhi = hi + nh + [0,1,0]
          fzhi = hi + nh + [0,0,1]
 
-         call compute_divop( lo, hi, &
+         call compute_divop( lo, hi, 3, &
                             divtau, dlo, dhi, &
                             vel, vlo, vhi, &
                             fx, fxlo, fxhi, &
@@ -176,7 +176,8 @@ contains
                             vfrac, vflo, vfhi, &
                             bcent, blo, bhi, &
                             domlo, domhi, &
-                            dx, ng, eta, cyl_speed)
+                            dx, ng, eta, &
+                            ebvel(vlo(1):vhi(1),vlo(2):vhi(2),vlo(3):vhi(3),:))
 
       end block divop
 
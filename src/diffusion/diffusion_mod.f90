@@ -14,7 +14,7 @@ module diffusion_mod
    use amrex_mempool_module,  only: amrex_allocate, amrex_deallocate
    use iso_c_binding,         only: c_int
 
-   use constant,              only: zero, half, one, two
+   use constant,              only: zero, half, one, two, kz, rz, r_lo
 
    implicit none
    private
@@ -22,6 +22,7 @@ module diffusion_mod
    real(rt), parameter :: q4 = one / ( two * two )
 
    public compute_divtau
+   public compute_divtau_rz
    public fill_vel_diff_bc
 
 contains
@@ -74,10 +75,10 @@ contains
 
       ! BC types
       integer(c_int), intent(in   ) ::  &
-         & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-         & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-         & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-         & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+         & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
          & bc_klo_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
          & bc_khi_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
@@ -97,10 +98,13 @@ contains
 
       idx = one / dx(1)
       idy = one / dx(2)
-      idz = one / dx(3)
+      idz = zero
+      if (kz > 0) idz = one / dx(3)
 
       vlo = lo - ng
       vhi = hi + ng
+      vlo(3) = lo(3) - ng*kz
+      vhi(3) = hi(3) + ng*kz
       call amrex_allocate( vel, vlo(1), vhi(1)  , vlo(2), vhi(2)  , vlo(3), vhi(3)  , 1, 3)
 
       ! Put values into ghost cells so we can easy take derivatives
@@ -117,8 +121,8 @@ contains
                eta_e = half * (eta(i,j,k) + eta(i+1,j,k))
                eta_s = half * (eta(i,j,k) + eta(i,j-1,k))
                eta_n = half * (eta(i,j,k) + eta(i,j+1,k))
-               eta_b = half * (eta(i,j,k) + eta(i,j,k-1))
-               eta_t = half * (eta(i,j,k) + eta(i,j,k+1))
+               eta_b = half * (eta(i,j,k) + eta(i,j,k-kz))
+               eta_t = half * (eta(i,j,k) + eta(i,j,k+kz))
 
                !*************************************
                !         div(tau)_x
@@ -141,14 +145,14 @@ contains
                txy_s = eta_s * dv * idx
 
                ! Z top
-               dw = (  vel(i+1,j,k,3) + vel(i+1,j,k+1,3) + vel(i  ,j,k,3) + vel(i  ,j,k+1,3) &
-                    &- vel(i  ,j,k,3) - vel(i  ,j,k+1,3) - vel(i-1,j,k,3) - vel(i-1,j,k+1,3) ) * q4
+               dw = (  vel(i+1,j,k,3) + vel(i+1,j,k+kz,3) + vel(i  ,j,k,3) + vel(i  ,j,k+kz,3) &
+                    &- vel(i  ,j,k,3) - vel(i  ,j,k+kz,3) - vel(i-1,j,k,3) - vel(i-1,j,k+kz,3) ) * q4
 
                txz_t = eta_t * dw * idx
 
                ! Z bottom
-               dw = (  vel(i+1,j,k-1,3) + vel(i+1,j,k,3) + vel(i  ,j,k-1,3) + vel(i  ,j,k,3) &
-                    &- vel(i  ,j,k-1,3) - vel(i  ,j,k,3) - vel(i-1,j,k-1,3) - vel(i-1,j,k,3) ) * q4
+               dw = (  vel(i+1,j,k-kz,3) + vel(i+1,j,k,3) + vel(i  ,j,k-kz,3) + vel(i  ,j,k,3) &
+                    &- vel(i  ,j,k-kz,3) - vel(i  ,j,k,3) - vel(i-1,j,k-kz,3) - vel(i-1,j,k,3) ) * q4
 
                txz_b = eta_b * dw * idx
 
@@ -177,14 +181,14 @@ contains
                tyy_s = eta_s * ( vel(i,j  ,k,2) - vel(i,j-1,k,2) ) * idy
 
                ! Z top
-               dw = (   vel(i,j  ,k+1,3) + vel(i,j+1,k+1,3) + vel(i,j  ,k,3) + vel(i,j+1,k,3) &
-                    & - vel(i,j-1,k+1,3) - vel(i,j  ,k+1,3) - vel(i,j-1,k,3) - vel(i,j  ,k,3) ) * q4
+               dw = (   vel(i,j  ,k+kz,3) + vel(i,j+1,k+kz,3) + vel(i,j  ,k,3) + vel(i,j+1,k,3) &
+                    & - vel(i,j-1,k+kz,3) - vel(i,j  ,k+kz,3) - vel(i,j-1,k,3) - vel(i,j  ,k,3) ) * q4
 
                tyz_t = eta_t * dw * idy
 
                ! Z bottom
-               dw = (   vel(i,j  ,k,3) + vel(i,j+1,k,3) + vel(i,j  ,k-1,3) + vel(i,j+1,k-1,3) &
-                    & - vel(i,j-1,k,3) - vel(i,j  ,k,3) - vel(i,j-1,k-1,3) - vel(i,j  ,k-1,3) ) * q4
+               dw = (   vel(i,j  ,k,3) + vel(i,j+1,k,3) + vel(i,j  ,k-kz,3) + vel(i,j+1,k-kz,3) &
+                    & - vel(i,j-1,k,3) - vel(i,j  ,k,3) - vel(i,j-1,k-kz,3) - vel(i,j  ,k-kz,3) ) * q4
 
                tyz_b = eta_b *  dw * idy
 
@@ -198,32 +202,32 @@ contains
                !*************************************
 
                ! X east
-               du = (   vel(i+1,j,k  ,1) + vel(i+1,j,k+1,1) + vel(i,j,k  ,1) + vel(i,j,k+1,1) &
-                    & - vel(i+1,j,k-1,1) - vel(i+1,j,k  ,1) - vel(i,j,k-1,1) - vel(i,j,k  ,1) ) * q4
+               du = (   vel(i+1,j,k  ,1) + vel(i+1,j,k+kz,1) + vel(i,j,k  ,1) + vel(i,j,k+kz,1) &
+                    & - vel(i+1,j,k-kz,1) - vel(i+1,j,k  ,1) - vel(i,j,k-kz,1) - vel(i,j,k  ,1) ) * q4
 
                txz_e = eta_e * du * idz
 
                ! X west
-               du = (   vel(i,j,k  ,1) + vel(i,j,k+1,1) + vel(i-1,j,k  ,1) + vel(i-1,j,k+1,1) &
-                    & - vel(i,j,k-1,1) - vel(i,j,k  ,1) - vel(i-1,j,k-1,1) - vel(i-1,j,k  ,1) ) * q4
+               du = (   vel(i,j,k  ,1) + vel(i,j,k+kz,1) + vel(i-1,j,k  ,1) + vel(i-1,j,k+kz,1) &
+                    & - vel(i,j,k-kz,1) - vel(i,j,k  ,1) - vel(i-1,j,k-kz,1) - vel(i-1,j,k  ,1) ) * q4
 
                txz_w = eta_w * du * idz
 
                ! Y north
-               dv = (   vel(i,j,k+1,2) + vel(i,j+1,k+1,2) + vel(i,j,k  ,2) + vel(i,j+1,k  ,2) &
-                    & - vel(i,j,k  ,2) - vel(i,j+1,k  ,2) - vel(i,j,k-1,2) - vel(i,j+1,k-1,2) ) * q4
+               dv = (   vel(i,j,k+kz,2) + vel(i,j+1,k+kz,2) + vel(i,j,k  ,2) + vel(i,j+1,k  ,2) &
+                    & - vel(i,j,k  ,2) - vel(i,j+1,k  ,2) - vel(i,j,k-kz,2) - vel(i,j+1,k-kz,2) ) * q4
 
                tyz_n = eta_n * dv * idz
 
                ! Y south
-               dv = (   vel(i,j-1,k+1,2) + vel(i,j,k+1,2) + vel(i,j-1,k  ,2) + vel(i,j,k  ,2) &
-                    & - vel(i,j-1,k  ,2) - vel(i,j,k  ,2) - vel(i,j-1,k-1,2) - vel(i,j,k-1,2) ) * q4
+               dv = (   vel(i,j-1,k+kz,2) + vel(i,j,k+kz,2) + vel(i,j-1,k  ,2) + vel(i,j,k  ,2) &
+                    & - vel(i,j-1,k  ,2) - vel(i,j,k  ,2) - vel(i,j-1,k-kz,2) - vel(i,j,k-kz,2) ) * q4
 
                tyz_s = eta_s * dv * idz
 
                ! Z
-               tzz_t = eta_t * ( vel(i,j,k+1,3) - vel(i,j,k  ,3) ) * idz
-               tzz_b = eta_b * ( vel(i,j,k  ,3) - vel(i,j,k-1,3) ) * idz
+               tzz_t = eta_t * ( vel(i,j,k+kz,3) - vel(i,j,k  ,3) ) * idz
+               tzz_b = eta_b * ( vel(i,j,k  ,3) - vel(i,j,k-kz,3) ) * idz
 
                ! Assemble
                divtau(i,j,k,3) = ( txz_e - txz_w ) * idx  + &
@@ -243,6 +247,170 @@ contains
 
    end subroutine compute_divtau
 
+   !
+   ! Axisymmetric version of compute_divtau, in the 2D build with x = r, y = z and
+   ! the third component the swirl u_theta. With the full stress tensor
+   !
+   !  div(tau)_r     = 1/r d(r trr)/dr + d(trz)/dz - ttt / r
+   !  div(tau)_z     = 1/r d(r trz)/dr + d(tzz)/dz
+   !  div(tau)_theta = 1/r^2 d(r^2 trt)/dr + d(ttz)/dz
+   !
+   !  trr = 2 eta du_r/dr    trz = eta ( du_r/dz + du_z/dr )    ttt = 2 eta u_r / r
+   !  tzz = 2 eta du_z/dz    trt = eta r d(u_theta / r)/dr      ttz = eta du_theta/dz
+   !
+   ! the implicit solve takes the r-weighted Laplacian of each component, plus the
+   ! hoop term - eta u / r^2 of u_r and u_theta. What is left, computed here, is
+   !
+   !  1/r d(r eta du_r/dr)/dr + d(eta du_z/dr)/dz - eta u_r / r^2
+   !  1/r d(r eta du_r/dz)/dr + d(eta du_z/dz)/dz
+   !  - u_theta / r d(eta)/dr
+   !
+   subroutine compute_divtau_rz(lo, hi,                   &
+                                divtau, dlo, dhi,         &
+                                vel_in, vinlo, vinhi,     &
+                                eta, ro, slo, shi,        &
+                                domlo, domhi,             &
+                                bc_ilo_type, bc_ihi_type, &
+                                bc_jlo_type, bc_jhi_type, &
+                                bc_klo_type, bc_khi_type, &
+                                dx, ng) bind(C)
+
+      ! Loops bounds (cell-centered)
+      integer(c_int),  intent(in   ) :: lo(3), hi(3)
+
+      ! Number of ghost cells
+      integer(c_int),  intent(in   ) :: ng
+
+      ! Array bounds
+      integer(c_int),  intent(in   ) :: vinlo(3), vinhi(3)
+      integer(c_int),  intent(in   ) ::   slo(3),   shi(3)
+      integer(c_int),  intent(in   ) ::   dlo(3),   dhi(3)
+      integer(c_int),  intent(in   ) :: domlo(3), domhi(3)
+
+      ! Grid
+      real(rt),        intent(in   ) :: dx(3)
+
+      ! Arrays
+      real(rt),        intent(in   ) :: &
+         & vel_in(vinlo(1):vinhi(1),vinlo(2):vinhi(2),vinlo(3):vinhi(3),3), &
+         &     ro(  slo(1):  shi(1),  slo(2):  shi(2),  slo(3):  shi(3)  ), &
+         &    eta(  slo(1):  shi(1),  slo(2):  shi(2),  slo(3):  shi(3)  )
+
+      real(rt),        intent(inout) ::                        &
+         & divtau(  dlo(1):  dhi(1),  dlo(2):  dhi(2),  dlo(3):  dhi(3),3)
+
+      ! BC types
+      integer(c_int), intent(in   ) ::  &
+         & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+         & bc_klo_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
+         & bc_khi_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
+
+      ! Temporary array just to handle bc's
+      integer(c_int) :: vlo(3), vhi(3)
+      real(rt), dimension(:,:,:,:), pointer, contiguous :: vel
+
+      integer(c_int)                 :: i, j, k
+      real(rt)                       :: idx, idy
+      real(rt)                       :: du, dv
+      real(rt)                       :: r_c, r_w, r_e
+
+      real(rt)  :: eta_e, eta_w, eta_n, eta_s
+      real(rt)  :: trr_e, trr_w, tzr_n, tzr_s
+      real(rt)  :: trz_e, trz_w, tzz_n, tzz_s
+
+      idx = one / dx(1)
+      idy = one / dx(2)
+
+      vlo = lo - ng
+      vhi = hi + ng
+      vlo(3) = lo(3) - ng*kz
+      vhi(3) = hi(3) + ng*kz
+      call amrex_allocate( vel, vlo(1), vhi(1)  , vlo(2), vhi(2)  , vlo(3), vhi(3)  , 1, 3)
+
+      ! Put values into ghost cells so we can easy take derivatives
+      call fill_vel_diff_bc(vel_in, vinlo, vinhi, vel, lo, hi, domlo, domhi, ng, &
+                            bc_ilo_type, bc_ihi_type, &
+                            bc_jlo_type, bc_jhi_type, &
+                            bc_klo_type, bc_khi_type)
+
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+
+               r_w = r_lo + i * dx(1)
+               r_e = r_w + dx(1)
+               r_c = r_w + half * dx(1)
+
+               eta_w = half * (eta(i,j,k) + eta(i-1,j,k))
+               eta_e = half * (eta(i,j,k) + eta(i+1,j,k))
+               eta_s = half * (eta(i,j,k) + eta(i,j-1,k))
+               eta_n = half * (eta(i,j,k) + eta(i,j+1,k))
+
+               !*************************************
+               !         div(tau)_r
+               !*************************************
+
+               trr_e = r_e * eta_e * ( vel(i+1,j,k,1) - vel(i  ,j,k,1) ) * idx
+               trr_w = r_w * eta_w * ( vel(i  ,j,k,1) - vel(i-1,j,k,1) ) * idx
+
+               ! du_z/dr on the north and south faces
+               dv = (  vel(i+1,j,k,2) + vel(i+1,j+1,k,2) + vel(i  ,j,k,2) + vel(i  ,j+1,k,2) &
+                    &- vel(i  ,j,k,2) - vel(i  ,j+1,k,2) - vel(i-1,j,k,2) - vel(i-1,j+1,k,2) ) * q4
+
+               tzr_n = eta_n * dv * idx
+
+               dv = (  vel(i+1,j-1,k,2) + vel(i+1,j,k,2) + vel(i  ,j-1,k,2) + vel(i  ,j,k,2) &
+                    &- vel(i  ,j-1,k,2) - vel(i  ,j,k,2) - vel(i-1,j-1,k,2) - vel(i-1,j,k,2) ) * q4
+
+               tzr_s = eta_s * dv * idx
+
+               divtau(i,j,k,1) = ( trr_e - trr_w ) * idx / r_c + &
+                    &            ( tzr_n - tzr_s ) * idy      - &
+                    &            eta(i,j,k) * vel(i,j,k,1) / r_c**2
+
+               !*************************************
+               !         div(tau)_z
+               !*************************************
+
+               ! du_r/dz on the east and west faces
+               du = (   vel(i+1,j  ,k,1) + vel(i+1,j+1,k,1) + vel(i,j  ,k,1) + vel(i,j+1,k,1) &
+                    & - vel(i+1,j-1,k,1) - vel(i+1,j  ,k,1) - vel(i,j-1,k,1) - vel(i,j  ,k,1) ) * q4
+
+               trz_e = r_e * eta_e * du * idy
+
+               du = (   vel(i,j  ,k,1) + vel(i,j+1,k,1) + vel(i-1,j  ,k,1) + vel(i-1,j+1,k,1) &
+                    & - vel(i,j-1,k,1) - vel(i,j  ,k,1) - vel(i-1,j-1,k,1) - vel(i-1,j  ,k,1) ) * q4
+
+               trz_w = r_w * eta_w * du * idy
+
+               tzz_n = eta_n * ( vel(i,j+1,k,2) - vel(i,j  ,k,2) ) * idy
+               tzz_s = eta_s * ( vel(i,j  ,k,2) - vel(i,j-1,k,2) ) * idy
+
+               divtau(i,j,k,2) = ( trz_e - trz_w ) * idx / r_c + &
+                    &            ( tzz_n - tzz_s ) * idy
+
+               !*************************************
+               !         div(tau)_theta
+               !*************************************
+
+               divtau(i,j,k,3) = - vel(i,j,k,3) / r_c * ( eta_e - eta_w ) * idx
+
+               !*************************************
+               !         div(tau)/ro
+               !*************************************
+               divtau(i,j,k,:) = divtau(i,j,k,:) / ro(i,j,k)
+
+            end do
+         end do
+      end do
+
+      call amrex_deallocate(vel)
+
+   end subroutine compute_divtau_rz
+
    !
    ! Set the boundary condition for diffusion solve
    !
@@ -251,7 +419,7 @@ contains
    ! the user-provided BCs are uniform, and then return a single BC type for
    ! each domain wall.
    !
-   subroutine set_diff_bc ( bc_lo, bc_hi, domlo, domhi, ng, bct_ilo, bct_ihi, &
+   subroutine set_diff_bc ( bc_lo, bc_hi, sym_lo, sym_hi, domlo, domhi, ng, bct_ilo, bct_ihi, &
         & bct_jlo, bct_jhi, bct_klo, bct_khi)  bind(C)
 
       use amrex_lo_bctypes_module
@@ -260,15 +428,19 @@ contains
       ! Array of global BC types
       integer(c_int), intent(  out) :: bc_lo(3), bc_hi(3)
 
+      ! Flags for the symmetry planes: there the BC above (Neumann) only holds for
+      ! the tangential velocities, the normal velocity is Dirichlet (zero)
+      integer(c_int), intent(  out) :: sym_lo(3), sym_hi(3)
+
       ! Domain bounds
       integer(c_int), intent(in   ) :: domlo(3), domhi(3), ng
 
       ! Arrays of point-by-point BC types
       integer(c_int), intent(in   )  ::                                 &
-           & bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+           & bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
            & bct_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
            & bct_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
@@ -281,6 +453,9 @@ contains
       bc_lo    = amrex_lo_dirichlet
       bc_hi    = amrex_lo_dirichlet
 
+      sym_lo   = 0
+      sym_hi   = 0
+
       !
       ! BC -- X direction
       !
@@ -289,17 +464,20 @@ contains
          bc_hi(1) = amrex_lo_periodic
       else
 
-         ! X at domlo(1)
+         ! X at domlo(1): there is no flux through the axis of an RZ domain
          bc_face = get_bc_face(bct_ilo, ng)
-         if ( (bc_face == pinf_) .or. (bc_face == pout_) ) then
+         if ( (bc_face == pinf_) .or. (bc_face == pout_) .or. (bc_face == axis_) .or. &
+              (bc_face == sym_) ) then
             bc_lo(1) = amrex_lo_neumann
          end if
+         if (bc_face == sym_) sym_lo(1) = 1
 
          ! X at domhi(1)
          bc_face = get_bc_face(bct_ihi, ng)
-         if ( (bc_face == pinf_) .or. (bc_face == pout_) ) then
+         if ( (bc_face == pinf_) .or. (bc_face == pout_) .or. (bc_face == sym_) ) then
             bc_hi(1) = amrex_lo_neumann
          end if
+         if (bc_face == sym_) sym_hi(1) = 1
 
       end if
 
@@ -313,15 +491,17 @@ contains
 
          ! Y at domlo(2)
          bc_face = get_bc_face(bct_jlo, ng)
-         if ( (bc_face == pinf_) .or. (bc_face == pout_) ) then
+         if ( (bc_face == pinf_) .or. (bc_face == pout_) .or. (bc_face == sym_) ) then
             bc_lo(2) = amrex_lo_neumann
          end if
+         if (bc_face == sym_) sym_lo(2) = 1
 
          ! Y at domhi(2)
          bc_face = get_bc_face(bct_jhi, ng)
-         if ( (bc_face == pinf_) .or. (bc_face == pout_) ) then
+         if ( (bc_face == pinf_) .or. (bc_face == pout_) .or. (bc_face == sym_) ) then
             bc_hi(2) = amrex_lo_neumann
          end if
+         if (bc_face == sym_) sym_hi(2) = 1
 
       end if
 
@@ -335,15 +515,17 @@ contains
 
          ! Z at domlo(3)
          bc_face = get_bc_face(bct_klo, ng)
-         if ( (bc_face == pinf_) .or. (bc_face == pout_) ) then
+         if ( (bc_face == pinf_) .or. (bc_face == pout_) .or. (bc_face == sym_) ) then
             bc_lo(3) = amrex_lo_neumann
          end if
+         if (bc_face == sym_) sym_lo(3) = 1
 
          ! Z at domhi(3)
          bc_face = get_bc_face(bct_khi, ng)
-         if ( (bc_face == pinf_) .or. (bc_face == pout_) ) then
+         if ( (bc_face == pinf_) .or. (bc_face == pout_) .or. (bc_face == sym_) ) then
             bc_hi(3) = amrex_lo_neumann
          end if
+         if (bc_face == sym_) sym_hi(3) = 1
 
       end if
 
@@ -385,27 +567,27 @@ contains
                                bc_jlo_type, bc_jhi_type, &
                                bc_klo_type, bc_khi_type)
 
-      use bc, only: minf_, nsw_
+      use bc, only: minf_, nsw_, sym_
 
       integer,  intent(in   ) ::   vinlo(3),   vinhi(3)
       integer,  intent(in   ) ::    lo(3),    hi(3)
       integer,  intent(in   ) :: domlo(3), domhi(3)
 
       real(rt), intent(in   ) :: vel_in(vinlo(1):vinhi(1),vinlo(2):vinhi(2),vinlo(3):vinhi(3),3)
-      real(rt), intent(  out) ::    vel(lo(1)-ng:hi(1)+ng,lo(2)-ng:hi(2)+ng,lo(3)-ng:hi(3)+ng,3)
+      real(rt), intent(  out) ::    vel(lo(1)-ng:hi(1)+ng,lo(2)-ng:hi(2)+ng,lo(3)-ng*kz:hi(3)+ng*kz,3)
 
       ! BC types
       integer(c_int), intent(in   ) :: ng,  &
-           & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+           & bc_ilo_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_ihi_type(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jlo_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jhi_type(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
            & bc_klo_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
            & bc_khi_type(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
       integer :: i,j,k,n
 
-      do k = lo(3)-ng, hi(3)+ng
+      do k = lo(3)-ng*kz, hi(3)+ng*kz
          do j = lo(2)-ng, hi(2)+ng
             do i = lo(1)-ng, hi(1)+ng
                vel(i,j,k,:) = vel_in(i,j,k,:)
@@ -420,7 +602,8 @@ contains
                do j = lo(2), hi(2)
 
                   if ( ( bc_ilo_type(j,k,1) == MINF_) .or. &
-                       ( bc_ilo_type(j,k,1) == NSW_ ) ) then
+                       ( bc_ilo_type(j,k,1) == NSW_ ) .or. &
+                       ( bc_ilo_type(j,k,1) == SYM_ ) ) then
 
                      vel(:lo(1)-1,j,k,n) = 2.d0*vel_in(lo(1)-1,j,k,n) - vel_in(lo(1),j,k,n)
 
@@ -439,7 +622,8 @@ contains
                do j = lo(2), hi(2)
 
                   if ( ( bc_ihi_type(j,k,1) == MINF_) .or. &
-                       ( bc_ihi_type(j,k,1) == NSW_ ) ) then
+                       ( bc_ihi_type(j,k,1) == NSW_ ) .or. &
+                       ( bc_ihi_type(j,k,1) == SYM_ ) ) then
 
                      vel(hi(1)+1:,j,k,n) = 2.d0*vel_in(hi(1)+1,j,k,n) - vel_in(hi(1),j,k,n)
 
@@ -458,7 +642,8 @@ contains
                do i = lo(1)-1, hi(1)+1
 
                   if ( ( bc_jlo_type(i,k,1) == MINF_) .or. &
-                       ( bc_jlo_type(i,k,1) == NSW_ ) ) then
+                       ( bc_jlo_type(i,k,1) == NSW_ ) .or. &
+                       ( bc_jlo_type(i,k,1) == SYM_ ) ) then
 
                      vel(i,:lo(2)-1,k,n) = 2.d0*vel_in(i,lo(2)-1,k,n) - vel_in(i,lo(2),k,n)
 
@@ -477,7 +662,8 @@ contains
                do i = lo(1)-1, hi(1)+1
 
                   if ( ( bc_jhi_type(i,k,1) == MINF_) .or. &
-                       ( bc_jhi_type(i,k,1) == NSW_ ) ) then
+                       ( bc_jhi_type(i,k,1) == NSW_ ) .or. &
+                       ( bc_jhi_type(i,k,1) == SYM_ ) ) then
 
                      vel(i,hi(2)+1:,k,n) = 2.d0*vel_in(i,hi(2)+1,k,n) - vel_in(i,hi(2),k,n)
 
@@ -487,7 +673,7 @@ contains
          end do
       end if
 
-      if ( lo(3) == domlo(3) ) then
+      if ( kz > 0 .and. lo(3) == domlo(3) ) then
 
          k = lo(3)
 
@@ -496,7 +682,8 @@ contains
                do i = lo(1)-1, hi(1)+1
 
                   if ( ( bc_klo_type(i,j,1) == MINF_) .or. &
-                       ( bc_klo_type(i,j,1) == NSW_ ) ) then
+                       ( bc_klo_type(i,j,1) == NSW_ ) .or. &
+                       ( bc_klo_type(i,j,1) == SYM_ ) ) then
 
                      vel(i,j,:lo(3)-1,n) = 2.d0*vel_in(i,j,lo(3)-1,n) - vel_in(i,j,lo(3),n)
 
@@ -506,7 +693,7 @@ contains
          end do
       end if
 
-      if ( hi(3) == domhi(3) ) then
+      if ( kz > 0 .and. hi(3) == domhi(3) ) then
 
          k = hi(3)
 
@@ -515,7 +702,8 @@ contains
                do i = lo(1)-1, hi(1)+1
 
                   if ( ( bc_khi_type(i,j,1) == MINF_) .or. &
-                       ( bc_khi_type(i,j,1) == NSW_ ) ) then
+                       ( bc_khi_type(i,j,1) == NSW_ ) .or. &
+                       ( bc_khi_type(i,j,1) == SYM_ ) ) then
 
                      vel(i,j,hi(3)+1:,n) = 2.d0*vel_in(i,j,hi(3)+1,n) - vel_in(i,j,hi(3),n)
 
@@ -531,11 +719,12 @@ contains
          i = lo(1)
 
          do n = 1, 3
-            do k = lo(3)-1, hi(3)+1
+            do k = lo(3)-kz, hi(3)+kz
                do j = lo(2)-1, hi(2)+1
 
                   if ( ( bc_ilo_type(j,k,1) == MINF_) .or. &
-                       ( bc_ilo_type(j,k,1) == NSW_ ) ) then
+                       ( bc_ilo_type(j,k,1) == NSW_ ) .or. &
+                       ( bc_ilo_type(j,k,1) == SYM_ ) ) then
 
                      vel(lo(1)-1,j,k,n) = 2.d0*vel_in(lo(1)-1,j,k,n) - vel_in(lo(1),j,k,n)
 
@@ -551,11 +740,12 @@ contains
          i = hi(1)
 
          do n = 1, 3
-            do k = lo(3)-1, hi(3)+1
+            do k = lo(3)-kz, hi(3)+kz
                do j = lo(2)-1, hi(2)+1
 
                   if ( ( bc_ihi_type(j,k,1) == MINF_) .or. &
-                       ( bc_ihi_type(j,k,1) == NSW_ ) ) then
+                       ( bc_ihi_type(j,k,1) == NSW_ ) .or. &
+                       ( bc_ihi_type(j,k,1) == SYM_ ) ) then
 
                      vel(hi(1)+1,j,k,n) = 2.d0*vel_in(hi(1)+1,j,k,n) - vel_in(hi(1),j,k,n)
 
@@ -571,11 +761,12 @@ contains
          j = lo(2)
 
          do n = 1, 3
-            do k = lo(3)-1, hi(3)+1
+            do k = lo(3)-kz, hi(3)+kz
                do i = lo(1)-1, hi(1)+1
 
                   if ( ( bc_jlo_type(i,k,1) == MINF_) .or. &
-                       ( bc_jlo_type(i,k,1) == NSW_ ) ) then
+                       ( bc_jlo_type(i,k,1) == NSW_ ) .or. &
+                       ( bc_jlo_type(i,k,1) == SYM_ ) ) then
 
                      vel(i,lo(2)-1,k,n) = 2.d0*vel_in(i,lo(2)-1,k,n) - vel_in(i,lo(2),k,n)
 
@@ -591,11 +782,12 @@ contains
          j = hi(2)
 
          do n = 1, 3
-            do k = lo(3)-1, hi(3)+1
+            do k = lo(3)-kz, hi(3)+kz
                do i = lo(1)-1, hi(1)+1
 
                   if ( ( bc_jhi_type(i,k,1) == MINF_) .or. &
-                       ( bc_jhi_type(i,k,1) == NSW_ ) ) then
+                       ( bc_jhi_type(i,k,1) == NSW_ ) .or. &
+                       ( bc_jhi_type(i,k,1) == SYM_ ) ) then
 
                      vel(i,hi(2)+1,k,n) = 2.d0*vel_in(i,hi(2)+1,k,n) - vel_in(i,hi(2),k,n)
 
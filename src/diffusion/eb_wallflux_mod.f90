@@ -15,7 +15,8 @@ module eb_wallflux_mod
 contains
 
    !
-   ! We use no-slip boundary for velocities.
+   ! We use no-slip boundary for velocities: the fluid moves with the wall,
+   ! at velocity ubw.
    !
    subroutine compute_diff_wallflux(divw, dx, i, j, k, &
                                     vel,    vlo,  vhi, &
@@ -25,7 +26,7 @@ contains
                                     apy,   aylo, ayhi, &
                                     apz,   azlo, azhi, &
                                     vfrac, vflo, vfhi, & 
-                                    cyl_speed)
+                                    ubw)
 
       ! Wall divergence operator
       real(rt),       intent(  out) :: divw(3)
@@ -56,8 +57,8 @@ contains
 
       integer(c_int), intent(in   ) :: flag(flo(1):fhi(1),flo(2):fhi(2),flo(3):fhi(3))
 
-      ! Rotating cylinder 
-      real(rt),       intent(in   ) :: cyl_speed
+      ! Velocity of the wall
+      real(rt),       intent(in   ) :: ubw(3)
 
       ! Local variable
       real(rt)   :: dxinv(3), idx, idy, idz
@@ -67,7 +68,7 @@ contains
       real(rt)   :: ux, uy, uz, vx, vy, vz, wx, wy, wz
       real(rt)   :: tauxx, tauxy, tauxz, tauyx, tauyy, tauyz, tauzx, tauzy, tauzz
       real(rt)   :: strain, visc
-      real(rt)   :: ub, vb, wb, theta
+      real(rt)   :: ub, vb, wb
 
       divw  = zero
       dxinv = one / dx
@@ -92,15 +93,9 @@ contains
       anrmz = -dapz * apnorminv
 
       ! Value on wall 
-      ub = 0.d0
-      vb = 0.d0
-      wb = 0.d0
-      theta = 0.d0
-      if (cyl_speed > 0.d0) then
-         theta = atan2(-anrmy, -anrmx)
-         ub =   cyl_speed * sin(theta)
-         vb = - cyl_speed * cos(theta)
-      endif
+      ub = ubw(1)
+      vb = ubw(2)
+      wb = ubw(3)
 
 
       call compute_dphidn_3d(dudn, dxinv, i, j, k, &
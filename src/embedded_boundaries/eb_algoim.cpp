@@ -0,0 +1,400 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+#include <algoim_quad.hpp>
+
+#include <eb_data.H>
+#include <incflo.H>
+
+#include <cmath>
+#include <functional>
+
+#if (AMREX_SPACEDIM == 3)
+
+/********************************************************************************
+ *                                                                              *
+ * High-order cut-cell moments from Algoim quadrature on the analytic level     *
+ * set of the geometry (R. Saye, SIAM J. Sci. Comput. 37, 2015).                *
+ *                                                                              *
+ * EB2 computes moments from a piecewise-planar reconstruction of the EB in    *
+ * each cell. For the analytic shapes below, this pass recomputes every moment  *
+ * of every cut cell by integrating over the curved boundary: the volume and    *
+ * area fractions, the cell, face and boundary centroids, and the boundary      *
+ * area and (area-averaged) normal. They replace the EB2 moments in the EB      *
+ * data of every level of the index space, before the EB factories are made,   *
+ * so the incflo levels and the coarse multigrid levels all see the same set.   *
+ * Cell flags and connectivity are left as EB2 built them.                      *
+ *                                                                              *
+ * Like the EB2 moments, they are computed in index space, where the cells are  *
+ * unit cubes: the level set is mapped over from physical space.                *
+ *                                                                              *
+ * Algoim needs the level set and its gradient to be templated on the scalar    *
+ * type (for its interval arithmetic), hence the separate functors.             *
+ *                                                                              *
+ ********************************************************************************/
+
+namespace
+{
+    // Sphere with the sign convention of EB2::SphereIF (negative in the fluid)
+    struct AlgoimSphere
+    {
+        Real radius;
+        RealArray center;
+        Real sign;
+
+        template <typename T>
+        T operator()(const blitz::TinyVector<T, 3>& x) const
+        {
+            return sign * ((x(0) - center[0]) * (x(0) - center[0])
+                         + (x(1) - center[1]) * (x(1) - center[1])
+                         + (x(2) - center[2]) * (x(2) - center[2]) - radius * radius);
+        }
+
+        template <typename T>
+        blitz::TinyVector<T, 3> grad(const blitz::TinyVector<T, 3>& x) const
+        {
+            return blitz::TinyVector<T, 3>(2.0 * sign * (x(0) - center[0]),
+                                           2.0 * sign * (x(1) - center[1]),
+                                           2.0 * sign * (x(2) - center[2]));
+        }
+    };
+
+    // Cylinder with the sign convention of EB2::CylinderIF (negative in the fluid)
+    struct AlgoimCylinder
+    {
+        Real radius;
+        int direction;
+        RealArray center;
+        Real sign;
+
+        template <typename T>
+        T operator()(const blitz::TinyVector<T, 3>& x) const
+        {
+            T r2 = - radius * radius;
+            for(int d = 0; d < 3; d++)
+                if(d != direction)
+                    r2 += (x(d) - center[d]) * (x(d) - center[d]);
+            return sign * r2;
+        }
+
+        template <typename T>
+        blitz::TinyVector<T, 3> grad(const blitz::TinyVector<T, 3>& x) const
+        {
+            blitz::TinyVector<T, 3> g;
+            for(int d = 0; d < 3; d++)
+                g(d) = (d == direction) ? T(0.0) : T(2.0 * sign * (x(d) - center[d]));
+            return g;
+        }
+    };
+
+    // Level set phi of physical space, in the index space of geom
+    template <class Phi>
+    struct IndexSpacePhi
+    {
+        const Phi& phi;
+        RealArray problo;
+        RealArray dx;
+
+        template <typename T>
+        blitz::TinyVector<T, 3> toPhysical(const blitz::TinyVector<T, 3>& xi) const
+        {
+            return blitz::TinyVector<T, 3>(problo[0] + xi(0) * dx[0],
+                                           problo[1] + xi(1) * dx[1],
+                                           problo[2] + xi(2) * dx[2]);
+        }
+
+        template <typename T>
+        T operator()(const blitz::TinyVector<T, 3>& xi) const
+        {
+            return phi(toPhysical(xi));
+        }
+
+        template <typename T>
+        blitz::TinyVector<T, 3> grad(const blitz::TinyVector<T, 3>& xi) const
+        {
+            blitz::TinyVector<T, 3> g = phi.grad(toPhysical(xi));
+            return blitz::TinyVector<T, 3>(g(0) * dx[0], g(1) * dx[1], g(2) * dx[2]);
+        }
+    };
+
+    template <class Phi>
+    void compute_moments(const Phi& phi, EBDataLevel& level, const Geometry& geom, int order)
+    {
+        const IndexSpacePhi<Phi> phi_is{phi, {geom.ProbLo(0), geom.ProbLo(1), geom.ProbLo(2)},
+                                        {geom.CellSize(0), geom.CellSize(1), geom.CellSize(2)}};
+
+        const FabArray<EBCellFlagFab>& flags = level.cellFlag();
+        MultiFab& volfrac = level.volFrac();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for(MFIter mfi(volfrac); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            const EBCellFlagFab& flag_fab = flags[mfi];
+
+            // A face that is cut lies between two cells that are neither regular nor covered
+            if(flag_fab.getType() == FabType::regular || flag_fab.getType() == FabType::covered)
+                continue;
+
+            const auto& flag_arr = flag_fab.array();
+            const auto& vf_arr = volfrac.array(mfi);
+            const auto& cent_arr = level.centroid().array(mfi);
+            const auto& barea_arr = level.bndryArea().array(mfi);
+            const auto& bcent_arr = level.bndryCent().array(mfi);
+            const auto& bnorm_arr = level.bndryNorm().array(mfi);
+
+            for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
+            for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
+            for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
+            {
+                if(!flag_arr(i,j,k).isSingleValued())
+                    continue;
+
+                const int iv[3] = {i, j, k};
+                blitz::TinyVector<Real, 3> xlo, xhi;
+                for(int d = 0; d < 3; d++)
+                {
+                    xlo(d) = iv[d];
+                    xhi(d) = iv[d] + 1.0;
+                }
+                Algoim::BoundingBox<Real, 3> cell(xlo, xhi);
+
+                auto qv = Algoim::quadGen<3>(phi_is, cell, -1, -1, order);
+                auto qs = Algoim::quadGen<3>(phi_is, cell, 3, -1, order);
+                Real vol = qv.sumWeights();
+                Real area = qs.sumWeights();
+
+                // Area-averaged normal, out of the fluid like the EB2 one
+                Real normal[3];
+                Real norm2 = 0.0;
+                for(int d = 0; d < 3; d++)
+                {
+                    normal[d] = qs([&](const blitz::TinyVector<Real, 3>& x)
+                    {
+                        blitz::TinyVector<Real, 3> g = phi_is.grad(x);
+                        return g(d) / std::sqrt(g(0) * g(0) + g(1) * g(1) + g(2) * g(2));
+                    });
+                    norm2 += normal[d] * normal[d];
+                }
+
+                // Degenerate (tangent) cuts keep the EB2 moments
+                if(vol <= 0.0 || vol >= 1.0 || area <= 0.0 || norm2 <= 0.0)
+                    continue;
+
+                vf_arr(i,j,k) = vol;
+                barea_arr(i,j,k) = area;
+                for(int d = 0; d < 3; d++)
+                {
+                    cent_arr(i,j,k,d) =
+                        qv([&](const blitz::TinyVector<Real, 3>& x) { return x(d); }) / vol - (iv[d] + 0.5);
+                    bcent_arr(i,j,k,d) =
+                        qs([&](const blitz::TinyVector<Real, 3>& x) { return x(d); }) / area - (iv[d] + 0.5);
+                    bnorm_arr(i,j,k,d) = normal[d] / std::sqrt(norm2);
+                }
+            }
+
+            // Face moments: face (i,j,k) is the low face of cell (i,j,k)
+            for(int dir = 0; dir < 3; dir++)
+            {
+                const Box& face_bx = amrex::surroundingNodes(bx, dir);
+                const auto& af_arr = level.areaFrac(dir).array(mfi);
+                const auto& fc_arr = level.faceCent(dir).array(mfi);
+
+                for(int k = face_bx.smallEnd(2); k <= face_bx.bigEnd(2); k++)
+                for(int j = face_bx.smallEnd(1); j <= face_bx.bigEnd(1); j++)
+                for(int i = face_bx.smallEnd(0); i <= face_bx.bigEnd(0); i++)
+                {
+                    if(af_arr(i,j,k) <= 0.0 || af_arr(i,j,k) >= 1.0)
+                        continue;
+
+                    const int iv[3] = {i, j, k};
+                    blitz::TinyVector<Real, 3> xlo, xhi;
+                    for(int d = 0; d < 3; d++)
+                    {
+                        xlo(d) = iv[d];
+                        xhi(d) = iv[d] + 1.0;
+                    }
+
+                    auto qf = Algoim::quadGen<3>(phi_is, Algoim::BoundingBox<Real, 3>(xlo, xhi), dir, 0, order);
+                    Real area = qf.sumWeights();
+                    if(area <= 0.0 || area >= 1.0)
+                        continue;
+
+                    af_arr(i,j,k) = area;
+
+                    // Centroid in the two tangential directions, in increasing order
+                    int n = 0;
+                    for(int d = 0; d < 3; d++)
+                    {
+                        if(d == dir)
+                            continue;
+                        fc_arr(i,j,k,n++) =
+                            qf([&](const blitz::TinyVector<Real, 3>& x) { return x(d); }) / area - (iv[d] + 0.5);
+                    }
+                }
+            }
+        }
+    }
+
+    // Fluid volume and EB area in the domain, from the moments of level
+    void measure(EBDataLevel& level, const Geometry& geom, Real& volume, Real& area)
+    {
+        const Real* dx = geom.CellSize();
+        volume = 0.0;
+        area = 0.0;
+
+        for(MFIter mfi(level.volFrac()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox() & geom.Domain();
+            if(bx.isEmpty())
+                continue;
+
+            volume += level.volFrac()[mfi].sum(bx, 0);
+            area += level.bndryArea()[mfi].sum(bx, 0);
+        }
+        ParallelDescriptor::ReduceRealSum(volume);
+        ParallelDescriptor::ReduceRealSum(area);
+
+        // The boundary area is in units of cell faces: the check needs square cells
+        volume *= dx[0] * dx[1] * dx[2];
+        area *= dx[0] * dx[1];
+    }
+}
+
+void incflo::UpdateAlgoimMoments()
+{
+	BL_PROFILE("incflo::UpdateAlgoimMoments()");
+
+    if(eb_algoim_order <= 0)
+        return;
+
+	ParmParse pp("incflo");
+	std::string geom_type;
+	int check = 0;
+	pp.query("geometry", geom_type);
+	pp.query("eb_algoim_check", check);
+
+    EBDataIndexSpace& eb_data = EBDataIndexSpace::replaceTop(geom.back());
+
+    // Analytic fluid volume and EB area, when the body is inside the domain
+    const Geometry& fine_geom = eb_data.geometry(0);
+    const RealBox& prob = fine_geom.ProbDomain();
+    const Real domain_volume = prob.length(0) * prob.length(1) * prob.length(2);
+    bool has_exact = false;
+    Real exact_volume = 0.0;
+    Real exact_area = 0.0;
+
+    std::function<void(EBDataLevel&, const Geometry&)> update;
+
+    if(geom_type == "sphere")
+    {
+        bool inside = true;
+        Real radius = 0.0002;
+        Vector<Real> centervec(3);
+
+        ParmParse pp_sphere("sphere");
+        pp_sphere.query("internal_flow", inside);
+        pp_sphere.query("radius", radius);
+        pp_sphere.getarr("center", centervec, 0, 3);
+
+        AlgoimSphere phi{radius, {centervec[0], centervec[1], centervec[2]}, inside ? 1.0 : -1.0};
+        update = [=](EBDataLevel& level, const Geometry& g)
+        {
+            compute_moments(phi, level, g, eb_algoim_order);
+        };
+
+        has_exact = true;
+        for(int d = 0; d < 3; d++)
+            has_exact = has_exact && centervec[d] - radius > prob.lo(d) && centervec[d] + radius < prob.hi(d);
+        const Real body = 4.0 / 3.0 * M_PI * radius * radius * radius;
+        exact_volume = inside ? body : domain_volume - body;
+        exact_area = 4.0 * M_PI * radius * radius;
+    }
+    else if(geom_type == "cylinder")
+    {
+        bool inside = true;
+        Real radius = 0.0002;
+        int direction = 0;
+        Vector<Real> centervec(3);
+
+        ParmParse pp_cyl("cylinder");
+        pp_cyl.query("internal_flow", inside);
+        pp_cyl.query("radius", radius);
+        pp_cyl.query("direction", direction);
+        pp_cyl.getarr("center", centervec, 0, 3);
+
+        AlgoimCylinder phi{radius, direction, {centervec[0], centervec[1], centervec[2]},
+                           inside ? 1.0 : -1.0};
+        update = [=](EBDataLevel& level, const Geometry& g)
+        {
+            compute_moments(phi, level, g, eb_algoim_order);
+        };
+
+        // Along the axis, the cylinder spans the domain
+        has_exact = true;
+        for(int d = 0; d < 3; d++)
+            if(d != direction)
+                has_exact = has_exact && centervec[d] - radius > prob.lo(d) && centervec[d] + radius < prob.hi(d);
+        const Real length = prob.length(direction);
+        const Real body = M_PI * radius * radius * length;
+        exact_volume = inside ? body : domain_volume - body;
+        exact_area = 2.0 * M_PI * radius * length;
+    }
+    else
+    {
+        amrex::Print() << "incflo.eb_algoim_order is only supported for sphere and cylinder "
+                       << "geometries: using the EB2 moments." << std::endl;
+        return;
+    }
+
+    Real eb2_volume, eb2_area;
+    if(check)
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(has_exact,
+                                         "incflo.eb_algoim_check needs the body inside the domain");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fine_geom.CellSize(0) == fine_geom.CellSize(1) &&
+                                         fine_geom.CellSize(0) == fine_geom.CellSize(2),
+                                         "incflo.eb_algoim_check needs cubic cells");
+        measure(eb_data.level(0), fine_geom, eb2_volume, eb2_area);
+    }
+
+    // Every level of the index space, the coarse multigrid levels included
+    for(int i = 0; i < eb_data.numLevels(); i++)
+    {
+        update(eb_data.level(i), eb_data.geometry(i));
+    }
+
+    if(incflo_verbose > 0)
+        amrex::Print() << "Computed Algoim cut-cell moments (order " << eb_algoim_order
+                       << ") on " << eb_data.numLevels() << " levels" << std::endl;
+
+    if(check)
+    {
+        Real volume, area;
+        measure(eb_data.level(0), fine_geom, volume, area);
+
+        const Real eb2_volume_error = std::abs(eb2_volume - exact_volume) / exact_volume;
+        const Real eb2_area_error = std::abs(eb2_area - exact_area) / exact_area;
+        const Real volume_error = std::abs(volume - exact_volume) / exact_volume;
+        const Real area_error = std::abs(area - exact_area) / exact_area;
+
+        amrex::Print() << "Algoim check, relative errors against the analytic values:" << std::endl
+                       << "    fluid volume: EB2 " << eb2_volume_error
+                       << ", Algoim " << volume_error << std::endl
+                       << "    EB area:      EB2 " << eb2_area_error
+                       << ", Algoim " << area_error << std::endl;
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(volume_error < eb2_volume_error && area_error < eb2_area_error,
+                                         "The Algoim moments are less accurate than the EB2 ones");
+    }
+}
+
+#else
+
+// There are no cut cells in 2D
+void incflo::UpdateAlgoimMoments()
+{
+}
+#endif
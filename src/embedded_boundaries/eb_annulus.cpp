@@ -1,3 +1,4 @@
+#if (AMREX_SPACEDIM == 3)
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF_Cylinder.H>
 #include <AMReX_EB2_IF_Union.H>
@@ -5,6 +6,7 @@
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <eb_cache.H>
 #include <embedded_boundaries_F.H>
 #include <incflo.H>
 
@@ -68,14 +70,19 @@ void incflo::make_eb_annulus()
     EB2::CylinderIF inner_cyl(inner_radius, direction, inner_center, false);
     auto annulus = EB2::makeUnion(outer_cyl, inner_cyl);
 
-    // Generate GeometryShop
-	auto gshop = EB2::makeShop(annulus);
+    // Key identifying this geometry in the EB cache
+    std::ostringstream eb_key;
+    eb_key.precision(17);
+    eb_key << "annulus " << direction << ' ' << outer_radius << ' ' << inner_radius
+           << ' ' << outer_center[0] << ' ' << outer_center[1] << ' ' << outer_center[2]
+           << ' ' << inner_center[0] << ' ' << inner_center[1] << ' ' << inner_center[2];
 
     // Build index space
     int max_level_here = 0;
 	int max_coarsening_level = 100;
     EBSupport m_eb_support_level = EBSupport::full;
-	EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+	build_eb_index_space(annulus, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = annulus;
     const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
 
     // Make the EBFabFactory
@@ -93,3 +100,5 @@ void incflo::make_eb_annulus()
                                                     m_eb_support_level));
     }
 }
+
+#endif
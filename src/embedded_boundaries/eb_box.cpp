@@ -1,9 +1,11 @@
+#if (AMREX_SPACEDIM == 3)
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF_Plane.H>
 #include <AMReX_EB2_IF_Union.H>
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <eb_cache.H>
 #include <embedded_boundaries_F.H>
 #include <incflo.H>
 
@@ -102,16 +104,21 @@ void incflo::make_eb_box()
         EB2::PlaneIF plane_loz(point_loz, normal_loz);
         EB2::PlaneIF plane_hiz(point_hiz, normal_hiz);
 
-        // Generate GeometryShop
-        auto gshop = EB2::makeShop(EB2::makeUnion(plane_lox, plane_hix,
-                                                  plane_loy, plane_hiy,
-                                                  plane_loz, plane_hiz));
+        auto box_if = EB2::makeUnion(plane_lox, plane_hix,
+                                     plane_loy, plane_hiy,
+                                     plane_loz, plane_hiz);
+
+        // Key identifying this geometry in the EB cache
+        std::ostringstream eb_key;
+        eb_key.precision(17);
+        eb_key << "box " << xlo << ' ' << xhi << ' ' << ylo << ' ' << yhi << ' ' << zlo << ' ' << zhi;
 
         // Build index space
         int max_level_here = 0;
         int max_coarsening_level = 100;
         EBSupport m_eb_support_level = EBSupport::full;
-        EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+        build_eb_index_space(box_if, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+        eb_body_if = box_if;
         const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
 
         // Make the EBFabFactory
@@ -130,3 +137,5 @@ void incflo::make_eb_box()
         }
     }
 }
+
+#endif
@@ -1,8 +1,10 @@
+#if (AMREX_SPACEDIM == 3)
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF_Cylinder.H>
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <eb_cache.H>
 #include <incflo.H>
 
 /********************************************************************************
@@ -35,17 +37,29 @@ void incflo::make_eb_cylinder()
 	amrex::Print() << " Center:    " << center[0] << ", " << center[1] << ", " << center[2]
 				   << std::endl;
 
-    // Build the Cylinder implficit function representing the curved walls     
+    // A spinning cylinder: the walls rotate clockwise about the axis, in place
+    if(cyl_speed > 0.0)
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!eb_moving, "cylinder.speed cannot be combined with motion.*");
+        eb_motion.omega[direction] = - cyl_speed / radius;
+        eb_motion.center = center;
+    }
+
+    // Build the Cylinder implficit function representing the curved walls
     EB2::CylinderIF my_cyl(radius, direction, center, inside);
 
-    // Generate GeometryShop
-    auto gshop = EB2::makeShop(my_cyl);
+    // Key identifying this geometry in the EB cache
+    std::ostringstream eb_key;
+    eb_key.precision(17);
+    eb_key << "cylinder " << inside << ' ' << radius << ' ' << direction
+           << ' ' << center[0] << ' ' << center[1] << ' ' << center[2];
 
     // Build index space
     int max_level_here = 0;
 	int max_coarsening_level = 100;
     EBSupport m_eb_support_level = EBSupport::full;
-	EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+	build_eb_index_space(my_cyl, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = my_cyl;
     const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
 
     // Make the EBFabFactory
@@ -63,3 +77,5 @@ void incflo::make_eb_cylinder()
                                                     m_eb_support_level));
     }
 }
+
+#endif
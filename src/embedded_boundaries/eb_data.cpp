@@ -0,0 +1,610 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <eb_data.H>
+
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#if (AMREX_SPACEDIM == 3)
+
+namespace
+{
+    // Cell data on disk: flag, volfrac, centroid, bndryarea, bndrycent, bndrynorm
+    const int ncell_comp = 12;
+
+    // Face data on disk: areafrac, facecent
+    const int nface_comp = 3;
+
+    // Type of a flag fab on its box, with the rules of EB2
+    void set_fab_type(EBCellFlagFab& fab)
+    {
+        const Box& bx = fab.box();
+        long nregular = 0;
+        long ncovered = 0;
+        long nmulti = 0;
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+            const EBCellFlag& flag = fab(IntVect(i, j, k));
+            if(flag.isRegular())
+                nregular++;
+            else if(flag.isCovered())
+                ncovered++;
+            else if(flag.isMultiValued())
+                nmulti++;
+        }
+
+        const long npts = bx.numPts();
+        if(nregular == npts)
+            fab.setType(FabType::regular);
+        else if(ncovered == npts)
+            fab.setType(FabType::covered);
+        else if(nmulti > 0)
+            fab.setType(FabType::multivalued);
+        else
+            fab.setType(FabType::singlevalued);
+    }
+
+    // Fill the EB data on the layout of the arguments from level
+    void fill_from_level(const EB2::Level& level, const Geometry& geom,
+                         FabArray<EBCellFlagFab>& flag, MultiFab& volfrac, MultiFab& centroid,
+                         MultiFab& bndryarea, MultiFab& bndrycent, MultiFab& bndrynorm,
+                         Array<MultiFab, 3>& areafrac, Array<MultiFab, 3>& facecent)
+    {
+        level.fillEBCellFlag(flag, geom);
+        level.fillVolFrac(volfrac, geom);
+        level.fillCentroid(centroid, geom);
+        level.fillBndryArea(bndryarea, geom);
+        level.fillBndryCent(bndrycent, geom);
+        level.fillBndryNorm(bndrynorm, geom);
+        level.fillAreaFrac({&areafrac[0], &areafrac[1], &areafrac[2]}, geom);
+        level.fillFaceCent({&facecent[0], &facecent[1], &facecent[2]}, geom);
+    }
+
+    // Overwrite the flags of fab with those of src, which holds its box. The arrays made
+    // from a factory point to its flag fabs, so the fab is made again at the same address,
+    // which also drops the types it cached for the boxes it was asked about.
+    void overwrite_flags(EBCellFlagFab& fab, const EBCellFlagFab& src)
+    {
+        EBCellFlagFab new_fab(fab.box());
+        new_fab.copy(src);
+        set_fab_type(new_fab);
+
+        fab.~EBCellFlagFab();
+        new (&fab) EBCellFlagFab(std::move(new_fab));
+    }
+
+    // Overwrite box K of cut (on this rank) with src, which holds its box. Cut fabs are only
+    // allocated in full for the boxes that had cut cells when the factory was made.
+    void overwrite_cut_fab(MultiCutFab& cut, int K, const FArrayBox& src)
+    {
+        FabArray<CutFab>& data = cut.data();
+        if(!data.defined(K) || data[K].box() != data.fabbox(K))
+        {
+            data.setFab(K, std::unique_ptr<CutFab>(new CutFab(data.fabbox(K), data.nComp())));
+        }
+        data[K].copy(src);
+    }
+}
+
+EBDataLevel::EBDataLevel(const EBDataIndexSpace* a_is, const Geometry& a_geom,
+                         const EB2::Level& a_level)
+    : EB2::Level(a_is, a_geom)
+{
+    define();
+    fill_from_level(a_level, m_geom, m_cellflag, m_volfrac, m_centroid,
+                    m_bndryarea, m_bndrycent, m_bndrynorm, m_areafrac, m_facecent);
+
+    updateTypes();
+}
+
+EBDataLevel::EBDataLevel(const EBDataIndexSpace* a_is, const Geometry& a_geom,
+                         const std::string& a_prefix)
+    : EB2::Level(a_is, a_geom)
+{
+    define();
+
+    MultiFab cell(m_grids, m_dmap, ncell_comp, 0);
+    VisMF::Read(cell, a_prefix + "_cell");
+
+    // The flags are stored as their bit pattern, which a Real holds exactly
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(MFIter mfi(m_cellflag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& c = cell.array(mfi);
+        EBCellFlagFab& fab = m_cellflag[mfi];
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+            fab(IntVect(i, j, k)) = EBCellFlag(static_cast<uint32_t>(c(i, j, k, 0)));
+        }
+    }
+
+    MultiFab::Copy(m_volfrac, cell, 1, 0, 1, 0);
+    MultiFab::Copy(m_centroid, cell, 2, 0, 3, 0);
+    MultiFab::Copy(m_bndryarea, cell, 5, 0, 1, 0);
+    MultiFab::Copy(m_bndrycent, cell, 6, 0, 3, 0);
+    MultiFab::Copy(m_bndrynorm, cell, 9, 0, 3, 0);
+
+    for(int dir = 0; dir < 3; dir++)
+    {
+        MultiFab face(m_areafrac[dir].boxArray(), m_dmap, nface_comp, 0);
+        VisMF::Read(face, a_prefix + "_face_" + std::to_string(dir));
+        MultiFab::Copy(m_areafrac[dir], face, 0, 0, 1, 0);
+        MultiFab::Copy(m_facecent[dir], face, 1, 0, 2, 0);
+    }
+
+    updateTypes();
+}
+
+BoxArray EBDataLevel::grids(const Geometry& geom)
+{
+    int max_grid_size = 64;
+    int ngrow = 8;
+    ParmParse pp_eb2("eb2");
+    pp_eb2.query("max_grid_size", max_grid_size);
+    pp_eb2.query("data_ngrow", ngrow);
+
+    // Periodic images are filled from the domain
+    Box bx = geom.Domain();
+    for(int d = 0; d < 3; d++)
+    {
+        if(!geom.isPeriodic(d))
+            bx.grow(d, ngrow);
+    }
+
+    BoxArray ba(bx);
+    ba.maxSize(max_grid_size);
+    return ba;
+}
+
+void EBDataLevel::define()
+{
+    m_grids = grids(m_geom);
+    m_dmap = DistributionMapping(m_grids);
+    m_ngrow = IntVect::TheZeroVector();
+
+    m_cellflag.define(m_grids, m_dmap, 1, 0);
+    m_volfrac.define(m_grids, m_dmap, 1, 0);
+    m_centroid.define(m_grids, m_dmap, 3, 0);
+    m_bndryarea.define(m_grids, m_dmap, 1, 0);
+    m_bndrycent.define(m_grids, m_dmap, 3, 0);
+    m_bndrynorm.define(m_grids, m_dmap, 3, 0);
+    for(int dir = 0; dir < 3; dir++)
+    {
+        const BoxArray& faces = amrex::convert(m_grids, IntVect::TheDimensionVector(dir));
+        m_areafrac[dir].define(faces, m_dmap, 1, 0);
+        m_facecent[dir].define(faces, m_dmap, 2, 0);
+    }
+
+    m_ok = true;
+}
+
+void EBDataLevel::pack(MultiFab& cell, Array<MultiFab, 3>& face) const
+{
+    cell.define(m_grids, m_dmap, ncell_comp, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(MFIter mfi(m_cellflag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& c = cell.array(mfi);
+        const EBCellFlagFab& fab = m_cellflag[mfi];
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+            c(i, j, k, 0) = static_cast<Real>(fab(IntVect(i, j, k)).getValue());
+        }
+    }
+
+    MultiFab::Copy(cell, m_volfrac, 0, 1, 1, 0);
+    MultiFab::Copy(cell, m_centroid, 0, 2, 3, 0);
+    MultiFab::Copy(cell, m_bndryarea, 0, 5, 1, 0);
+    MultiFab::Copy(cell, m_bndrycent, 0, 6, 3, 0);
+    MultiFab::Copy(cell, m_bndrynorm, 0, 9, 3, 0);
+
+    for(int dir = 0; dir < 3; dir++)
+    {
+        face[dir].define(m_areafrac[dir].boxArray(), m_dmap, nface_comp, 0);
+        MultiFab::Copy(face[dir], m_areafrac[dir], 0, 0, 1, 0);
+        MultiFab::Copy(face[dir], m_facecent[dir], 0, 1, 2, 0);
+    }
+}
+
+void EBDataLevel::write(const std::string& prefix) const
+{
+    MultiFab cell;
+    Array<MultiFab, 3> face;
+    pack(cell, face);
+
+    VisMF::Write(cell, prefix + "_cell");
+    for(int dir = 0; dir < 3; dir++)
+    {
+        VisMF::Write(face[dir], prefix + "_face_" + std::to_string(dir));
+    }
+}
+
+Real EBDataLevel::maxDifference(const EBDataLevel& other) const
+{
+    MultiFab cell, other_cell;
+    Array<MultiFab, 3> face, other_face;
+    pack(cell, face);
+    other.pack(other_cell, other_face);
+
+    Real diff = (m_allregular == other.m_allregular) ? 0.0 : 1.0;
+
+    MultiFab::Subtract(cell, other_cell, 0, 0, ncell_comp, 0);
+    for(int n = 0; n < ncell_comp; n++)
+    {
+        diff = std::max(diff, cell.norm0(n));
+    }
+    for(int dir = 0; dir < 3; dir++)
+    {
+        MultiFab::Subtract(face[dir], other_face[dir], 0, 0, nface_comp, 0);
+        for(int n = 0; n < nface_comp; n++)
+        {
+            diff = std::max(diff, face[dir].norm0(n));
+        }
+    }
+
+    return diff;
+}
+
+void EBDataLevel::copy(const EB2::Level& level, const Geometry& level_geom,
+                       const Box& region, const IntVect& shift)
+{
+    BL_PROFILE("EBDataLevel::copy()");
+
+    int max_grid_size = 64;
+    ParmParse pp_eb2("eb2");
+    pp_eb2.query("max_grid_size", max_grid_size);
+
+    // Fill the data of region from level, in the index space of level
+    Box level_region(region);
+    level_region.shift(-shift);
+    BoxArray ba(level_region);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    FabArray<EBCellFlagFab> flag(ba, dm, 1, 0);
+    MultiFab volfrac(ba, dm, 1, 0);
+    MultiFab centroid(ba, dm, 3, 0);
+    MultiFab bndryarea(ba, dm, 1, 0);
+    MultiFab bndrycent(ba, dm, 3, 0);
+    MultiFab bndrynorm(ba, dm, 3, 0);
+    Array<MultiFab, 3> areafrac;
+    Array<MultiFab, 3> facecent;
+    for(int dir = 0; dir < 3; dir++)
+    {
+        const BoxArray& faces = amrex::convert(ba, IntVect::TheDimensionVector(dir));
+        areafrac[dir].define(faces, dm, 1, 0);
+        facecent[dir].define(faces, dm, 2, 0);
+    }
+
+    fill_from_level(level, level_geom, flag, volfrac, centroid,
+                    bndryarea, bndrycent, bndrynorm, areafrac, facecent);
+
+    // Move it over to our index space, then to our layout
+    BoxArray shifted_ba(ba);
+    shifted_ba.shift(shift);
+
+    FabArray<EBCellFlagFab> shifted_flag(shifted_ba, dm, 1, 0);
+    MultiFab shifted_cell(shifted_ba, dm, ncell_comp - 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(MFIter mfi(shifted_flag); mfi.isValid(); ++mfi)
+    {
+        const Box& src = flag[mfi].box();
+        const Box& dst = shifted_flag[mfi].box();
+        shifted_flag[mfi].copy(flag[mfi], src, 0, dst, 0, 1);
+        shifted_cell[mfi].copy(volfrac[mfi], src, 0, dst, 0, 1);
+        shifted_cell[mfi].copy(centroid[mfi], src, 0, dst, 1, 3);
+        shifted_cell[mfi].copy(bndryarea[mfi], src, 0, dst, 4, 1);
+        shifted_cell[mfi].copy(bndrycent[mfi], src, 0, dst, 5, 3);
+        shifted_cell[mfi].copy(bndrynorm[mfi], src, 0, dst, 8, 3);
+    }
+
+    const Periodicity& period = m_geom.periodicity();
+    m_cellflag.ParallelCopy(shifted_flag, 0, 0, 1, 0, 0, period);
+    m_volfrac.ParallelCopy(shifted_cell, 0, 0, 1, 0, 0, period);
+    m_centroid.ParallelCopy(shifted_cell, 1, 0, 3, 0, 0, period);
+    m_bndryarea.ParallelCopy(shifted_cell, 4, 0, 1, 0, 0, period);
+    m_bndrycent.ParallelCopy(shifted_cell, 5, 0, 3, 0, 0, period);
+    m_bndrynorm.ParallelCopy(shifted_cell, 8, 0, 3, 0, 0, period);
+
+    for(int dir = 0; dir < 3; dir++)
+    {
+        BoxArray shifted_faces(areafrac[dir].boxArray());
+        shifted_faces.shift(shift);
+        MultiFab shifted_face(shifted_faces, dm, nface_comp, 0);
+
+        for(MFIter mfi(shifted_face); mfi.isValid(); ++mfi)
+        {
+            const Box& src = areafrac[dir][mfi].box();
+            const Box& dst = shifted_face[mfi].box();
+            shifted_face[mfi].copy(areafrac[dir][mfi], src, 0, dst, 0, 1);
+            shifted_face[mfi].copy(facecent[dir][mfi], src, 0, dst, 1, 2);
+        }
+
+        m_areafrac[dir].ParallelCopy(shifted_face, 0, 0, 1, 0, 0, period);
+        m_facecent[dir].ParallelCopy(shifted_face, 1, 0, 2, 0, 0, period);
+    }
+
+    updateTypes(&region);
+}
+
+void EBDataLevel::updateFactory(EBFArrayBoxFactory& factory, const Box& region,
+                                FabArray<EBCellFlagFab>& old_flags, Vector<int>& index) const
+{
+    BL_PROFILE("EBDataLevel::updateFactory()");
+
+    // The factory shares its EB data with the arrays made from it, and with its clones
+    // in the solvers, so the data is overwritten in place
+    auto& flags = const_cast<FabArray<EBCellFlagFab>&>(factory.getMultiEBCellFlagFab());
+    auto& volfrac = const_cast<MultiFab&>(factory.getVolFrac());
+    auto& centroid = const_cast<MultiCutFab&>(factory.getCentroid());
+    auto& bndryarea = const_cast<MultiCutFab&>(factory.getBndryArea());
+    auto& bndrycent = const_cast<MultiCutFab&>(factory.getBndryCent());
+    auto& bndrynorm = const_cast<MultiCutFab&>(factory.getBndryNormal());
+    const auto& areafrac = factory.getAreaFrac();
+    const auto& facecent = factory.getFaceCent();
+
+    const int ngrow = std::max(flags.nGrow(), std::max(volfrac.nGrow(), centroid.data().nGrow()));
+
+    // Boxes of the factory that meet region, on the ranks that own them
+    const BoxArray& ba = flags.boxArray();
+    const DistributionMapping& dm = flags.DistributionMap();
+    const std::vector<IntVect>& pshifts = m_geom.periodicity().shiftIntVect();
+
+    BoxList bl;
+    Vector<int> owner;
+    index.clear();
+    for(int K = 0; K < ba.size(); K++)
+    {
+        const Box& bx = amrex::grow(ba[K], ngrow);
+        bool touched = false;
+        for(int n = 0; !touched && n < pshifts.size(); n++)
+        {
+            Box image(region);
+            image.shift(pshifts[n]);
+            touched = bx.intersects(image);
+        }
+        if(touched)
+        {
+            bl.push_back(bx);
+            owner.push_back(dm[K]);
+            index.push_back(K);
+        }
+    }
+
+    old_flags.clear();
+    if(index.empty())
+    {
+        return;
+    }
+
+    // The data of these boxes, ghost cells included
+    const BoxArray sub_ba(bl);
+    const DistributionMapping sub_dm(owner);
+
+    FabArray<EBCellFlagFab> flag(sub_ba, sub_dm, 1, 0);
+    MultiFab vfrac(sub_ba, sub_dm, 1, 0);
+    MultiFab cent(sub_ba, sub_dm, 3, 0);
+    MultiFab barea(sub_ba, sub_dm, 1, 0);
+    MultiFab bcent(sub_ba, sub_dm, 3, 0);
+    MultiFab bnorm(sub_ba, sub_dm, 3, 0);
+    Array<MultiFab, 3> afrac;
+    Array<MultiFab, 3> fcent;
+    for(int dir = 0; dir < 3; dir++)
+    {
+        const BoxArray& faces = amrex::convert(sub_ba, IntVect::TheDimensionVector(dir));
+        afrac[dir].define(faces, sub_dm, 1, 0);
+        fcent[dir].define(faces, sub_dm, 2, 0);
+    }
+
+    fill_from_level(*this, m_geom, flag, vfrac, cent, barea, bcent, bnorm, afrac, fcent);
+
+    old_flags.define(sub_ba, sub_dm, 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(MFIter mfi(flag); mfi.isValid(); ++mfi)
+    {
+        const int K = index[mfi.index()];
+
+        old_flags[mfi].copy(flags[K]);
+        overwrite_flags(flags[K], flag[mfi]);
+        volfrac[K].copy(vfrac[mfi]);
+
+        // The cut data is only read in the boxes of type singlevalued
+        if(flags[K].getType() != FabType::singlevalued)
+            continue;
+
+        overwrite_cut_fab(centroid, K, cent[mfi]);
+        overwrite_cut_fab(bndryarea, K, barea[mfi]);
+        overwrite_cut_fab(bndrycent, K, bcent[mfi]);
+        overwrite_cut_fab(bndrynorm, K, bnorm[mfi]);
+        for(int dir = 0; dir < 3; dir++)
+        {
+            overwrite_cut_fab(const_cast<MultiCutFab&>(*areafrac[dir]), K, afrac[dir][mfi]);
+            overwrite_cut_fab(const_cast<MultiCutFab&>(*facecent[dir]), K, fcent[dir][mfi]);
+        }
+    }
+}
+
+void EBDataLevel::updateTypes(const Box* region)
+{
+    const std::vector<IntVect>& pshifts = m_geom.periodicity().shiftIntVect();
+    bool allregular = true;
+
+    for(MFIter mfi(m_cellflag); mfi.isValid(); ++mfi)
+    {
+        EBCellFlagFab& fab = m_cellflag[mfi];
+
+        bool touched = (region == nullptr);
+        for(int n = 0; !touched && n < pshifts.size(); n++)
+        {
+            Box image(*region);
+            image.shift(pshifts[n]);
+            touched = fab.box().intersects(image);
+        }
+        if(touched)
+        {
+            set_fab_type(fab);
+        }
+
+        allregular = allregular && (fab.getType() == FabType::regular);
+    }
+
+    ParallelDescriptor::ReduceBoolAnd(allregular);
+    m_allregular = allregular;
+}
+
+EBDataIndexSpace::EBDataIndexSpace(const EB2::IndexSpace& a_is, const Geometry& a_geom)
+{
+    Box domain = a_geom.Domain();
+    while(true)
+    {
+        const Geometry& geom = a_is.getGeometry(domain);
+        m_geom.push_back(geom);
+        m_level.emplace_back(new EBDataLevel(this, geom, a_is.getLevel(geom)));
+
+        if(domain == a_is.coarsestDomain())
+            break;
+        domain.coarsen(2);
+    }
+}
+
+EBDataIndexSpace::EBDataIndexSpace(const std::string& a_dir, const Geometry& a_geom)
+{
+    int nlevels = 0;
+    Vector<Box> domains;
+
+    // Read by the I/O rank and broadcast
+    Vector<char> file_chars;
+    ParallelDescriptor::ReadAndBcastFile(a_dir + "/EBData", file_chars);
+    std::istringstream is(std::string(file_chars.dataPtr()));
+    is >> nlevels;
+    domains.resize(nlevels);
+    for(int i = 0; i < nlevels; i++)
+    {
+        is >> domains[i];
+    }
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nlevels > 0 && domains[0] == a_geom.Domain(),
+                                     "EB data in " + a_dir + " does not match the domain");
+
+    int is_periodic[3];
+    for(int d = 0; d < 3; d++)
+        is_periodic[d] = a_geom.isPeriodic(d);
+
+    for(int i = 0; i < nlevels; i++)
+    {
+        m_geom.push_back(Geometry(domains[i], &a_geom.ProbDomain(), a_geom.Coord(), is_periodic));
+        m_level.emplace_back(new EBDataLevel(this, m_geom.back(),
+                                             a_dir + "/Level_" + std::to_string(i)));
+    }
+}
+
+int EBDataIndexSpace::levelIndex(const Box& domain) const
+{
+    for(int i = 0; i < m_geom.size(); i++)
+    {
+        if(m_geom[i].Domain() == domain)
+            return i;
+    }
+    return -1;
+}
+
+const EB2::Level& EBDataIndexSpace::getLevel(const Geometry& geom) const
+{
+    const int i = levelIndex(geom.Domain());
+    if(i < 0)
+        amrex::Abort("EBDataIndexSpace::getLevel: no level on this domain");
+    return *m_level[i];
+}
+
+const Geometry& EBDataIndexSpace::getGeometry(const Box& domain) const
+{
+    const int i = levelIndex(domain);
+    if(i < 0)
+        amrex::Abort("EBDataIndexSpace::getGeometry: no level on this domain");
+    return m_geom[i];
+}
+
+void EBDataIndexSpace::write(const std::string& dir) const
+{
+    if(ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream os(dir + "/EBData");
+        os << m_level.size() << '\n';
+        for(int i = 0; i < m_level.size(); i++)
+        {
+            os << m_geom[i].Domain() << '\n';
+        }
+    }
+
+    for(int i = 0; i < m_level.size(); i++)
+    {
+        m_level[i]->write(dir + "/Level_" + std::to_string(i));
+    }
+}
+
+Real EBDataIndexSpace::maxDifference(const EBDataIndexSpace& other) const
+{
+    if(other.m_level.size() != m_level.size())
+        return 1.0;
+
+    Real diff = 0.0;
+    for(int i = 0; i < m_level.size(); i++)
+    {
+        if(other.m_geom[i].Domain() != m_geom[i].Domain())
+            return 1.0;
+        diff = std::max(diff, m_level[i]->maxDifference(*other.m_level[i]));
+    }
+    return diff;
+}
+
+EBDataIndexSpace& EBDataIndexSpace::replaceTop(const Geometry& geom)
+{
+    const EB2::IndexSpace& top = EB2::IndexSpace::top();
+    const EBDataIndexSpace* data = dynamic_cast<const EBDataIndexSpace*>(&top);
+
+    if(data == nullptr)
+    {
+        // The copy is complete before the index space it copies goes
+        data = new EBDataIndexSpace(top, geom);
+        EB2::IndexSpace::pop();
+        EB2::IndexSpace::push(const_cast<EBDataIndexSpace*>(data));
+    }
+
+    return const_cast<EBDataIndexSpace&>(*data);
+}
+
+#endif
@@ -0,0 +1,470 @@
+#include <AMReX_EB2.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <eb_data.H>
+#include <incflo.H>
+
+#if (AMREX_SPACEDIM == 3)
+
+namespace
+{
+    // Finest levels of the index space that are updated in the band swept by the body.
+    // The band is aligned to their coarsest one, and the coarser levels, which hold
+    // a small fraction of the cells, are built again on their whole domain.
+    const int nband_levels = 3;
+
+    // Bounding box of the cells of level within region that are not regular (empty if none)
+    Box body_box(EBDataLevel& level, const Box& region)
+    {
+        int lo[3] = {INT_MAX, INT_MAX, INT_MAX};
+        int hi[3] = {INT_MIN, INT_MIN, INT_MIN};
+
+        FabArray<EBCellFlagFab>& flags = level.cellFlag();
+        for(MFIter mfi(flags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox() & region;
+            if(!bx.ok() || flags[mfi].getType() == FabType::regular)
+                continue;
+
+            const EBCellFlagFab& fab = flags[mfi];
+            for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
+            for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
+            for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
+            {
+                if(!fab(IntVect(i, j, k)).isRegular())
+                {
+                    const int iv[3] = {i, j, k};
+                    for(int d = 0; d < 3; d++)
+                    {
+                        lo[d] = std::min(lo[d], iv[d]);
+                        hi[d] = std::max(hi[d], iv[d]);
+                    }
+                }
+            }
+        }
+        ParallelDescriptor::ReduceIntMin(lo, 3);
+        ParallelDescriptor::ReduceIntMax(hi, 3);
+
+        if(lo[0] > hi[0])
+            return Box();
+        return Box(IntVect(lo[0], lo[1], lo[2]), IntVect(hi[0], hi[1], hi[2]));
+    }
+}
+
+/********************************************************************************
+ *                                                                              *
+ * Move the EB geometry to its position at time.                                *
+ *                                                                              *
+ * Only the band of cells swept by the body, from its bounding box at the old   *
+ * time to the bounding box of its moved corners, can change. The EB is built   *
+ * on the band alone, and copied into the EB data of the index space, which     *
+ * the factories of all the levels (and of the solvers) were made from. The     *
+ * factories are then overwritten in place in the boxes that meet the band:     *
+ * the arrays made from them stay, and only the cells uncovered by the body     *
+ * are given a value (its velocity, and the initial scalars). The solvers keep  *
+ * their arrays, settings and boundary conditions, and define their operators  *
+ * again, which hold EB data of their own.                                      *
+ *                                                                              *
+ ********************************************************************************/
+void incflo::MoveEB(Real time)
+{
+	BL_PROFILE("incflo::MoveEB()");
+
+    EBDataIndexSpace& data = EBDataIndexSpace::replaceTop(geom.back());
+    const int nlevels = data.numLevels();
+    const int nband = std::min(nlevels, nband_levels);
+
+    const Geometry& fine_geom = data.geometry(0);
+    const Box& domain = fine_geom.Domain();
+    const Box extent = EBDataLevel::grids(fine_geom).minimalBox();
+    const Real* problo = fine_geom.ProbLo();
+    const Real* dx = fine_geom.CellSize();
+
+    // Cells of the body at the old time
+    if(!eb_body_box.ok())
+    {
+        eb_body_box = body_box(data.level(0), extent);
+    }
+
+    // Band swept by the body, or everything if we cannot bound it
+    Box band = extent;
+    if(eb_body_box.ok())
+    {
+        const IntVect& lo = eb_body_box.smallEnd();
+        const IntVect& hi = eb_body_box.bigEnd();
+
+        // A body that reaches the end of the data, or fills a periodic direction,
+        // extends beyond it: the band then spans that direction
+        bool spans[3];
+        bool bounded = true;
+        for(int d = 0; d < 3; d++)
+        {
+            if(fine_geom.isPeriodic(d))
+                spans[d] = lo[d] <= domain.smallEnd(d) && hi[d] >= domain.bigEnd(d);
+            else
+                spans[d] = lo[d] <= extent.smallEnd(d) || hi[d] >= extent.bigEnd(d);
+            bounded = bounded && !spans[d];
+        }
+
+        if(bounded || !eb_motion.isRotating())
+        {
+            // Box around the corners of the body box, moved to the new time
+            Real new_lo[3] = {1.0e200, 1.0e200, 1.0e200};
+            Real new_hi[3] = {-1.0e200, -1.0e200, -1.0e200};
+            for(int c = 0; c < 8; c++)
+            {
+                RealArray x;
+                for(int d = 0; d < 3; d++)
+                    x[d] = problo[d] + (((c >> d) & 1) ? hi[d] + 1 : lo[d]) * dx[d];
+                RealArray y = eb_motion.fromBodyFrame(eb_motion.toBodyFrame(x, eb_time), time);
+                for(int d = 0; d < 3; d++)
+                {
+                    new_lo[d] = std::min(new_lo[d], y[d]);
+                    new_hi[d] = std::max(new_hi[d], y[d]);
+                }
+            }
+
+            for(int d = 0; d < 3; d++)
+            {
+                if(spans[d])
+                    continue;
+
+                // One more cell on each side for the cells cut by the body
+                const int nlo = static_cast<int>(std::floor((new_lo[d] - problo[d]) / dx[d]));
+                const int nhi = static_cast<int>(std::floor((new_hi[d] - problo[d]) / dx[d]));
+                band.setSmall(d, std::min(lo[d], nlo) - 1);
+                band.setBig(d, std::max(hi[d], nhi) + 1);
+
+                // A band that wraps around a periodic direction spans it
+                if(fine_geom.isPeriodic(d) &&
+                   (band.smallEnd(d) < domain.smallEnd(d) || band.bigEnd(d) > domain.bigEnd(d)))
+                {
+                    band.setSmall(d, domain.smallEnd(d));
+                    band.setBig(d, domain.bigEnd(d));
+                }
+            }
+            band &= extent;
+        }
+    }
+
+    // The band levels are coarsened from the finest one
+    const int ratio = 1 << (nband - 1);
+    band.coarsen(ratio);
+    band.refine(ratio);
+
+    // Geometry of the band, which starts at 0, and is periodic where it spans the domain
+    Box band_domain(band);
+    band_domain.shift(-band.smallEnd());
+    RealBox band_rb;
+    int band_periodic[3];
+    for(int d = 0; d < 3; d++)
+    {
+        band_periodic[d] = fine_geom.isPeriodic(d) && band.length(d) == domain.length(d);
+        band_rb.setLo(d, band_periodic[d] ? fine_geom.ProbLo(d) : problo[d] + band.smallEnd(d) * dx[d]);
+        band_rb.setHi(d, band_periodic[d] ? fine_geom.ProbHi(d) : problo[d] + (band.bigEnd(d) + 1) * dx[d]);
+    }
+    Geometry band_geom(band_domain, &band_rb, fine_geom.Coord(), band_periodic);
+
+    MovingIF moving_if(eb_body_if, eb_motion, time);
+    auto gshop = EB2::makeShop(moving_if);
+
+    // Cells changed on each level of the index space
+    Vector<Box> changed(nlevels);
+
+    EB2::Build(gshop, band_geom, nband - 1, nband - 1);
+    {
+        const EB2::IndexSpace& band_is = EB2::IndexSpace::top();
+        for(int i = 0; i < nband; i++)
+        {
+            changed[i] = amrex::coarsen(band, 1 << i);
+            const Geometry& level_geom = band_is.getGeometry(amrex::coarsen(band_domain, 1 << i));
+            data.level(i).copy(band_is.getLevel(level_geom), level_geom,
+                               changed[i], changed[i].smallEnd());
+        }
+    }
+    EB2::IndexSpace::pop();
+
+    if(nband < nlevels)
+    {
+        EB2::Build(gshop, data.geometry(nband), nlevels - 1 - nband, nlevels - 1 - nband);
+        const EB2::IndexSpace& coarse_is = EB2::IndexSpace::top();
+        for(int i = nband; i < nlevels; i++)
+        {
+            changed[i] = EBDataLevel::grids(data.geometry(i)).minimalBox();
+            const Geometry& level_geom = coarse_is.getGeometry(data.geometry(i).Domain());
+            data.level(i).copy(coarse_is.getLevel(level_geom), level_geom,
+                               changed[i], IntVect::TheZeroVector());
+        }
+        EB2::IndexSpace::pop();
+    }
+
+    // Outside the band, all cells are regular
+    eb_body_box = body_box(data.level(0), band);
+    eb_time = time;
+
+    if(incflo_verbose > 0)
+    {
+        amrex::Print() << "Moving EB to time " << time << ": updated " << band.numPts()
+                       << " of " << extent.numPts() << " cells of the finest level" << std::endl;
+    }
+
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        FabArray<EBCellFlagFab> old_flags;
+        Vector<int> index;
+        const int ilev = data.levelIndex(geom[lev].Domain());
+        data.level(ilev).updateFactory(*ebfactory[lev], changed[ilev], old_flags, index);
+
+        const FabArray<EBCellFlagFab>& new_flags = ebfactory[lev]->getMultiEBCellFlagFab();
+        const Real* lev_dx = geom[lev].CellSize();
+        const Real* lev_problo = geom[lev].ProbLo();
+
+        // Give the cells uncovered by the body its velocity (and the initial scalars)
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for(MFIter mfi(old_flags); mfi.isValid(); ++mfi)
+        {
+            const int b = index[mfi.index()];
+            const Box& bx = grids[lev][b];
+
+            const auto& old_flag = old_flags[mfi].array();
+            const auto& new_flag = new_flags[b].array();
+            const auto& vel_arr = (*vel[lev])[b].array();
+            const auto& gp_arr = (*gp[lev])[b].array();
+            const auto& ro_arr = (*ro[lev])[b].array();
+
+            for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
+            for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
+            for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
+            {
+                if(old_flag(i,j,k).isCovered() && !new_flag(i,j,k).isCovered())
+                {
+                    RealArray x = {lev_problo[0] + (i + 0.5) * lev_dx[0],
+                                   lev_problo[1] + (j + 0.5) * lev_dx[1],
+                                   lev_problo[2] + (k + 0.5) * lev_dx[2]};
+                    RealArray w = eb_motion.wallVelocity(x, time);
+                    for(int d = 0; d < 3; d++)
+                    {
+                        vel_arr(i,j,k,d) = w[d];
+                        gp_arr(i,j,k,d) = 0.0;
+                    }
+                    ro_arr(i,j,k) = ro_0;
+                    for(int n = 0; n < nscal; n++)
+                    {
+                        (*scal[lev])[b](IntVect(i,j,k), n) = scal_ic[n];
+                    }
+                }
+            }
+        }
+
+        // The cost map of the level keeps its times, but not its cell counts
+        TileCost::countCells(lev, new_flags);
+
+        vel[lev]->FillBoundary(geom[lev].periodicity());
+        gp[lev]->FillBoundary(geom[lev].periodicity());
+        ro[lev]->FillBoundary(geom[lev].periodicity());
+        if(nscal > 0)
+        {
+            scal[lev]->FillBoundary(geom[lev].periodicity());
+        }
+    }
+
+    // The solvers are only there after initialisation
+    if(poisson_equation)
+        poisson_equation->updateEB();
+    if(diffusion_equation)
+        diffusion_equation->updateEB();
+
+    UpdateEBVelocity(time);
+
+    // The check needs the solvers
+    if(eb_motion_check && poisson_equation)
+    {
+        CheckEBMotion();
+    }
+}
+
+//
+// A uniform flow at the velocity of a translating body meets its walls with their
+// normal velocity, and is divergence free: both projections must leave it as it is.
+// The check works on copies, and leaves the state alone.
+//
+void incflo::CheckEBMotion()
+{
+	BL_PROFILE("incflo::CheckEBMotion()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(geom[0].isAllPeriodic(),
+                                     "motion.check requires a fully periodic domain");
+
+    const RealArray& U = eb_motion.velocity;
+    const Real speed = std::sqrt(U[0] * U[0] + U[1] * U[1] + U[2] * U[2]);
+
+    // MAC projection of the uniform flow on the faces
+    Vector<std::unique_ptr<MultiFab>> u_mac(finest_level + 1);
+    Vector<std::unique_ptr<MultiFab>> v_mac(finest_level + 1);
+    Vector<std::unique_ptr<MultiFab>> w_mac(finest_level + 1);
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        u_mac[lev].reset(new MultiFab(amrex::convert(grids[lev], IntVect::TheDimensionVector(0)),
+                                      dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
+        v_mac[lev].reset(new MultiFab(amrex::convert(grids[lev], IntVect::TheDimensionVector(1)),
+                                      dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
+        w_mac[lev].reset(new MultiFab(amrex::convert(grids[lev], IntVect::TheDimensionVector(2)),
+                                      dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
+        u_mac[lev]->setVal(U[0]);
+        v_mac[lev]->setVal(U[1]);
+        w_mac[lev]->setVal(U[2]);
+    }
+    mac_projection->apply_projection(u_mac, v_mac, w_mac, ro, cur_time, 0, &eb_vel);
+
+    Real mac_err = 0.0;
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        const FabArray<EBCellFlagFab>& flags = ebfactory[lev]->getMultiEBCellFlagFab();
+        const auto areafrac = ebfactory[lev]->getAreaFrac();
+        MultiFab* face_vel[3] = {u_mac[lev].get(), v_mac[lev].get(), w_mac[lev].get()};
+
+        for(int dir = 0; dir < 3; dir++)
+        {
+            for(MFIter mfi(*face_vel[dir]); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                const FabType type = flags[mfi].getType(amrex::enclosedCells(bx));
+                if(type == FabType::covered)
+                    continue;
+
+                // Faces of the fluid only: their area fraction is 1 in regular boxes
+                const auto& vel_arr = face_vel[dir]->array(mfi);
+                const bool cut = type != FabType::regular;
+                for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
+                for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
+                for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
+                {
+                    if(!cut || (*areafrac[dir])[mfi](IntVect(i,j,k)) > 0.0)
+                    {
+                        mac_err = std::max(mac_err, std::abs(vel_arr(i,j,k) - U[dir]));
+                    }
+                }
+            }
+        }
+    }
+    ParallelDescriptor::ReduceRealMax(mac_err);
+
+    // Nodal projection of the uniform flow in the cells: the correction must vanish
+    Vector<std::unique_ptr<MultiFab>> vel_u(finest_level + 1);
+    Vector<std::unique_ptr<MultiFab>> div(finest_level + 1);
+    Vector<std::unique_ptr<MultiFab>> phi(finest_level + 1);
+    Vector<std::unique_ptr<MultiFab>> fluxes(finest_level + 1);
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        const BoxArray& nd_grids = amrex::convert(grids[lev], IntVect::TheNodeVector());
+        vel_u[lev].reset(new MultiFab(grids[lev], dmap[lev], 3, nghost, MFInfo(), *ebfactory[lev]));
+        div[lev].reset(new MultiFab(nd_grids, dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
+        phi[lev].reset(new MultiFab(nd_grids, dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
+        fluxes[lev].reset(new MultiFab(grids[lev], dmap[lev], 3, 1, MFInfo(), *ebfactory[lev]));
+        for(int dir = 0; dir < 3; dir++)
+        {
+            vel_u[lev]->setVal(U[dir], dir, 1, nghost);
+        }
+        phi[lev]->setVal(0.0);
+    }
+    ComputeNodalDivergence(div, vel_u);
+    poisson_equation->solve(phi, fluxes, ro, div);
+
+    Real nodal_err = 0.0;
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        for(int dir = 0; dir < 3; dir++)
+        {
+            nodal_err = std::max(nodal_err, Norm(fluxes, lev, dir, 0));
+        }
+    }
+
+    amrex::Print() << "Moving EB check at time " << cur_time
+                   << ": max |u - U| / |U| after the MAC projection " << mac_err / speed
+                   << ", after the nodal projection " << nodal_err / speed << std::endl;
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mac_err <= eb_motion_check_tol * speed &&
+                                     nodal_err <= eb_motion_check_tol * speed,
+                                     "Moving EB check failed: the projections do not keep a uniform flow at the body velocity");
+}
+
+//
+// Velocity of the EB walls at time, at the boundary centroid of each cut cell
+//
+void incflo::UpdateEBVelocity(Real time)
+{
+	BL_PROFILE("incflo::UpdateEBVelocity()");
+
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        eb_vel[lev]->setVal(0.0);
+
+        if(!eb_motion.isMoving())
+            continue;
+
+        const FabArray<EBCellFlagFab>& flags = ebfactory[lev]->getMultiEBCellFlagFab();
+        const MultiCutFab& bndrycent = ebfactory[lev]->getBndryCent();
+        const Real* dx = geom[lev].CellSize();
+        const Real* problo = geom[lev].ProbLo();
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi(*eb_vel[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.growntilebox(nghost);
+
+            if(flags[mfi].getType(bx) != FabType::singlevalued)
+                continue;
+
+            const auto& flag = flags[mfi].array();
+            const auto& bcent = bndrycent.array(mfi);
+            const auto& ev = eb_vel[lev]->array(mfi);
+
+            for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
+            for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
+            for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
+            {
+                if(flag(i,j,k).isSingleValued())
+                {
+                    RealArray x = {problo[0] + (i + 0.5 + bcent(i,j,k,0)) * dx[0],
+                                   problo[1] + (j + 0.5 + bcent(i,j,k,1)) * dx[1],
+                                   problo[2] + (k + 0.5 + bcent(i,j,k,2)) * dx[2]};
+                    RealArray w = eb_motion.wallVelocity(x, time);
+                    for(int d = 0; d < 3; d++)
+                        ev(i,j,k,d) = w[d];
+                }
+            }
+        }
+    }
+}
+
+#else
+
+//
+// The EB walls never move in 2D, where only regular geometries are supported
+//
+void incflo::MoveEB(Real time)
+{
+    amrex::Abort("Moving EBs are only supported in 3D");
+}
+
+void incflo::UpdateEBVelocity(Real time)
+{
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        eb_vel[lev]->setVal(0.0);
+    }
+}
+
+void incflo::CheckEBMotion()
+{
+    amrex::Abort("Moving EBs are only supported in 3D");
+}
+#endif
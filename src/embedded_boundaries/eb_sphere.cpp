@@ -1,8 +1,10 @@
+#if (AMREX_SPACEDIM == 3)
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF_Sphere.H>
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <eb_cache.H>
 #include <incflo.H>
 
 /********************************************************************************
@@ -35,14 +37,18 @@ void incflo::make_eb_sphere()
     // Build the sphere implicit function 
     EB2::SphereIF my_sphere(radius, center, inside);
 
-    // Generate GeometryShop
-    auto gshop = EB2::makeShop(my_sphere);
+    // Key identifying this geometry in the EB cache
+    std::ostringstream eb_key;
+    eb_key.precision(17);
+    eb_key << "sphere " << inside << ' ' << radius
+           << ' ' << center[0] << ' ' << center[1] << ' ' << center[2];
 
     // Build index space
     int max_level_here = 0;
 	int max_coarsening_level = 100;
     EBSupport m_eb_support_level = EBSupport::full;
-	EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+	build_eb_index_space(my_sphere, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = my_sphere;
     const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
 
     // Make the EBFabFactory
@@ -60,3 +66,5 @@ void incflo::make_eb_sphere()
                                                     m_eb_support_level));
     }
 }
+
+#endif
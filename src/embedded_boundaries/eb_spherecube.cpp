@@ -1,8 +1,10 @@
+#if (AMREX_SPACEDIM == 3)
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF.H>
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <eb_cache.H>
 #include <incflo.H>
 
 /********************************************************************************
@@ -20,14 +22,16 @@ void incflo::make_eb_spherecube()
     EB2::BoxIF cube({1.85, 1.85, 2.85}, {2.5, 2.5, 3.5}, false);
     auto cubesphere = EB2::makeUnion(sphere, cube);
 
-    // Generate GeometryShop
-    auto gshop = EB2::makeShop(cubesphere);
+    // Key identifying this geometry in the EB cache
+    std::ostringstream eb_key;
+    eb_key << "spherecube";
 
     // Build index space
     int max_level_here = 0;
 	int max_coarsening_level = 100;
     EBSupport m_eb_support_level = EBSupport::full;
-	EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+	build_eb_index_space(cubesphere, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = cubesphere;
     const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
 
     // Make the EBFabFactory
@@ -45,3 +49,5 @@ void incflo::make_eb_spherecube()
                                                     m_eb_support_level));
     }
 }
+
+#endif
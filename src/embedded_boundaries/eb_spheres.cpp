@@ -0,0 +1,104 @@
+#if (AMREX_SPACEDIM == 3)
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_Sphere.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <fstream>
+#include <eb_cache.H>
+#include <eb_if.H>
+#include <incflo.H>
+
+/********************************************************************************
+ *                                                                              *
+ * Function to create an EB made of many spheres (e.g. a packed bed).           *
+ * The spheres are read from spheres.file, one "x y z radius" per line, and     *
+ * combined in a spatially indexed union.                                       *
+ *                                                                              *
+ ********************************************************************************/
+void incflo::make_eb_spheres()
+{
+    std::string spheres_file = "";
+
+    // Get spheres information from inputs file.                               *
+    ParmParse pp("spheres");
+    pp.get("file", spheres_file);
+
+    // The I/O processor reads the list and broadcasts it
+    Vector<Real> data;
+    if(ParallelDescriptor::IOProcessor())
+    {
+        std::ifstream ifs(spheres_file);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ifs.good(), "Could not open spheres file " + spheres_file);
+        Real val;
+        while(ifs >> val)
+            data.push_back(val);
+    }
+    long n = data.size();
+    ParallelDescriptor::Bcast(&n, 1, ParallelDescriptor::IOProcessorNumber());
+    data.resize(n);
+    ParallelDescriptor::Bcast(data.dataPtr(), n, ParallelDescriptor::IOProcessorNumber());
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n > 0 && n % 4 == 0,
+                                     "Spheres file must hold one 'x y z radius' per sphere");
+
+    const int nspheres = n / 4;
+    Vector<EB2::SphereIF> spheres;
+    Vector<RealArray> lo(nspheres), hi(nspheres);
+    spheres.reserve(nspheres);
+    for(int i = 0; i < nspheres; i++)
+    {
+        RealArray center = {data[4 * i], data[4 * i + 1], data[4 * i + 2]};
+        Real radius = data[4 * i + 3];
+        spheres.emplace_back(radius, center, false);
+        for(int d = 0; d < 3; d++)
+        {
+            lo[i][d] = center[d] - radius;
+            hi[i][d] = center[d] + radius;
+        }
+    }
+
+    // Print info about spheres
+	amrex::Print() << " " << std::endl;
+	amrex::Print() << " File:      " << spheres_file << std::endl;
+	amrex::Print() << " Spheres:   " << nspheres << std::endl;
+
+    // Inflate the bounding boxes by two cells of the finest level, so that
+    // root finding along cut edges always sees the exact union
+    Real margin = 2.0 * geom.back().CellSize(0);
+    for(int d = 1; d < 3; d++)
+        margin = std::max(margin, 2.0 * geom.back().CellSize(d));
+    UnionListIF<EB2::SphereIF> my_spheres(spheres, lo, hi, margin);
+
+    // Key identifying this geometry in the EB cache: the centers and radii
+    // themselves, so that a cache is not reused after the file changes
+    std::ostringstream eb_key;
+    eb_key.precision(17);
+    eb_key << "spheres " << nspheres << ' ' << eb_cache_hash(data.dataPtr(), data.size());
+
+    // Build index space
+    int max_level_here = 0;
+	int max_coarsening_level = 100;
+    EBSupport m_eb_support_level = EBSupport::full;
+	build_eb_index_space(my_spheres, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = my_spheres;
+    const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
+
+    // Make the EBFabFactory
+    for(int lev = 0; lev <= max_level; lev++)
+    {
+        const EB2::Level& eb_is_lev = eb_is.getLevel(geom[lev]);
+        eb_level = &eb_is_lev;
+        ebfactory[lev].reset(new EBFArrayBoxFactory(*eb_level,
+                                                    geom[lev],
+                                                    grids[lev],
+                                                    dmap[lev],
+                                                    {m_eb_basic_grow_cells,
+                                                    m_eb_volume_grow_cells,
+                                                    m_eb_full_grow_cells},
+                                                    m_eb_support_level));
+    }
+}
+
+#endif
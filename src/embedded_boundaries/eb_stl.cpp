@@ -0,0 +1,543 @@
+#if (AMREX_SPACEDIM == 3)
+#include <AMReX_EB2.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <eb_cache.H>
+#include <eb_stl.H>
+#include <incflo.H>
+
+namespace
+{
+    // Maximum number of triangles in a BVH leaf
+    const int leaf_size = 4;
+
+    inline Real dot(const RealArray& a, const RealArray& b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline RealArray sub(const RealArray& a, const RealArray& b)
+    {
+        return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+    }
+
+    inline RealArray cross(const RealArray& a, const RealArray& b)
+    {
+        return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    }
+
+    // Squared distance from p to the axis-aligned box [lo, hi]
+    inline Real box_dist2(const RealArray& p, const RealArray& lo, const RealArray& hi)
+    {
+        Real d2 = 0.0;
+        for(int d = 0; d < 3; d++)
+        {
+            Real e = std::max(std::max(lo[d] - p[d], 0.0), p[d] - hi[d]);
+            d2 += e * e;
+        }
+        return d2;
+    }
+
+    // Squared distance from p to triangle (a, b, c), following Ericson,
+    // "Real-Time Collision Detection", section 5.1.5
+    Real tri_dist2(const RealArray& p, const RealArray& a, const RealArray& b, const RealArray& c)
+    {
+        RealArray ab = sub(b, a);
+        RealArray ac = sub(c, a);
+        RealArray ap = sub(p, a);
+        RealArray q;
+
+        Real d1 = dot(ab, ap);
+        Real d2 = dot(ac, ap);
+        RealArray bp = sub(p, b);
+        Real d3 = dot(ab, bp);
+        Real d4 = dot(ac, bp);
+        RealArray cp = sub(p, c);
+        Real d5 = dot(ab, cp);
+        Real d6 = dot(ac, cp);
+
+        Real vc = d1 * d4 - d3 * d2;
+        Real vb = d5 * d2 - d1 * d6;
+        Real va = d3 * d6 - d5 * d4;
+
+        if(d1 <= 0.0 && d2 <= 0.0)
+        {
+            q = a;
+        }
+        else if(d3 >= 0.0 && d4 <= d3)
+        {
+            q = b;
+        }
+        else if(d6 >= 0.0 && d5 <= d6)
+        {
+            q = c;
+        }
+        else if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+        {
+            Real v = d1 / (d1 - d3);
+            q = {a[0] + v * ab[0], a[1] + v * ab[1], a[2] + v * ab[2]};
+        }
+        else if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+        {
+            Real w = d2 / (d2 - d6);
+            q = {a[0] + w * ac[0], a[1] + w * ac[1], a[2] + w * ac[2]};
+        }
+        else if(va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+        {
+            Real w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            q = {b[0] + w * (c[0] - b[0]), b[1] + w * (c[1] - b[1]), b[2] + w * (c[2] - b[2])};
+        }
+        else
+        {
+            Real denom = 1.0 / (va + vb + vc);
+            Real v = vb * denom;
+            Real w = vc * denom;
+            q = {a[0] + ab[0] * v + ac[0] * w,
+                 a[1] + ab[1] * v + ac[1] * w,
+                 a[2] + ab[2] * v + ac[2] * w};
+        }
+
+        RealArray pq = sub(p, q);
+        return dot(pq, pq);
+    }
+
+    // Whether the ray p + t * dir (t > 0) crosses triangle (a, b, c) (Moller-Trumbore)
+    bool ray_hits_tri(const RealArray& p, const RealArray& dir,
+                      const RealArray& a, const RealArray& b, const RealArray& c)
+    {
+        RealArray e1 = sub(b, a);
+        RealArray e2 = sub(c, a);
+        RealArray h = cross(dir, e2);
+        Real det = dot(e1, h);
+        if(std::abs(det) < 1.0e-300)
+            return false;
+
+        Real inv_det = 1.0 / det;
+        RealArray s = sub(p, a);
+        Real u = inv_det * dot(s, h);
+        if(u < 0.0 || u > 1.0)
+            return false;
+
+        RealArray qv = cross(s, e1);
+        Real v = inv_det * dot(dir, qv);
+        if(v < 0.0 || u + v > 1.0)
+            return false;
+
+        return inv_det * dot(e2, qv) > 0.0;
+    }
+
+    // Whether the ray p + t * dir (t > 0) crosses the box [lo, hi] (slab test)
+    bool ray_hits_box(const RealArray& p, const RealArray& inv_dir,
+                      const RealArray& lo, const RealArray& hi)
+    {
+        Real tmin = 0.0;
+        Real tmax = std::numeric_limits<Real>::max();
+        for(int d = 0; d < 3; d++)
+        {
+            Real t1 = (lo[d] - p[d]) * inv_dir[d];
+            Real t2 = (hi[d] - p[d]) * inv_dir[d];
+            tmin = std::max(tmin, std::min(t1, t2));
+            tmax = std::min(tmax, std::max(t1, t2));
+        }
+        return tmin <= tmax;
+    }
+}
+
+STLSurface::STLSurface(const std::string& a_file, Real a_scale, const RealArray& a_offset)
+{
+	BL_PROFILE("STLSurface::STLSurface()");
+
+    // Binary STL files are exactly 84 + 50 * (number of triangles) bytes long
+    bool is_binary = false;
+    {
+        std::ifstream ifs(a_file, std::ios::binary | std::ios::ate);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ifs.good(), "Could not open STL file " + a_file);
+
+        std::streamoff size = ifs.tellg();
+        if(size >= 84)
+        {
+            uint32_t ntri = 0;
+            ifs.seekg(80);
+            ifs.read(reinterpret_cast<char*>(&ntri), sizeof(uint32_t));
+            is_binary = (size == 84 + 50 * std::streamoff(ntri));
+        }
+    }
+
+    if(is_binary)
+        readBinary(a_file);
+    else
+        readAscii(a_file);
+
+    for(auto& tri : m_tri)
+    {
+        for(int d = 0; d < 3; d++)
+        {
+            tri.v0[d] = a_scale * tri.v0[d] + a_offset[d];
+            tri.v1[d] = a_scale * tri.v1[d] + a_offset[d];
+            tri.v2[d] = a_scale * tri.v2[d] + a_offset[d];
+        }
+    }
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_tri.empty(), "STL file " + a_file + " has no triangles");
+
+    buildBVH();
+}
+
+//
+// Each rank reads an equal, contiguous share of the triangles,
+// then the shares are gathered on all ranks
+//
+void STLSurface::readBinary(const std::string& a_file)
+{
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int rank = ParallelDescriptor::MyProc();
+
+    std::ifstream ifs(a_file, std::ios::binary);
+    uint32_t ntri = 0;
+    ifs.seekg(80);
+    ifs.read(reinterpret_cast<char*>(&ntri), sizeof(uint32_t));
+
+    Vector<long> first(nprocs + 1);
+    for(int i = 0; i <= nprocs; i++)
+        first[i] = (long(ntri) * i) / nprocs;
+
+    // 9 coordinates per triangle
+    Vector<Real> local(9 * (first[rank + 1] - first[rank]));
+    ifs.seekg(84 + 50 * first[rank]);
+    for(long n = 0; n < first[rank + 1] - first[rank]; n++)
+    {
+        // Each record: normal (3 floats), 3 vertices (9 floats), attribute (uint16)
+        float rec[12];
+        uint16_t attr;
+        ifs.read(reinterpret_cast<char*>(rec), 12 * sizeof(float));
+        ifs.read(reinterpret_cast<char*>(&attr), sizeof(uint16_t));
+        for(int m = 0; m < 9; m++)
+            local[9 * n + m] = rec[3 + m];
+    }
+
+    Vector<Real> all(9 * long(ntri));
+#ifdef BL_USE_MPI
+    Vector<int> counts(nprocs), displs(nprocs);
+    for(int i = 0; i < nprocs; i++)
+    {
+        counts[i] = 9 * (first[i + 1] - first[i]);
+        displs[i] = 9 * first[i];
+    }
+    MPI_Allgatherv(local.dataPtr(), local.size(), ParallelDescriptor::Mpi_typemap<Real>::type(),
+                   all.dataPtr(), counts.dataPtr(), displs.dataPtr(),
+                   ParallelDescriptor::Mpi_typemap<Real>::type(),
+                   ParallelDescriptor::Communicator());
+#else
+    all = local;
+#endif
+
+    m_tri.resize(ntri);
+    for(long n = 0; n < ntri; n++)
+    {
+        for(int d = 0; d < 3; d++)
+        {
+            m_tri[n].v0[d] = all[9 * n + d];
+            m_tri[n].v1[d] = all[9 * n + 3 + d];
+            m_tri[n].v2[d] = all[9 * n + 6 + d];
+        }
+    }
+}
+
+//
+// ASCII files cannot be split by offset: the I/O rank parses the file and broadcasts it
+//
+void STLSurface::readAscii(const std::string& a_file)
+{
+    Vector<Real> all;
+    if(ParallelDescriptor::IOProcessor())
+    {
+        std::ifstream ifs(a_file);
+        std::string word;
+        while(ifs >> word)
+        {
+            if(word == "vertex")
+            {
+                Real x, y, z;
+                ifs >> x >> y >> z;
+                all.push_back(x);
+                all.push_back(y);
+                all.push_back(z);
+            }
+        }
+    }
+
+    long n = all.size();
+    ParallelDescriptor::Bcast(&n, 1, ParallelDescriptor::IOProcessorNumber());
+    all.resize(n);
+    ParallelDescriptor::Bcast(all.dataPtr(), n, ParallelDescriptor::IOProcessorNumber());
+
+    m_tri.resize(n / 9);
+    for(long t = 0; t < n / 9; t++)
+    {
+        for(int d = 0; d < 3; d++)
+        {
+            m_tri[t].v0[d] = all[9 * t + d];
+            m_tri[t].v1[d] = all[9 * t + 3 + d];
+            m_tri[t].v2[d] = all[9 * t + 6 + d];
+        }
+    }
+}
+
+void STLSurface::buildBVH()
+{
+	BL_PROFILE("STLSurface::buildBVH()");
+
+    const int ntri = m_tri.size();
+
+    Vector<RealArray> centroids(ntri);
+    for(int n = 0; n < ntri; n++)
+        for(int d = 0; d < 3; d++)
+            centroids[n][d] = (m_tri[n].v0[d] + m_tri[n].v1[d] + m_tri[n].v2[d]) / 3.0;
+
+    // A binary tree with leaves of at most leaf_size triangles
+    m_nodes.clear();
+    m_nodes.reserve(2 * (ntri / leaf_size + 1));
+    buildNode(0, ntri, centroids);
+}
+
+//
+// Build the subtree for triangles [first, first + count), reordering them
+// in place so that each subtree holds a contiguous range. Returns the node index.
+//
+int STLSurface::buildNode(int first, int count, Vector<RealArray>& centroids)
+{
+    int inode = m_nodes.size();
+    m_nodes.push_back(Node());
+
+    RealArray lo, hi, clo, chi;
+    for(int d = 0; d < 3; d++)
+    {
+        lo[d] = clo[d] = std::numeric_limits<Real>::max();
+        hi[d] = chi[d] = std::numeric_limits<Real>::lowest();
+    }
+    for(int n = first; n < first + count; n++)
+    {
+        for(int d = 0; d < 3; d++)
+        {
+            lo[d] = std::min({lo[d], m_tri[n].v0[d], m_tri[n].v1[d], m_tri[n].v2[d]});
+            hi[d] = std::max({hi[d], m_tri[n].v0[d], m_tri[n].v1[d], m_tri[n].v2[d]});
+            clo[d] = std::min(clo[d], centroids[n][d]);
+            chi[d] = std::max(chi[d], centroids[n][d]);
+        }
+    }
+    m_nodes[inode].lo = lo;
+    m_nodes[inode].hi = hi;
+
+    if(count <= leaf_size)
+    {
+        m_nodes[inode].first = first;
+        m_nodes[inode].count = count;
+        m_nodes[inode].left = -1;
+        m_nodes[inode].right = -1;
+        return inode;
+    }
+
+    // Median split along the longest axis of the centroid bounds
+    int axis = 0;
+    for(int d = 1; d < 3; d++)
+        if(chi[d] - clo[d] > chi[axis] - clo[axis])
+            axis = d;
+
+    Vector<int> idx(count);
+    for(int n = 0; n < count; n++)
+        idx[n] = first + n;
+    int half = count / 2;
+    std::nth_element(idx.begin(), idx.begin() + half, idx.end(),
+                     [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+
+    Vector<Triangle> tri(count);
+    Vector<RealArray> cen(count);
+    for(int n = 0; n < count; n++)
+    {
+        tri[n] = m_tri[idx[n]];
+        cen[n] = centroids[idx[n]];
+    }
+    std::copy(tri.begin(), tri.end(), m_tri.begin() + first);
+    std::copy(cen.begin(), cen.end(), centroids.begin() + first);
+
+    int left = buildNode(first, half, centroids);
+    int right = buildNode(first + half, count - half, centroids);
+
+    m_nodes[inode].first = first;
+    m_nodes[inode].count = 0;
+    m_nodes[inode].left = left;
+    m_nodes[inode].right = right;
+    return inode;
+}
+
+std::uint64_t STLSurface::hash() const
+{
+    return eb_cache_hash(m_tri.data(), m_tri.size());
+}
+
+Real STLSurface::distance(const RealArray& p) const
+{
+    Real best = std::numeric_limits<Real>::max();
+
+    // Depth-first traversal, visiting the nearer child first and
+    // pruning nodes whose boxes are further away than the closest triangle so far
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if(box_dist2(p, node.lo, node.hi) >= best)
+            continue;
+
+        if(node.count > 0)
+        {
+            for(int n = node.first; n < node.first + node.count; n++)
+                best = std::min(best, tri_dist2(p, m_tri[n].v0, m_tri[n].v1, m_tri[n].v2));
+        }
+        else
+        {
+            Real dl = box_dist2(p, m_nodes[node.left].lo, m_nodes[node.left].hi);
+            Real dr = box_dist2(p, m_nodes[node.right].lo, m_nodes[node.right].hi);
+            if(dl < dr)
+            {
+                stack[top++] = node.right;
+                stack[top++] = node.left;
+            }
+            else
+            {
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+    }
+
+    return std::sqrt(best);
+}
+
+int STLSurface::rayCrossings(const RealArray& p, const RealArray& dir) const
+{
+    RealArray inv_dir = {1.0 / dir[0], 1.0 / dir[1], 1.0 / dir[2]};
+
+    int crossings = 0;
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if(!ray_hits_box(p, inv_dir, node.lo, node.hi))
+            continue;
+
+        if(node.count > 0)
+        {
+            for(int n = node.first; n < node.first + node.count; n++)
+                if(ray_hits_tri(p, dir, m_tri[n].v0, m_tri[n].v1, m_tri[n].v2))
+                    crossings++;
+        }
+        else
+        {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+
+    return crossings;
+}
+
+//
+// A ray through an edge or a vertex can be counted twice or not at all, so take a
+// majority vote over three rays in generic (non axis-aligned) directions
+//
+bool STLSurface::inside(const RealArray& p) const
+{
+    static const RealArray dirs[3] = {{0.5773, 0.5774, 0.5775},
+                                      {-0.6123, 0.3536, 0.7071},
+                                      {0.2673, -0.8018, 0.5345}};
+
+    int votes = 0;
+    for(int i = 0; i < 3; i++)
+        votes += rayCrossings(p, dirs[i]) % 2;
+
+    return votes >= 2;
+}
+
+/********************************************************************************
+ *                                                                              *
+ * Function to create an EB from a triangulated surface (STL file).            *
+ *                                                                              *
+ ********************************************************************************/
+void incflo::make_eb_stl()
+{
+    // Initialise STL parameters
+    std::string stl_file = "";
+    bool inside = false;
+    Real scale = 1.0;
+    Vector<Real> offsetvec(3, 0.0);
+
+    // Get STL information from inputs file.                               *
+    ParmParse pp("stl");
+
+    pp.get("file", stl_file);
+    pp.query("internal_flow", inside);
+    pp.query("scale", scale);
+    pp.queryarr("offset", offsetvec, 0, 3);
+    Array<Real, 3> offset = {offsetvec[0], offsetvec[1], offsetvec[2]};
+
+    // Read the surface and build its BVH
+    Real strt_time = ParallelDescriptor::second();
+    std::shared_ptr<const STLSurface> surf(new STLSurface(stl_file, scale, offset));
+    Real end_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(end_time, ParallelDescriptor::IOProcessorNumber());
+
+    // Print info about STL surface
+	amrex::Print() << " " << std::endl;
+	amrex::Print() << " File:          " << stl_file << std::endl;
+	amrex::Print() << " Triangles:     " << surf->numTriangles() << std::endl;
+	amrex::Print() << " Internal Flow: " << inside << std::endl;
+	amrex::Print() << " Scale:         " << scale << std::endl;
+	amrex::Print() << " Offset:        " << offset[0] << ", " << offset[1] << ", " << offset[2]
+				   << std::endl;
+	amrex::Print() << " Read and BVH build time: " << end_time << std::endl;
+
+    // Build the STL implicit function
+    STLIF my_stl(surf, inside);
+
+    // Key identifying this geometry in the EB cache: the triangles themselves,
+    // so that a cache is not reused after the file changes
+    std::ostringstream eb_key;
+    eb_key.precision(17);
+    eb_key << "stl " << surf->numTriangles() << ' ' << surf->hash() << ' ' << inside;
+
+    // Build index space
+    int max_level_here = 0;
+	int max_coarsening_level = 100;
+    EBSupport m_eb_support_level = EBSupport::full;
+	build_eb_index_space(my_stl, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = my_stl;
+    const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
+
+    // Make the EBFabFactory
+    for(int lev = 0; lev <= max_level; lev++)
+    {
+        const EB2::Level& eb_is_lev = eb_is.getLevel(geom[lev]);
+        eb_level = &eb_is_lev;
+        ebfactory[lev].reset(new EBFArrayBoxFactory(*eb_level,
+                                                    geom[lev],
+                                                    grids[lev],
+                                                    dmap[lev],
+                                                    {m_eb_basic_grow_cells,
+                                                    m_eb_volume_grow_cells,
+                                                    m_eb_full_grow_cells},
+                                                    m_eb_support_level));
+    }
+}
+
+#endif
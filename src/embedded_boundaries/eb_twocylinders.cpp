@@ -1,3 +1,4 @@
+#if (AMREX_SPACEDIM == 3)
 #include <AMReX_EB2.H>
 #include <AMReX_EB2_IF_Cylinder.H>
 #include <AMReX_EB2_IF_Union.H>
@@ -5,6 +6,7 @@
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <eb_cache.H>
 #include <embedded_boundaries_F.H>
 #include <incflo.H>
 
@@ -61,14 +63,20 @@ void incflo::make_eb_twocylinders()
     EB2::CylinderIF cyl2(radius2, direction2, center2, false);
     auto twocylinders = EB2::makeUnion(cyl1, cyl2);
 
-    // Generate GeometryShop
-	auto gshop = EB2::makeShop(twocylinders);
+    // Key identifying this geometry in the EB cache
+    std::ostringstream eb_key;
+    eb_key.precision(17);
+    eb_key << "twocylinders " << direction1 << ' ' << radius1
+           << ' ' << center1[0] << ' ' << center1[1] << ' ' << center1[2]
+           << ' ' << direction2 << ' ' << radius2
+           << ' ' << center2[0] << ' ' << center2[1] << ' ' << center2[2];
 
     // Build index space
     int max_level_here = 0;
 	int max_coarsening_level = 100;
     EBSupport m_eb_support_level = EBSupport::full;
-	EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+	build_eb_index_space(twocylinders, eb_key.str(), geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    eb_body_if = twocylinders;
     const EB2::IndexSpace& eb_is = EB2::IndexSpace::top();
 
     // Make the EBFabFactory
@@ -86,3 +94,5 @@ void incflo::make_eb_twocylinders()
                                                     m_eb_support_level));
     }
 }
+
+#endif
@@ -10,13 +10,48 @@ void incflo::MakeEBGeometry()
 
 	/******************************************************************************
    * incflo.geometry=<string> specifies the EB geometry. <string> can be one of    *
-   * box, cylinder, annulus, sphere, spherecube, twocylinders
+   * box, cylinder, annulus, sphere, spheres, spherecube, twocylinders, stl    *
+   * incflo.eb_cache=<dir> caches the built EB data for later runs             *
+   * incflo.eb_algoim_order=<n> recomputes cut-cell moments with Algoim          *
+   * (incflo.eb_algoim_check=1 checks the volume and area of the body)          *
+   * motion.velocity, motion.omega and motion.center move the geometry as a     *
+   * rigid body (translation, and rotation about the moving center)             *
    ******************************************************************************/
 
 	ParmParse pp("incflo");
 
 	std::string geom_type;
 	pp.query("geometry", geom_type);
+	pp.query("eb_algoim_order", eb_algoim_order);
+	AMREX_ALWAYS_ASSERT_WITH_MESSAGE(eb_algoim_order >= 0 && eb_algoim_order <= 10,
+									 "incflo.eb_algoim_order must be between 0 (off) and 10");
+
+#if (AMREX_SPACEDIM == 2)
+    // Only the regular geometry (with the walls of incflo.dat) is supported in 2D
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(geom_type.empty() || geom_type == "regular",
+                                     "incflo.geometry = " + geom_type + " requires DIM = 3");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(eb_algoim_order == 0,
+                                     "incflo.eb_algoim_order requires DIM = 3");
+#endif
+
+    ParmParse pp_motion("motion");
+    Vector<Real> motion_vec(3);
+    if(pp_motion.queryarr("velocity", motion_vec, 0, 3))
+        eb_motion.velocity = {motion_vec[0], motion_vec[1], motion_vec[2]};
+    if(pp_motion.queryarr("omega", motion_vec, 0, 3))
+        eb_motion.omega = {motion_vec[0], motion_vec[1], motion_vec[2]};
+    if(pp_motion.queryarr("center", motion_vec, 0, 3))
+        eb_motion.center = {motion_vec[0], motion_vec[1], motion_vec[2]};
+    eb_moving = eb_motion.isMoving();
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!eb_moving || AMREX_SPACEDIM == 3,
+                                     "motion.* requires DIM = 3");
+    pp_motion.query("check", eb_motion_check);
+    pp_motion.query("check_tol", eb_motion_check_tol);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!eb_motion_check || (eb_moving && !eb_motion.isRotating()),
+                                     "motion.check requires a translating body");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!eb_moving || eb_algoim_order == 0,
+                                     "Moving EBs use the EB2 moments: set incflo.eb_algoim_order = 0");
 
 	/******************************************************************************
    *                                                                            *
@@ -24,6 +59,7 @@ void incflo::MakeEBGeometry()
    *                                                                            *
    ******************************************************************************/
 
+#if (AMREX_SPACEDIM == 3)
     if(geom_type == "box")
 	{
 		amrex::Print() << "\n Building box geometry." << std::endl;
@@ -49,17 +85,45 @@ void incflo::MakeEBGeometry()
 		amrex::Print() << "\n Building sphere geometry." << std::endl;
         make_eb_sphere();
 	}
+	else if(geom_type == "spheres")
+	{
+		amrex::Print() << "\n Building spheres geometry." << std::endl;
+        make_eb_spheres();
+	}
 	else if(geom_type == "spherecube")
 	{
 		amrex::Print() << "\n Building spherecube geometry." << std::endl;
         make_eb_spherecube();
 	}
+	else if(geom_type == "stl")
+	{
+		amrex::Print() << "\n Building STL geometry." << std::endl;
+        make_eb_stl();
+	}
 	else
+#endif
 	{
 		amrex::Print() << "\n No EB geometry declared in inputs => "
 					   << " Will read walls from incflo.dat only." << std::endl;
         make_eb_regular();
 	}
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!eb_moving || eb_body_if,
+                                     "motion.* needs an EB geometry (incflo.geometry)");
+
+    // The high-order moments go into the EB data of the index space, where the
+    // factories of all the levels (and of the multigrid solvers) read them, so
+    // the factories made from the EB2 moments above are made again
+    if(eb_algoim_order > 0)
+    {
+        UpdateAlgoimMoments();
+        for(int lev = 0; lev <= max_level; lev++)
+        {
+            ebfactory[lev].reset();
+            UpdateEBFactory(lev);
+        }
+    }
+
     amrex::Print() << "Done making the geometry ebfactory.\n" << std::endl;
 }
 
@@ -19,13 +19,13 @@ std::unique_ptr<UnionListIF<EB2::PlaneIF>> incflo::get_real_walls(bool& has_real
 	for(int i = 1; i <= 6; i++)
 	{
 		int exists;
-		RealVect normal, center;
-		incflo_get_real_walls(&i, &exists, &normal, &center);
+		Real normal[3], center[3];
+		incflo_get_real_walls(&i, &exists, normal, center);
 		if(exists)
 		{
 			has_real_walls = true;
-			amrex::Print() << "Normal " << normal << std::endl;
-			amrex::Print() << "Center " << center << std::endl;
+			amrex::Print() << "Normal " << RealVect(AMREX_D_DECL(normal[0], normal[1], normal[2])) << std::endl;
+			amrex::Print() << "Center " << RealVect(AMREX_D_DECL(center[0], center[1], center[2])) << std::endl;
 
 			RealArray plane_center = {AMREX_D_DECL(center[0], center[1], center[2])};
 			RealArray plane_normal = {AMREX_D_DECL(normal[0], normal[1], normal[2])};
@@ -0,0 +1,495 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Vector.H>
+
+#include <ImmersedBoundary.H>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace amrex;
+
+#if (AMREX_SPACEDIM == 3)
+
+namespace
+{
+    // 3-point regularised delta function of Roma, Peskin & Berger (JCP 1999),
+    // r in units of the cell size
+    inline Real roma_kernel(Real r)
+    {
+        r = std::abs(r);
+        if(r <= 0.5)
+            return (1.0 + std::sqrt(1.0 - 3.0 * r * r)) / 3.0;
+        else if(r <= 1.5)
+            return (5.0 - 3.0 * r - std::sqrt(1.0 - 3.0 * (1.0 - r) * (1.0 - r))) / 6.0;
+        else
+            return 0.0;
+    }
+
+    // Index of the cell containing x, and the kernel weights of the cells
+    // i-1, i and i+1 in each direction
+    inline void kernel_weights(const Real* x, const Real* plo, const Real* dx,
+                               int* iv, Real w[3][3])
+    {
+        for(int d = 0; d < 3; d++)
+        {
+            Real xi = (x[d] - plo[d]) / dx[d];
+            iv[d] = static_cast<int>(std::floor(xi));
+            for(int n = 0; n < 3; n++)
+            {
+                w[d][n] = roma_kernel(xi - (iv[d] + n - 1 + 0.5));
+            }
+        }
+    }
+}
+
+//
+// Constructor:
+// We read the bodies and place their markers here
+//
+ImmersedBoundary::ImmersedBoundary(AmrCore* _amrcore, Real time)
+{
+    // Get inputs from ParmParse
+	readParameters();
+
+    if(verbose > 0)
+    {
+        amrex::Print() << "Constructing ImmersedBoundary class with "
+                       << bodies.size() << " bodies" << std::endl;
+    }
+
+    amrcore = _amrcore;
+    markers.reset(new IBMarkerContainer(amrcore));
+
+    makeMarkers();
+    moveMarkers(time);
+
+    // Allocate the force
+    updateInternals(_amrcore);
+}
+
+ImmersedBoundary::~ImmersedBoundary()
+{
+}
+
+void ImmersedBoundary::readParameters()
+{
+    ParmParse pp("ib");
+
+    pp.query("verbose", verbose);
+    pp.query("marker_spacing", marker_spacing);
+    pp.query("n_forcing_iter", n_forcing_iter);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(marker_spacing > 0.0, "ib.marker_spacing must be positive");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n_forcing_iter > 0, "ib.n_forcing_iter must be positive");
+
+    // Spheres are read from a file, one per line: x y z radius [u v w [wx wy wz]]
+    std::string bodies_file;
+    if(pp.query("bodies_file", bodies_file))
+    {
+        std::ifstream ifs(bodies_file);
+        if(!ifs.good())
+        {
+            amrex::Abort("ImmersedBoundary: unable to open " + bodies_file);
+        }
+
+        std::string line;
+        while(std::getline(ifs, line))
+        {
+            std::istringstream iss(line.substr(0, line.find('#')));
+            Vector<Real> vals;
+            Real v;
+            while(iss >> v)
+            {
+                vals.push_back(v);
+            }
+            if(vals.empty())
+            {
+                continue;
+            }
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(vals.size() == 4 || vals.size() == 7 || vals.size() == 10,
+                                             "ib.bodies_file: expected x y z radius [u v w [wx wy wz]]");
+
+            RigidMotion body;
+            for(int d = 0; d < 3; d++)
+            {
+                body.center[d] = vals[d];
+                if(vals.size() > 4) body.velocity[d] = vals[4 + d];
+                if(vals.size() > 7) body.omega[d] = vals[7 + d];
+            }
+            bodies.push_back(body);
+            radii.push_back(vals[3]);
+        }
+    }
+    // ... or given directly as ib.centers, ib.radii and optionally ib.velocities and ib.omegas
+    else
+    {
+        Vector<Real> centers_in, velocities_in, omegas_in;
+        pp.queryarr("centers", centers_in);
+        pp.queryarr("radii", radii);
+        pp.queryarr("velocities", velocities_in);
+        pp.queryarr("omegas", omegas_in);
+
+        const int nbodies = radii.size();
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(centers_in.size() == 3 * nbodies,
+                                         "ib.centers must hold 3 values per body");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(velocities_in.empty() || velocities_in.size() == 3 * nbodies,
+                                         "ib.velocities must hold 3 values per body");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(omegas_in.empty() || omegas_in.size() == 3 * nbodies,
+                                         "ib.omegas must hold 3 values per body");
+
+        bodies.resize(nbodies);
+        for(int b = 0; b < nbodies; b++)
+        {
+            for(int d = 0; d < 3; d++)
+            {
+                bodies[b].center[d] = centers_in[3 * b + d];
+                if(!velocities_in.empty()) bodies[b].velocity[d] = velocities_in[3 * b + d];
+                if(!omegas_in.empty()) bodies[b].omega[d] = omegas_in[3 * b + d];
+            }
+        }
+    }
+
+    for(int b = 0; b < radii.size(); b++)
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(radii[b] > 0.0, "ImmersedBoundary: radii must be positive");
+    }
+}
+
+void ImmersedBoundary::updateInternals(AmrCore* amrcore_in)
+{
+    amrcore = amrcore_in;
+
+    // Rebin the markers on the new grids
+    markers->Redistribute();
+
+    force.resize(amrcore->finestLevel() + 1);
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        // The kernel reaches one cell beyond the grid of the marker
+        force[lev].reset(new MultiFab(amrcore->boxArray(lev), amrcore->DistributionMap(lev), 3, 1));
+    }
+}
+
+//
+// Place the markers on the surface of the spheres, at their position at t = 0.
+// The points of a Fibonacci lattice are spread evenly, about marker_spacing * dx apart,
+// and each represents a shell of thickness dx around the surface (Uhlmann, JCP 2005).
+// Every rank makes a share of the markers, Redistribute() then sends them to their grid.
+//
+void ImmersedBoundary::makeMarkers()
+{
+    BL_PROFILE("ImmersedBoundary::makeMarkers");
+
+    const Real* dx = amrcore->Geom(amrcore->maxLevel()).CellSize();
+    const Real h = marker_spacing * dx[0];
+    const Real golden_angle = M_PI * (3.0 - std::sqrt(5.0));
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    auto& ptile = markers->GetParticles(0)[std::make_pair(0, 0)];
+
+    long nmarkers = 0;
+    for(int b = 0; b < bodies.size(); b++)
+    {
+        const Real r = radii[b];
+        const Real area = 4.0 * M_PI * r * r;
+        const int n = std::max(1, static_cast<int>(std::ceil(area / (h * h))));
+        nmarkers += n;
+
+        for(int k = myproc; k < n; k += nprocs)
+        {
+            Real z = 1.0 - (2.0 * k + 1.0) / n;
+            Real rho = std::sqrt(1.0 - z * z);
+            Real phi = golden_angle * k;
+
+            IBMarkerContainer::ParticleType p;
+            p.id() = IBMarkerContainer::ParticleType::NextID();
+            p.cpu() = myproc;
+
+            p.rdata(IBMarkerReal::X0) = bodies[b].center[0] + r * rho * std::cos(phi);
+            p.rdata(IBMarkerReal::Y0) = bodies[b].center[1] + r * rho * std::sin(phi);
+            p.rdata(IBMarkerReal::Z0) = bodies[b].center[2] + r * z;
+            p.rdata(IBMarkerReal::dV) = area / n * dx[0];
+            for(int d = 0; d < 3; d++)
+            {
+                p.pos(d) = p.rdata(IBMarkerReal::X0 + d);
+                p.rdata(IBMarkerReal::fx + d) = 0.0;
+            }
+            p.idata(IBMarkerInt::body) = b;
+
+            ptile.push_back(p);
+        }
+    }
+
+    markers->Redistribute();
+
+    if(verbose > 0)
+    {
+        amrex::Print() << "Placed " << nmarkers << " immersed boundary markers" << std::endl;
+    }
+}
+
+void ImmersedBoundary::moveMarkers(Real time)
+{
+    BL_PROFILE("ImmersedBoundary::moveMarkers");
+
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for(IBMarkerIter pti(*markers, lev); pti.isValid(); ++pti)
+        {
+            auto& aos = pti.GetArrayOfStructs();
+            const int np = aos.numParticles();
+            for(int i = 0; i < np; i++)
+            {
+                auto& p = aos[i];
+                const RigidMotion& body = bodies[p.idata(IBMarkerInt::body)];
+                RealArray x = body.fromBodyFrame({p.rdata(IBMarkerReal::X0),
+                                                  p.rdata(IBMarkerReal::Y0),
+                                                  p.rdata(IBMarkerReal::Z0)}, time);
+                for(int d = 0; d < 3; d++)
+                {
+                    p.pos(d) = x[d];
+                }
+            }
+        }
+    }
+
+    // Rebin the markers that left their grid (this also wraps periodic positions)
+    markers->Redistribute();
+
+    marker_time = time;
+}
+
+//
+// Direct forcing: drive the velocity at the markers to the velocity of the bodies.
+// With n_forcing_iter > 1, the forcing is repeated to correct for the overlap of the
+// kernels of neighbouring markers (multi-direct forcing).
+//
+void ImmersedBoundary::applyForcing(Vector<std::unique_ptr<MultiFab>>& vel, Real dt)
+{
+    BL_PROFILE("ImmersedBoundary::applyForcing");
+
+    body_force.assign(3 * bodies.size(), 0.0);
+
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        const Geometry& gm = amrcore->Geom(lev);
+
+        for(int iter = 0; iter < n_forcing_iter; iter++)
+        {
+            if(iter > 0)
+            {
+                vel[lev]->FillBoundary(gm.periodicity());
+            }
+
+            interpolateVelocity(lev, *vel[lev]);
+
+            // Marker force F = ( U_body - U~ ) / dt
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for(IBMarkerIter pti(*markers, lev); pti.isValid(); ++pti)
+            {
+                auto& aos = pti.GetArrayOfStructs();
+                const int np = aos.numParticles();
+                for(int i = 0; i < np; i++)
+                {
+                    auto& p = aos[i];
+                    const RigidMotion& body = bodies[p.idata(IBMarkerInt::body)];
+                    RealArray ub = body.wallVelocity({p.pos(0), p.pos(1), p.pos(2)}, marker_time);
+                    for(int d = 0; d < 3; d++)
+                    {
+                        p.rdata(IBMarkerReal::fx + d) = (ub[d] - p.rdata(IBMarkerReal::fx + d)) / dt;
+                    }
+                }
+            }
+
+            spreadForce(lev, *force[lev]);
+
+            MultiFab::Saxpy(*vel[lev], dt, *force[lev], 0, 0, 3, 0);
+        }
+    }
+
+    if(verbose > 0)
+    {
+        printBodyForces();
+    }
+}
+
+// U~(X) = sum_x u~(x) delta_h(x - X) h^3, stored in the force components of the markers
+void ImmersedBoundary::interpolateVelocity(int lev, const MultiFab& vel)
+{
+    BL_PROFILE("ImmersedBoundary::interpolateVelocity");
+
+    const Real* dx = amrcore->Geom(lev).CellSize();
+    const Real* plo = amrcore->Geom(lev).ProbLo();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(IBMarkerIter pti(*markers, lev); pti.isValid(); ++pti)
+    {
+        const FArrayBox& vel_fab = vel[pti];
+        auto& aos = pti.GetArrayOfStructs();
+        const int np = aos.numParticles();
+
+        for(int i = 0; i < np; i++)
+        {
+            auto& p = aos[i];
+            const Real x[3] = {p.pos(0), p.pos(1), p.pos(2)};
+            int iv[3];
+            Real w[3][3];
+            kernel_weights(x, plo, dx, iv, w);
+
+            Real u[3] = {0.0, 0.0, 0.0};
+            for(int kk = 0; kk < 3; kk++)
+            for(int jj = 0; jj < 3; jj++)
+            for(int ii = 0; ii < 3; ii++)
+            {
+                const IntVect cell(iv[0] + ii - 1, iv[1] + jj - 1, iv[2] + kk - 1);
+                const Real wijk = w[0][ii] * w[1][jj] * w[2][kk];
+                for(int d = 0; d < 3; d++)
+                {
+                    u[d] += wijk * vel_fab(cell, d);
+                }
+            }
+
+            for(int d = 0; d < 3; d++)
+            {
+                p.rdata(IBMarkerReal::fx + d) = u[d];
+            }
+        }
+    }
+}
+
+//
+// f(x) = sum_X F(X) delta_h(x - X) dV(X)
+// The markers of a grid only write into the grid and its ghost cells, so the grids
+// are spread in parallel. The ghost cell contributions are then added to their owners.
+//
+void ImmersedBoundary::spreadForce(int lev, MultiFab& f)
+{
+    BL_PROFILE("ImmersedBoundary::spreadForce");
+
+    const Geometry& gm = amrcore->Geom(lev);
+    const Real* dx = gm.CellSize();
+    const Real* plo = gm.ProbLo();
+    const Real inv_vol = 1.0 / (dx[0] * dx[1] * dx[2]);
+
+    f.setVal(0.0);
+
+    const int nbodies = bodies.size();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<Real> local_force(3 * nbodies, 0.0);
+
+        for(IBMarkerIter pti(*markers, lev); pti.isValid(); ++pti)
+        {
+            FArrayBox& f_fab = f[pti];
+            auto& aos = pti.GetArrayOfStructs();
+            const int np = aos.numParticles();
+
+            for(int i = 0; i < np; i++)
+            {
+                const auto& p = aos[i];
+                const Real x[3] = {p.pos(0), p.pos(1), p.pos(2)};
+                int iv[3];
+                Real w[3][3];
+                kernel_weights(x, plo, dx, iv, w);
+
+                const Real dV = p.rdata(IBMarkerReal::dV);
+                const int b = p.idata(IBMarkerInt::body);
+
+                for(int kk = 0; kk < 3; kk++)
+                for(int jj = 0; jj < 3; jj++)
+                for(int ii = 0; ii < 3; ii++)
+                {
+                    const IntVect cell(iv[0] + ii - 1, iv[1] + jj - 1, iv[2] + kk - 1);
+                    const Real wijk = w[0][ii] * w[1][jj] * w[2][kk] * dV * inv_vol;
+                    for(int d = 0; d < 3; d++)
+                    {
+                        f_fab(cell, d) += wijk * p.rdata(IBMarkerReal::fx + d);
+                    }
+                }
+
+                for(int d = 0; d < 3; d++)
+                {
+                    local_force[3 * b + d] += p.rdata(IBMarkerReal::fx + d) * dV;
+                }
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        for(int n = 0; n < 3 * nbodies; n++)
+        {
+            body_force[n] += local_force[n];
+        }
+    }
+
+    f.SumBoundary(gm.periodicity());
+}
+
+// Print the force of each body on the fluid (per unit density)
+void ImmersedBoundary::printBodyForces()
+{
+    Vector<Real> total = body_force;
+    ParallelDescriptor::ReduceRealSum(total.dataPtr(), total.size());
+
+    for(int b = 0; b < bodies.size(); b++)
+    {
+        amrex::Print() << "IB force of body " << b << ": "
+                       << total[3 * b] << " " << total[3 * b + 1] << " " << total[3 * b + 2]
+                       << std::endl;
+    }
+}
+
+Real ImmersedBoundary::maxBodyVelocity(int dir) const
+{
+    Real umax = 0.0;
+    for(int b = 0; b < bodies.size(); b++)
+    {
+        const RealArray& w = bodies[b].omega;
+        Real wnorm = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+        umax = std::max(umax, std::abs(bodies[b].velocity[dir]) + wnorm * radii[b]);
+    }
+    return umax;
+}
+
+#else
+
+//
+// The immersed boundaries are only implemented in 3D, and incflo does not
+// create them in 2D (see incflo::ReadParameters)
+//
+ImmersedBoundary::ImmersedBoundary(AmrCore* _amrcore, Real time)
+{
+    amrex::Abort("ImmersedBoundary is only implemented in 3D");
+}
+
+ImmersedBoundary::~ImmersedBoundary()
+{
+}
+
+void ImmersedBoundary::moveMarkers(Real time)
+{
+}
+
+void ImmersedBoundary::applyForcing(Vector<std::unique_ptr<MultiFab>>& vel, Real dt)
+{
+}
+
+Real ImmersedBoundary::maxBodyVelocity(int dir) const
+{
+    return 0.0;
+}
+#endif
@@ -60,6 +60,11 @@ void incflo::InitData()
     // - Perform dummy iterations to find pressure distribution
 	PostInit(restart_flag);
 
+    if(memory_report)
+    {
+        ReportMemory("startup");
+    }
+
     // Plot initial distribution
     if((plot_int > 0 || plot_per > 0) && !restart_flag)
     {
@@ -103,23 +108,13 @@ void incflo::ChopGrids (const Box& domain, BoxArray& ba, int target_size) const
     // Here we hard-wire the minimum size in any one direction the boxes can be
     int min_grid_size = 4;
 
-    IntVect chunk(domain.length(0),domain.length(1),domain.length(2));
+    IntVect chunk(domain.length());
 
     int j;
     for (int cnt = 1; cnt <= max_div; ++cnt)
     {
-        if (chunk[0] >= chunk[1] && chunk[0] >= chunk[2])
-        {
-            j = 0;
-        }
-        else if (chunk[1] >= chunk[0] && chunk[1] >= chunk[2])
-        {
-            j = 1;
-        }
-        else if (chunk[2] >= chunk[0] && chunk[2] >= chunk[1])
-        {
-            j = 2;
-        }
+        // Longest direction (the first one in case of a tie)
+        j = chunk.maxDir(false);
         chunk[j] /= 2;
 
         if (chunk[j] >= min_grid_size)
@@ -181,6 +176,16 @@ void incflo::Evolve()
         do_not_evolve = (steady_state && SteadyStateReached()) ||
                         ((stop_time > 0. && (cur_time >= stop_time - 1.e-12 * dt)) ||
                          (max_step >= 0 && nstep >= max_step));
+
+        // Performance record of the step, including its I/O
+        PerfLog::writeStep(nstep, cur_time, dt);
+
+        // The solvers have all been tuned on the first step
+        if(SolverTuning::isEnabled())
+        {
+            SolverTuning::write();
+            break;
+        }
     }
 
 	// Output at the final time
@@ -190,6 +195,9 @@ void incflo::Evolve()
         UpdateDerivedQuantities();
         WritePlotFile();
     }
+    if(tracers) tracers->FlushTrajectories();
+
+    TileCost::write();
 }
 
 // tag cells for refinement
@@ -260,6 +268,8 @@ void incflo::MakeNewLevelFromScratch(int lev,
 
 	// Allocate the fluid data, NOTE: this depends on the ebfactories.
     AllocateArrays(lev);
+
+    TileCost::define(lev, new_grids, new_dmap, ebfactory[lev]->getMultiEBCellFlagFab());
 }
 
 // Make a new level using provided BoxArray and DistributionMapping and
@@ -0,0 +1,421 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+#include <TracerParticleContainer.H>
+
+#include <cmath>
+#include <fstream>
+
+using namespace amrex;
+
+#if (AMREX_SPACEDIM == 3)
+
+namespace
+{
+    //
+    // Trilinear interpolation of the velocity at x from the 8 surrounding cell centers.
+    // Covered cells are left out and the weights of the others renormalised, so the
+    // covered values never leak into the interpolation.
+    //
+    void interpolate_velocity(const FArrayBox& vel, const EBCellFlagFab& flag,
+                              const Real* x, const Real* plo, const Real* dx, Real* u)
+    {
+        int iv[3];
+        Real f[3];
+        for(int d = 0; d < 3; d++)
+        {
+            Real xi = (x[d] - plo[d]) / dx[d] - 0.5;
+            iv[d] = static_cast<int>(std::floor(xi));
+            f[d] = xi - iv[d];
+        }
+
+        Real wsum = 0.0;
+        u[0] = u[1] = u[2] = 0.0;
+        for(int kk = 0; kk < 2; kk++)
+        for(int jj = 0; jj < 2; jj++)
+        for(int ii = 0; ii < 2; ii++)
+        {
+            const IntVect cell(iv[0] + ii, iv[1] + jj, iv[2] + kk);
+            if(flag(cell).isCovered())
+            {
+                continue;
+            }
+
+            const Real w = (ii ? f[0] : 1.0 - f[0])
+                         * (jj ? f[1] : 1.0 - f[1])
+                         * (kk ? f[2] : 1.0 - f[2]);
+            wsum += w;
+            for(int d = 0; d < 3; d++)
+            {
+                u[d] += w * vel(cell, d);
+            }
+        }
+
+        if(wsum > 0.0)
+        {
+            for(int d = 0; d < 3; d++)
+            {
+                u[d] /= wsum;
+            }
+        }
+    }
+
+    // Whether x is in a covered cell
+    bool is_covered(const EBCellFlagFab& flag, const Real* x, const Real* plo, const Real* dx)
+    {
+        const IntVect cell(static_cast<int>(std::floor((x[0] - plo[0]) / dx[0])),
+                           static_cast<int>(std::floor((x[1] - plo[1]) / dx[1])),
+                           static_cast<int>(std::floor((x[2] - plo[2]) / dx[2])));
+        return flag.box().contains(cell) && flag(cell).isCovered();
+    }
+}
+
+TracerParticleContainer::TracerParticleContainer(AmrCore* amrcore)
+    : AmrParticleContainer<0, 0, TracerReal::count, 0>(amrcore)
+{
+    readParameters();
+
+    if(traj_int > 0)
+    {
+        if(ParallelDescriptor::IOProcessor())
+        {
+            if(!amrex::UtilCreateDirectory(traj_dir, 0755))
+            {
+                amrex::CreateDirectoryFailed(traj_dir);
+            }
+        }
+        ParallelDescriptor::Barrier();
+    }
+}
+
+TracerParticleContainer::~TracerParticleContainer()
+{
+    FlushTrajectories();
+}
+
+void TracerParticleContainer::readParameters()
+{
+    ParmParse pp("tracers");
+
+    pp.query("verbose", verbose);
+    pp.query("n_per_cell", n_per_cell);
+    pp.queryarr("region_lo", region_lo);
+    pp.queryarr("region_hi", region_hi);
+    pp.query("sort_int", sort_int);
+    pp.query("traj_int", traj_int);
+    pp.query("traj_batch", traj_batch);
+    pp.query("traj_dir", traj_dir);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n_per_cell > 0, "tracers.n_per_cell must be positive");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(region_lo.empty() || region_lo.size() == 3,
+                                     "tracers.region_lo needs 3 values");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(region_hi.empty() || region_hi.size() == 3,
+                                     "tracers.region_hi needs 3 values");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(traj_batch > 0, "tracers.traj_batch must be positive");
+}
+
+void TracerParticleContainer::InitInFluid(const Vector<std::unique_ptr<EBFArrayBoxFactory>>& ebfactory,
+                                          Real time)
+{
+    BL_PROFILE("TracerParticleContainer::InitInFluid");
+
+    const Geometry& gm = Geom(0);
+    const Real* dx = gm.CellSize();
+    const Real* plo = gm.ProbLo();
+
+    RealBox region(gm.ProbLo(), gm.ProbHi());
+    if(!region_lo.empty()) region.setLo(region_lo);
+    if(!region_hi.empty()) region.setHi(region_hi);
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const auto& flags = ebfactory[0]->getMultiEBCellFlagFab();
+
+    for(MFIter mfi = MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const EBCellFlagFab& flag = flags[mfi];
+
+        if(flag.getType(bx) == FabType::covered)
+        {
+            continue;
+        }
+
+        auto& ptile = GetParticles(0)[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+
+        for(IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            if(flag(iv).isCovered())
+            {
+                continue;
+            }
+
+            for(int c = 0; c < n_per_cell * n_per_cell * n_per_cell; c++)
+            {
+                const int sub[3] = {c % n_per_cell, (c / n_per_cell) % n_per_cell, c / (n_per_cell * n_per_cell)};
+
+                ParticleType p;
+                for(int d = 0; d < 3; d++)
+                {
+                    p.pos(d) = plo[d] + (iv[d] + (sub[d] + 0.5) / n_per_cell) * dx[d];
+                }
+                if(!region.contains(&p.pos(0)))
+                {
+                    continue;
+                }
+
+                p.id() = ParticleType::NextID();
+                p.cpu() = myproc;
+                ptile.push_back(p);
+                ptile.push_back_real(TracerReal::release_time, time);
+            }
+        }
+    }
+
+    Redistribute();
+
+    if(verbose > 0)
+    {
+        amrex::Print() << "Released " << TotalNumberOfParticles() << " tracers" << std::endl;
+    }
+}
+
+void TracerParticleContainer::Advect(const Vector<std::unique_ptr<MultiFab>>& vel_old,
+                                     const Vector<std::unique_ptr<MultiFab>>& vel_new,
+                                     const Vector<std::unique_ptr<EBFArrayBoxFactory>>& ebfactory,
+                                     Real time, Real dt)
+{
+    BL_PROFILE("TracerParticleContainer::Advect");
+
+    for(int lev = 0; lev <= finestLevel(); lev++)
+    {
+        const Real* dx = Geom(lev).CellSize();
+        const Real* plo = Geom(lev).ProbLo();
+        const auto& flags = ebfactory[lev]->getMultiEBCellFlagFab();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for(TracerIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            const FArrayBox& u_old = (*vel_old[lev])[pti];
+            const FArrayBox& u_new = (*vel_new[lev])[pti];
+            const EBCellFlagFab& flag = flags[pti];
+
+            auto& aos = pti.GetArrayOfStructs();
+            const int np = aos.numParticles();
+
+            for(int i = 0; i < np; i++)
+            {
+                auto& p = aos[i];
+
+                // Heun's method: x* = x + dt u^n(x), x^{n+1} = x + dt/2 ( u^n(x) + u^{n+1}(x*) )
+                Real x[3] = {p.pos(0), p.pos(1), p.pos(2)};
+                Real ua[3], ub[3], xs[3], xn[3];
+
+                interpolate_velocity(u_old, flag, x, plo, dx, ua);
+                for(int d = 0; d < 3; d++)
+                {
+                    xs[d] = x[d] + dt * ua[d];
+                }
+                interpolate_velocity(u_new, flag, xs, plo, dx, ub);
+                for(int d = 0; d < 3; d++)
+                {
+                    xn[d] = x[d] + 0.5 * dt * (ua[d] + ub[d]);
+                }
+
+                // A tracer never enters the walls: it stays put for this step instead
+                if(is_covered(flag, xn, plo, dx))
+                {
+                    continue;
+                }
+
+                for(int d = 0; d < 3; d++)
+                {
+                    p.pos(d) = xn[d];
+                }
+            }
+        }
+    }
+
+    RemoveExitedTracers(time + dt);
+
+    Redistribute();
+
+    nstep++;
+
+    if(sort_int > 0 && nstep % sort_int == 0)
+    {
+        SortParticlesByCell();
+    }
+
+    if(traj_int > 0 && nstep % traj_int == 0)
+    {
+        RecordTrajectories(time + dt);
+    }
+}
+
+// Remove the tracers that left through a non-periodic boundary, and record their residence time
+void TracerParticleContainer::RemoveExitedTracers(Real time)
+{
+    const Geometry& gm = Geom(0);
+    const Real* plo = gm.ProbLo();
+    const Real* phi = gm.ProbHi();
+
+    long n_exited_step = 0;
+
+    for(int lev = 0; lev <= finestLevel(); lev++)
+    {
+        for(TracerIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            auto& aos = pti.GetArrayOfStructs();
+            auto& release_time = pti.GetStructOfArrays().GetRealData(TracerReal::release_time);
+            const int np = aos.numParticles();
+
+            for(int i = 0; i < np; i++)
+            {
+                auto& p = aos[i];
+
+                bool exited = false;
+                for(int d = 0; d < 3; d++)
+                {
+                    if(!gm.isPeriodic(d) && (p.pos(d) < plo[d] || p.pos(d) > phi[d]))
+                    {
+                        exited = true;
+                    }
+                }
+                if(!exited)
+                {
+                    continue;
+                }
+
+                n_exited_step++;
+                sum_residence += time - release_time[i];
+                if(traj_int > 0)
+                {
+                    exit_buffer.push_back(p.id());
+                    exit_buffer.push_back(p.cpu());
+                    exit_buffer.push_back(release_time[i]);
+                    exit_buffer.push_back(time);
+                }
+
+                // Redistribute() removes the particles with negative ids
+                p.id() = -p.id();
+            }
+        }
+    }
+
+    n_exited += n_exited_step;
+
+    if(verbose > 0)
+    {
+        long n_total = n_exited;
+        Real sum_total = sum_residence;
+        ParallelDescriptor::ReduceLongSum(n_total);
+        ParallelDescriptor::ReduceRealSum(sum_total);
+        if(n_total > 0)
+        {
+            amrex::Print() << "Tracers: " << n_total << " exited, mean residence time "
+                           << sum_total / n_total << std::endl;
+        }
+    }
+}
+
+void TracerParticleContainer::RecordTrajectories(Real time)
+{
+    for(int lev = 0; lev <= finestLevel(); lev++)
+    {
+        for(TracerIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            const auto& aos = pti.GetArrayOfStructs();
+            const int np = aos.numParticles();
+
+            for(int i = 0; i < np; i++)
+            {
+                const auto& p = aos[i];
+                traj_buffer.push_back(p.id());
+                traj_buffer.push_back(p.cpu());
+                traj_buffer.push_back(time);
+                traj_buffer.push_back(p.pos(0));
+                traj_buffer.push_back(p.pos(1));
+                traj_buffer.push_back(p.pos(2));
+            }
+        }
+    }
+
+    // Every rank writes its own file, so the batches need no communication
+    if(traj_buffer.size() >= 6 * static_cast<std::size_t>(traj_batch))
+    {
+        FlushTrajectories();
+    }
+}
+
+void TracerParticleContainer::FlushTrajectories()
+{
+    if(traj_int <= 0)
+    {
+        return;
+    }
+
+    BL_PROFILE("TracerParticleContainer::FlushTrajectories");
+
+    const std::string rank = std::to_string(ParallelDescriptor::MyProc());
+
+    if(!traj_buffer.empty())
+    {
+        std::ofstream ofs(traj_dir + "/traj_" + rank, std::ios::binary | std::ios::app);
+        ofs.write(reinterpret_cast<const char*>(traj_buffer.dataPtr()), traj_buffer.size() * sizeof(Real));
+        traj_buffer.clear();
+    }
+
+    if(!exit_buffer.empty())
+    {
+        std::ofstream ofs(traj_dir + "/exits_" + rank, std::ios::binary | std::ios::app);
+        ofs.write(reinterpret_cast<const char*>(exit_buffer.dataPtr()), exit_buffer.size() * sizeof(Real));
+        exit_buffer.clear();
+    }
+}
+
+void TracerParticleContainer::WriteTracers(const std::string& dir, bool is_checkpoint) const
+{
+    BL_PROFILE("TracerParticleContainer::WriteTracers");
+
+    Vector<std::string> real_comp_names = {"release_time"};
+    Checkpoint(dir, "tracers", is_checkpoint, real_comp_names);
+}
+
+#else
+
+//
+// The tracers are only implemented in 3D, and incflo does not create them
+// in 2D (see incflo::ReadParameters)
+//
+TracerParticleContainer::TracerParticleContainer(AmrCore* amrcore)
+    : AmrParticleContainer<0, 0, TracerReal::count, 0>(amrcore)
+{
+    amrex::Abort("The tracers are only implemented in 3D");
+}
+
+TracerParticleContainer::~TracerParticleContainer()
+{
+}
+
+void TracerParticleContainer::InitInFluid(const Vector<std::unique_ptr<EBFArrayBoxFactory>>& ebfactory,
+                                          Real time)
+{
+}
+
+void TracerParticleContainer::Advect(const Vector<std::unique_ptr<MultiFab>>& vel_old,
+                                     const Vector<std::unique_ptr<MultiFab>>& vel_new,
+                                     const Vector<std::unique_ptr<EBFArrayBoxFactory>>& ebfactory,
+                                     Real time, Real dt)
+{
+}
+
+void TracerParticleContainer::FlushTrajectories()
+{
+}
+
+void TracerParticleContainer::WriteTracers(const std::string& dir, bool is_checkpoint) const
+{
+}
+#endif
@@ -0,0 +1,293 @@
+#include <AMReX_ParallelDescriptor.H>
+
+#include <FFTPoisson.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+bool FFTPoisson::applies(const AmrCore& amrcore, const EBFArrayBoxFactory& ebfactory)
+{
+    const Geometry& geom = amrcore.Geom(0);
+    return amrcore.maxLevel() == 0 && geom.isAllPeriodic() && !geom.IsRZ()
+        && ebfactory.isAllRegular();
+}
+
+bool FFTPoisson::isConstant(const MultiFab& mf, Real& value)
+{
+    const Real lo = mf.min(0);
+    const Real hi = mf.max(0);
+    value = hi;
+    return hi - lo <= 1.0e-12 * std::abs(hi);
+}
+
+FFTPoisson::FFTPoisson(const Geometry& geom, IndexType ixtype)
+    : m_geom(geom)
+    , m_ixtype(ixtype)
+{
+    // One point per cell in every direction: for nodal data the nodes at the high end
+    // of the domain are the periodic images of the ones at the low end
+    const Box& domain = geom.Domain();
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+    {
+        // Number of pieces in each direction across the pencils, about one pencil per rank
+        IntVect nsplit(AMREX_D_DECL(1, 1, 1));
+#if (AMREX_SPACEDIM == 3)
+        const int a = (dir + 1) % 3;
+        const int b = (dir + 2) % 3;
+        int pa = 1;
+        for(int p = 1; p * p <= nprocs; p++)
+        {
+            if(nprocs % p == 0)
+            {
+                pa = p;
+            }
+        }
+        nsplit[a] = std::min(pa, domain.length(a));
+        nsplit[b] = std::min(nprocs / pa, domain.length(b));
+#else
+        const int a = 1 - dir;
+        nsplit[a] = std::min(nprocs, domain.length(a));
+#endif
+
+        BoxList bl(ixtype);
+        for(int i = 0; i < nsplit[0]; i++)
+        for(int j = 0; j < nsplit[1]; j++)
+#if (AMREX_SPACEDIM == 3)
+        for(int k = 0; k < nsplit[2]; k++)
+#endif
+        {
+            const IntVect piece(AMREX_D_DECL(i, j, k));
+            IntVect lo, hi;
+            for(int d = 0; d < AMREX_SPACEDIM; d++)
+            {
+                const int n = domain.length(d);
+                lo[d] = domain.smallEnd(d) + piece[d] * n / nsplit[d];
+                hi[d] = domain.smallEnd(d) + (piece[d] + 1) * n / nsplit[d] - 1;
+            }
+            bl.push_back(Box(lo, hi, ixtype));
+        }
+
+        m_pencils[dir] = BoxArray(bl);
+        m_dmap[dir] = DistributionMapping(m_pencils[dir]);
+    }
+}
+
+void FFTPoisson::solve(MultiFab& phi, const MultiFab& rhs, Real sigma) const
+{
+    BL_PROFILE("FFTPoisson::solve()");
+
+    Array<std::unique_ptr<MultiFab>, AMREX_SPACEDIM> data;
+    for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+    {
+        data[dir].reset(new MultiFab(m_pencils[dir], m_dmap[dir], 2, 0));
+    }
+
+    // Forward transforms, transposing to the pencils of each direction in turn
+    data[0]->setVal(0.0);
+    data[0]->ParallelCopy(rhs, 0, 0, 1);
+    transform(*data[0], 0, -1);
+    for(int dir = 1; dir < AMREX_SPACEDIM; dir++)
+    {
+        data[dir]->ParallelCopy(*data[dir - 1], 0, 0, 2);
+        transform(*data[dir], dir, -1);
+    }
+
+    // Divide by the eigenvalues of sigma * lap and normalise. With s = sin^2(pi k / n)
+    // in each direction, the cell-centred stencil has the eigenvalues
+    //     - sum_d 4 s_d / dx_d^2
+    // and the nodal one (a trilinear finite element stiffness matrix)
+    //     - sum_d 4 s_d / dx_d^2 prod_{e != d} (1 - 2/3 s_e)
+    const int last = AMREX_SPACEDIM - 1;
+    const Box& domain = m_geom.Domain();
+    const Real* dx = m_geom.CellSize();
+    const Real npts = domain.d_numPts();
+    const bool nodal = m_ixtype.nodeCentered();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(MFIter mfi(*data[last], true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& d = data[last]->array(mfi);
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+            const IntVect iv(AMREX_D_DECL(i, j, k));
+            Real s[AMREX_SPACEDIM];
+            for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+            {
+                const Real sn = std::sin(M_PI * (iv[dir] - domain.smallEnd(dir)) / domain.length(dir));
+                s[dir] = sn * sn;
+            }
+
+            Real lambda = 0.0;
+            for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+            {
+                Real term = 4.0 * s[dir] / (dx[dir] * dx[dir]);
+                for(int e = 0; nodal && e < AMREX_SPACEDIM; e++)
+                {
+                    if(e != dir)
+                    {
+                        term *= 1.0 - 2.0 / 3.0 * s[e];
+                    }
+                }
+                lambda -= sigma * term;
+            }
+
+            // The constant mode is left out
+            const Real scale = (lambda == 0.0) ? 0.0 : 1.0 / (lambda * npts);
+            d(i, j, k, 0) *= scale;
+            d(i, j, k, 1) *= scale;
+        }
+    }
+
+    // Backward transforms, back to the pencils of the first direction
+    transform(*data[last], last, 1);
+    for(int dir = last - 1; dir >= 0; dir--)
+    {
+        data[dir]->ParallelCopy(*data[dir + 1], 0, 0, 2);
+        transform(*data[dir], dir, 1);
+    }
+
+    // The periodic images fill the high end nodes and the ghost cells
+    phi.setVal(0.0);
+    phi.ParallelCopy(*data[0], 0, 0, 1, 0, phi.nGrow(), m_geom.periodicity());
+}
+
+void FFTPoisson::transform(MultiFab& data, int dir, int sign) const
+{
+    const int di = (dir == 0);
+    const int dj = (dir == 1);
+    const int dk = (dir == 2);
+
+    for(MFIter mfi(data); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& d = data.array(mfi);
+        const int n = bx.length(dir);
+
+        // One line per point of the low face of the pencil
+        Box face(bx);
+        face.setBig(dir, bx.smallEnd(dir));
+        const auto lo = amrex::lbound(face);
+        const auto hi = amrex::ubound(face);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            std::vector<std::complex<Real>> line(n);
+
+#ifdef _OPENMP
+#pragma omp for collapse(2)
+#endif
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                for(int m = 0; m < n; m++)
+                {
+                    line[m] = std::complex<Real>(d(i + m * di, j + m * dj, k + m * dk, 0),
+                                                 d(i + m * di, j + m * dj, k + m * dk, 1));
+                }
+                fft(line, sign);
+                for(int m = 0; m < n; m++)
+                {
+                    d(i + m * di, j + m * dj, k + m * dk, 0) = line[m].real();
+                    d(i + m * di, j + m * dj, k + m * dk, 1) = line[m].imag();
+                }
+            }
+        }
+    }
+}
+
+void FFTPoisson::fft(std::vector<std::complex<Real>>& a, int sign)
+{
+    const int n = a.size();
+    if(n <= 1)
+    {
+        return;
+    }
+
+    if((n & (n - 1)) == 0)
+    {
+        // Radix-2: bit reversal permutation, then the butterflies
+        for(int i = 1, j = 0; i < n; i++)
+        {
+            int bit = n >> 1;
+            for(; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if(i < j)
+            {
+                std::swap(a[i], a[j]);
+            }
+        }
+
+        for(int len = 2; len <= n; len <<= 1)
+        {
+            const std::complex<Real> wlen = std::polar(Real(1.0), Real(sign * 2.0 * M_PI / len));
+            for(int i = 0; i < n; i += len)
+            {
+                std::complex<Real> w(1.0, 0.0);
+                for(int k = 0; k < len / 2; k++)
+                {
+                    const std::complex<Real> u = a[i + k];
+                    const std::complex<Real> v = a[i + k + len / 2] * w;
+                    a[i + k] = u + v;
+                    a[i + k + len / 2] = u - v;
+                    w *= wlen;
+                }
+            }
+        }
+        return;
+    }
+
+    // Bluestein: with jk = (j^2 + k^2 - (k - j)^2) / 2 the transform is a convolution
+    // with the chirp w_k = exp(sign i pi k^2 / n), done with power-of-two transforms
+    int m = 1;
+    while(m < 2 * n - 1)
+    {
+        m <<= 1;
+    }
+
+    std::vector<std::complex<Real>> w(n);
+    std::vector<std::complex<Real>> x(m, std::complex<Real>(0.0, 0.0));
+    std::vector<std::complex<Real>> c(m, std::complex<Real>(0.0, 0.0));
+    for(int k = 0; k < n; k++)
+    {
+        // k^2 modulo 2n keeps the angle accurate on long lines
+        const long long k2 = (static_cast<long long>(k) * k) % (2 * n);
+        w[k] = std::polar(Real(1.0), Real(sign * M_PI * k2 / n));
+        x[k] = a[k] * w[k];
+    }
+    c[0] = std::conj(w[0]);
+    for(int k = 1; k < n; k++)
+    {
+        c[k] = c[m - k] = std::conj(w[k]);
+    }
+
+    fft(x, -1);
+    fft(c, -1);
+    for(int i = 0; i < m; i++)
+    {
+        x[i] *= c[i];
+    }
+    fft(x, 1);
+
+    for(int k = 0; k < n; k++)
+    {
+        a[k] = w[k] * x[k] / Real(m);
+    }
+}
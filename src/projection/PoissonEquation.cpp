@@ -1,7 +1,10 @@
 #include <AMReX_ParmParse.H>
 #include <AMReX_Vector.H>
 
+#include <MemReport.H>
+#include <PerfLog.H>
 #include <PoissonEquation.H>
+#include <SolverTuning.H>
 #include <projection_F.H>
 
 using namespace amrex;
@@ -28,54 +31,21 @@ PoissonEquation::PoissonEquation(AmrCore* _amrcore,
         amrex::Print() << "Constructing PoissonEquation class" << std::endl;
     }
 
-    // Set AmrCore and ebfactory based on input, fetch some data needed in constructor
-    amrcore = _amrcore; 
-    ebfactory = _ebfactory;
     nghost = _nghost;
-    Vector<Geometry> geom = amrcore->Geom();
-    Vector<BoxArray> grids = amrcore->boxArray();
-    Vector<DistributionMapping> dmap = amrcore->DistributionMap();
-    int max_level = amrcore->maxLevel();
-    
+
     // Whole domain
-    Box domain(geom[0].Domain());
+    Box domain(_amrcore->Geom(0).Domain());
 
     // The boundary conditions need only be set at level 0
     set_ppe_bc(bc_lo, bc_hi,
-               domain.loVect(), domain.hiVect(),
+               BL_TO_FORTRAN_BOX(domain),
 			   &nghost,
                bc_ilo[0]->dataPtr(), bc_ihi[0]->dataPtr(),
                bc_jlo[0]->dataPtr(), bc_jhi[0]->dataPtr(),
                bc_klo[0]->dataPtr(), bc_khi[0]->dataPtr());
 
-    // Resize and reset sigma
-    sigma.resize(max_level + 1);
-    for(int lev = 0; lev <= max_level; lev++)
-    {
-        sigma[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost, 
-                                      MFInfo(), *(*ebfactory)[lev]));
-    }
-
-	// First define the matrix.
-    // Class MLNodeLaplacian describes the following operator:
-    //
-    //       del dot (sigma grad) phi = rhs,
-    //
-    // where phi and rhs are nodal, and sigma is cell-centered
-	LPInfo info;
-	info.setMaxCoarseningLevel(mg_max_coarsening_level);
-
-    matrix.define(geom, grids, dmap, info, GetVecOfConstPtrs(*ebfactory));
-
-    matrix.setGaussSeidel(true);
-    matrix.setHarmonicAverage(false);
-
-	// LinOpBCType Definitions are in amrex/Src/Boundary/AMReX_LO_BCTYPES.H
-	matrix.setDomainBC
-    (
-        {(LinOpBCType) bc_lo[0], (LinOpBCType) bc_lo[1], (LinOpBCType) bc_lo[2]},
-        {(LinOpBCType) bc_hi[0], (LinOpBCType) bc_hi[1], (LinOpBCType) bc_hi[2]}
-    );
+    // Allocate sigma and define the matrix
+    updateInternals(_amrcore, _ebfactory);
 }
 
 PoissonEquation::~PoissonEquation()
@@ -93,18 +63,93 @@ void PoissonEquation::readParameters()
     pp.query("mg_cg_maxiter", mg_cg_maxiter);
     pp.query("mg_max_fmg_iter", mg_max_fmg_iter);
     pp.query("mg_max_coarsening_level", mg_max_coarsening_level);
+    pp.query("mg_pre_smooth", mg_pre_smooth);
+    pp.query("mg_post_smooth", mg_post_smooth);
+    pp.query("mg_agglomeration", mg_agglomeration);
     pp.query("mg_rtol", mg_rtol);
     pp.query("mg_atol", mg_atol);
     pp.query( "bottom_solver_type", bottom_solver_type);
+    pp.query("use_fft", use_fft);
 }
 
 void PoissonEquation::updateInternals(AmrCore* amrcore_in, 
                                       Vector<std::unique_ptr<EBFArrayBoxFactory>>* ebfactory_in)
 {
-    // This must be implemented when we want dynamic meshing
+    // Set AmrCore and ebfactory based on input
+    amrcore = amrcore_in; 
+    ebfactory = ebfactory_in;
+    Vector<BoxArray> grids = amrcore->boxArray();
+    Vector<DistributionMapping> dmap = amrcore->DistributionMap();
+    int max_level = amrcore->maxLevel();
+
+    // Resize and reset sigma
+    sigma.resize(max_level + 1);
+    for(int lev = 0; lev <= max_level; lev++)
+    {
+        sigma[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost, 
+                                      MFInfo(), *(*ebfactory)[lev]));
+    }
+
+    defineMatrix();
+}
+
+//
+// The operator makes the EB factories of its coarse levels, and the nodal EB operator
+// integrates over the cut cells, when it is defined: both are done again for a moved EB
+//
+void PoissonEquation::updateEB()
+{
+    BL_PROFILE("PoissonEquation::updateEB()");
+
+    defineMatrix();
+}
+
+void PoissonEquation::defineMatrix()
+{
+    Vector<Geometry> geom = amrcore->Geom();
+    Vector<BoxArray> grids = amrcore->boxArray();
+    Vector<DistributionMapping> dmap = amrcore->DistributionMap();
+
+	// First define the matrix.
+    // Class MLNodeLaplacian describes the following operator:
+    //
+    //       del dot (sigma grad) phi = rhs,
     //
-    amrex::Print() << "ERROR: PoissonEquation::updateInternals() not yet implemented" << std::endl;
-    amrex::Abort(); 
+    // where phi and rhs are nodal, and sigma is cell-centered
+	LPInfo info;
+	info.setMaxCoarseningLevel(mg_max_coarsening_level);
+    info.setAgglomeration(mg_agglomeration);
+
+    // The EB node Laplacian has no metric terms, and there is no EB in RZ coordinates:
+    // the plain one weights its stencil and divergence by r
+    if(geom[0].IsRZ())
+    {
+        matrix.reset(new MLNodeLaplacian(geom, grids, dmap, info));
+        matrix->setRZCorrection(geom[0].IsRZ());
+    }
+    else
+    {
+        matrix.reset(new MLNodeLaplacian(geom, grids, dmap, info, GetVecOfConstPtrs(*ebfactory)));
+    }
+
+    if(use_fft && FFTPoisson::applies(*amrcore, *(*ebfactory)[0]))
+    {
+        fft.reset(new FFTPoisson(geom[0], IndexType::TheNodeType()));
+    }
+    else
+    {
+        fft.reset();
+    }
+
+    matrix->setGaussSeidel(true);
+    matrix->setHarmonicAverage(false);
+
+	// LinOpBCType Definitions are in amrex/Src/Boundary/AMReX_LO_BCTYPES.H
+	matrix->setDomainBC
+    (
+        {AMREX_D_DECL((LinOpBCType) bc_lo[0], (LinOpBCType) bc_lo[1], (LinOpBCType) bc_lo[2])},
+        {AMREX_D_DECL((LinOpBCType) bc_hi[0], (LinOpBCType) bc_hi[1], (LinOpBCType) bc_hi[2])}
+    );
 }
 
 // 
@@ -118,7 +163,7 @@ void PoissonEquation::setSolverSettings(MLMG& solver)
     {
        solver.setBottomSolver(MLMG::BottomSolver::smoother);
     }
-    else if (bottom_solver_type == "bicg")
+    else if (bottom_solver_type == "bicg" || bottom_solver_type == "bicgstab")
     {
        solver.setBottomSolver(MLMG::BottomSolver::bicgstab);
     }
@@ -144,6 +189,13 @@ void PoissonEquation::setSolverSettings(MLMG& solver)
 	solver.setMaxFmgIter(mg_max_fmg_iter);
 	solver.setCGMaxIter(mg_cg_maxiter);
 
+    // Trial solves of the solver tuning may not converge
+    solver.setThrowException(SolverTuning::inTrial());
+
+    // Smoothing sweeps on the way down and up the V-cycle
+    solver.setPreSmooth(mg_pre_smooth);
+    solver.setPostSmooth(mg_post_smooth);
+
     // Verbosity for MultiGrid / ConjugateGradients
 	solver.setVerbose(mg_verbose);
 	solver.setCGVerbose(mg_cg_verbose);
@@ -152,6 +204,14 @@ void PoissonEquation::setSolverSettings(MLMG& solver)
 	solver.setFinalFillBC(true);
 }
 
+void PoissonEquation::accountMemory() const
+{
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        MemReport::add("solver", "nodal_sigma", lev, *sigma[lev]);
+    }
+}
+
 //
 // Solve Poisson Equation:
 //
@@ -163,26 +223,151 @@ void PoissonEquation::solve(Vector<std::unique_ptr<MultiFab>>& phi,
 			                Vector<std::unique_ptr<MultiFab>>& fluxes,
                             const Vector<std::unique_ptr<MultiFab>>& ro, 
                             const Vector<std::unique_ptr<MultiFab>>& divu)
+{
+    Real ro0 = 1.0;
+    if(fft && FFTPoisson::isConstant(*ro[0], ro0))
+    {
+        fftSolve(phi, fluxes, 1.0 / ro0, divu);
+        return;
+    }
+
+    if(SolverTuning::needsTuning("projection"))
+    {
+        tune(phi, fluxes, ro, divu);
+    }
+
+    doSolve(phi, fluxes, ro, divu);
+}
+
+SolverTuning::Result PoissonEquation::doSolve(Vector<std::unique_ptr<MultiFab>>& phi,
+                                              Vector<std::unique_ptr<MultiFab>>& fluxes,
+                                              const Vector<std::unique_ptr<MultiFab>>& ro,
+                                              const Vector<std::unique_ptr<MultiFab>>& divu)
 {
     for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
     {
         // Set the coefficients to equal 1 / ro 
         sigma[lev]->setVal(1.0);
         MultiFab::Divide(*sigma[lev], *ro[lev], 0, 0, 1, nghost);
-        matrix.setSigma(lev, *sigma[lev]);
+        matrix->setSigma(lev, *sigma[lev]);
 
         // By this point we must have filled the Dirichlet values of phi in ghost cells
-        matrix.setLevelBC(lev, GetVecOfConstPtrs(phi)[lev]);
+        matrix->setLevelBC(lev, GetVecOfConstPtrs(phi)[lev]);
     }
 
     // Set up the solver
-	MLMG solver(matrix);
+	MLMG solver(*matrix);
     setSolverSettings(solver);
 
     // Solve!
 	solver.solve(GetVecOfPtrs(phi), GetVecOfConstPtrs(divu), mg_rtol, mg_atol);
+    PerfLog::addSolve("nodal_projection", solver.getNumIters(), solver.getFinalResidual());
 
     // Get fluxes (grad(phi) / rho)
     solver.getFluxes(amrex::GetVecOfPtrs(fluxes));
+
+#if (AMREX_SPACEDIM == 2)
+    // Only the in-plane components are filled: there is no pressure gradient in z
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        fluxes[lev]->setVal(0.0, 2, 1, fluxes[lev]->nGrow());
+    }
+#endif
+
+    return {solver.getNumIters(), solver.getFinalResidual()};
+}
+
+//
+// Direct solve on a single fully periodic level with constant sigma = 1 / ro:
+// the FFT solver inverts the stencil of MLNodeLaplacian, and fluxes are -sigma grad(phi)
+// averaged to the cell centres, as returned by MLMG::getFluxes
+//
+void PoissonEquation::fftSolve(Vector<std::unique_ptr<MultiFab>>& phi,
+                               Vector<std::unique_ptr<MultiFab>>& fluxes,
+                               Real sigma,
+                               const Vector<std::unique_ptr<MultiFab>>& divu)
+{
+    BL_PROFILE("PoissonEquation::fftSolve()");
+
+    fft->solve(*phi[0], *divu[0], sigma);
+
+    const Real* dx = amrcore->Geom(0).CellSize();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for(MFIter mfi(*fluxes[0], true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& p = phi[0]->array(mfi);
+        const auto& f = fluxes[0]->array(mfi);
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+#if (AMREX_SPACEDIM == 3)
+            f(i, j, k, 0) = -sigma * 0.25 / dx[0] *
+                ( p(i+1, j  , k  ) - p(i  , j  , k  ) + p(i+1, j+1, k  ) - p(i  , j+1, k  )
+                + p(i+1, j  , k+1) - p(i  , j  , k+1) + p(i+1, j+1, k+1) - p(i  , j+1, k+1));
+            f(i, j, k, 1) = -sigma * 0.25 / dx[1] *
+                ( p(i  , j+1, k  ) - p(i  , j  , k  ) + p(i+1, j+1, k  ) - p(i+1, j  , k  )
+                + p(i  , j+1, k+1) - p(i  , j  , k+1) + p(i+1, j+1, k+1) - p(i+1, j  , k+1));
+            f(i, j, k, 2) = -sigma * 0.25 / dx[2] *
+                ( p(i  , j  , k+1) - p(i  , j  , k  ) + p(i+1, j  , k+1) - p(i+1, j  , k  )
+                + p(i  , j+1, k+1) - p(i  , j+1, k  ) + p(i+1, j+1, k+1) - p(i+1, j+1, k  ));
+#else
+            f(i, j, k, 0) = -sigma * 0.5 / dx[0] *
+                (p(i+1, j  , k) - p(i  , j  , k) + p(i+1, j+1, k) - p(i  , j+1, k));
+            f(i, j, k, 1) = -sigma * 0.5 / dx[1] *
+                (p(i  , j+1, k) - p(i  , j  , k) + p(i+1, j+1, k) - p(i+1, j  , k));
+            f(i, j, k, 2) = 0.0;
+#endif
+        }
+    }
+
+    fluxes[0]->FillBoundary(amrcore->Geom(0).periodicity());
+}
+
+void PoissonEquation::tune(Vector<std::unique_ptr<MultiFab>>& phi,
+                           Vector<std::unique_ptr<MultiFab>>& fluxes,
+                           const Vector<std::unique_ptr<MultiFab>>& ro,
+                           const Vector<std::unique_ptr<MultiFab>>& divu)
+{
+    // phi holds the initial guess and the Dirichlet values, and is overwritten by every solve
+    Vector<std::unique_ptr<MultiFab>> phi0(phi.size());
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        phi0[lev].reset(new MultiFab(phi[lev]->boxArray(), phi[lev]->DistributionMap(),
+                                     1, phi[lev]->nGrow()));
+        MultiFab::Copy(*phi0[lev], *phi[lev], 0, 0, 1, phi[lev]->nGrow());
+    }
+
+    SolverTuning::tune("projection",
+                       {bottom_solver_type, mg_max_coarsening_level, mg_pre_smooth, mg_agglomeration},
+                       [&](const SolverTuning::Settings& s)
+                       {
+                           bottom_solver_type = s.bottom_solver;
+                           mg_max_coarsening_level = s.max_coarsening_level;
+                           mg_pre_smooth = mg_post_smooth = s.smooth;
+                           mg_agglomeration = s.agglomeration;
+                           updateInternals(amrcore, ebfactory);
+                       },
+                       [&]()
+                       {
+                           for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+                           {
+                               MultiFab::Copy(*phi[lev], *phi0[lev], 0, 0, 1, phi[lev]->nGrow());
+                           }
+                           return doSolve(phi, fluxes, ro, divu);
+                       });
+
+    for(int lev = 0; lev <= amrcore->finestLevel(); lev++)
+    {
+        MultiFab::Copy(*phi[lev], *phi0[lev], 0, 0, 1, phi[lev]->nGrow());
+    }
 }
 
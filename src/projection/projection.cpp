@@ -27,6 +27,7 @@
 void incflo::ApplyProjection(Real time, Real scaling_factor)
 {
 	BL_PROFILE("incflo::ApplyProjection");
+	PerfLog::Timer perf_timer(PerfLog::nodal_projection);
 
     if(incflo_verbose > 2)
     {
@@ -65,7 +66,7 @@ void incflo::ApplyProjection(Real time, Real scaling_factor)
     fluxes.resize(finest_level + 1);
     for(int lev = 0; lev <= finest_level; lev++)
     {
-        const BoxArray & nd_grids = amrex::convert(grids[lev], IntVect{1,1,1});
+        const BoxArray & nd_grids = amrex::convert(grids[lev], IntVect::TheNodeVector());
         phi[lev].reset(new MultiFab(nd_grids, dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
         phi[lev]->setVal(0.0);
         fluxes[lev].reset(new MultiFab(vel[lev]->boxArray(),
@@ -9,7 +9,7 @@ module projection_mod
    use amrex_fort_module, only: ar => amrex_real
    use iso_c_binding,     only: c_int
 
-   use constant,          only: zero, half, one
+   use constant,          only: zero, half, one, kz
 
    implicit none
    private
@@ -37,10 +37,10 @@ contains
 
       ! Arrays of point-by-point BC types
       integer(c_int), intent(in   )  ::                                 &
-           & bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-           & bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+           & bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
            & bct_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
            & bct_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
@@ -48,7 +48,7 @@ contains
       integer(c_int)                :: bc_face
 
       !
-      ! By default, all the BCs are Neumann
+      ! By default, all the BCs are Neumann (this includes walls and symmetry planes)
       !
       bc_lo    = amrex_lo_neumann
       bc_hi    = amrex_lo_neumann
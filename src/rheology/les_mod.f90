@@ -0,0 +1,92 @@
+module les_module
+
+   use amrex_fort_module, only : rt => amrex_real
+   use iso_c_binding,     only: c_int
+   use constant,          only: zero, half, one, two
+
+   implicit none
+   private
+
+   ! Subgrid-scale models (les_model)
+   integer(c_int), parameter, public :: les_none = 0, les_smagorinsky = 1, &
+                                        les_wale = 2, les_vreman = 3
+
+   public turbulent_viscosity
+
+   ! Below this, the velocity gradient is taken to vanish
+   real(rt), parameter :: tiny_grad = 1.0d-30
+
+contains
+
+   !
+   ! Kinematic turbulent viscosity nu_t of the subgrid-scale model,
+   ! from the velocity gradient g(i,j) = du_i / dx_j and the filter width delta:
+   !
+   !  Smagorinsky:  nu_t = (C delta)^2 |S|,  |S| = sqrt(2 S:S)
+   !
+   !  WALE:         nu_t = (C delta)^2 (Sd:Sd)^(3/2) / ( (S:S)^(5/2) + (Sd:Sd)^(5/4) ),
+   !                with Sd the traceless symmetric part of g^2
+   !
+   !  Vreman:       nu_t = C sqrt( B / (g:g) ),
+   !                with B the second invariant of delta^2 g^T g
+   !
+   ! WALE and Vreman vanish in pure shear and at walls, Smagorinsky does not.
+   !
+   pure real(rt) function turbulent_viscosity(g, delta, model, coef)
+
+      real(rt),       intent(in) :: g(3,3), delta, coef
+      integer(c_int), intent(in) :: model
+
+      real(rt) :: s(3,3), g2(3,3), sd(3,3), b(3,3)
+      real(rt) :: ss, sdsd, gg, trace, bb, denom
+      integer  :: i, j
+
+      turbulent_viscosity = zero
+
+      select case (model)
+
+      case (les_smagorinsky)
+
+         s = half * (g + transpose(g))
+         ss = sum(s * s)
+         turbulent_viscosity = (coef * delta)**2 * sqrt(two * ss)
+
+      case (les_wale)
+
+         s = half * (g + transpose(g))
+         ss = sum(s * s)
+
+         g2 = matmul(g, g)
+         trace = g2(1,1) + g2(2,2) + g2(3,3)
+         sd = half * (g2 + transpose(g2))
+         do i = 1, 3
+            sd(i,i) = sd(i,i) - trace / 3.0d0
+         end do
+         sdsd = sum(sd * sd)
+
+         denom = ss**2.5d0 + sdsd**1.25d0
+         if (denom > tiny_grad) then
+            turbulent_viscosity = (coef * delta)**2 * sdsd**1.5d0 / denom
+         end if
+
+      case (les_vreman)
+
+         gg = sum(g * g)
+         if (gg > tiny_grad) then
+            ! b_ij = delta^2 sum_m alpha_mi alpha_mj, with alpha_ij = du_j / dx_i = g(j,i)
+            do j = 1, 3
+               do i = 1, 3
+                  b(i,j) = delta**2 * (g(1,i) * g(1,j) + g(2,i) * g(2,j) + g(3,i) * g(3,j))
+               end do
+            end do
+            bb = b(1,1) * b(2,2) - b(1,2)**2 &
+               + b(1,1) * b(3,3) - b(1,3)**2 &
+               + b(2,2) * b(3,3) - b(2,3)**2
+            turbulent_viscosity = coef * sqrt(max(bb, zero) / gg)
+         end if
+
+      end select
+
+   end function turbulent_viscosity
+
+end module les_module
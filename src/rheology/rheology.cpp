@@ -19,14 +19,24 @@ void incflo::ComputeViscosity()
             // Tilebox
             Box bx = mfi.tilebox();
 
+            const EBFArrayBox& vel_fab = static_cast<EBFArrayBox const&>((*vel[lev])[mfi]);
+            TileCost::Timer tile_timer(TileCost::viscosity, lev, mfi, vel_fab.getEBCellFlagFab());
+
             const auto& strainrate_arr = strainrate[lev]->array(mfi);
             const auto& viscosity_arr = eta[lev]->array(mfi);
+            const auto& nu_t_arr = nu_t[lev]->array(mfi);
+            const auto& ro_arr = ro[lev]->array(mfi);
+
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
 
-            for(int i = bx.smallEnd(0); i<= bx.bigEnd(0); i++)
-            for(int j = bx.smallEnd(1); j<= bx.bigEnd(1); j++)
-            for(int k = bx.smallEnd(2); k<= bx.bigEnd(2); k++)
+            for(int i = lo.x; i<= hi.x; i++)
+            for(int j = lo.y; j<= hi.y; j++)
+            for(int k = lo.z; k<= hi.z; k++)
             {
-                viscosity_arr(i,j,k) = viscosity(strainrate_arr(i,j,k));
+                // Laminar (rheology) plus turbulent viscosity (zero without LES)
+                viscosity_arr(i,j,k) = viscosity(strainrate_arr(i,j,k))
+                                     + ro_arr(i,j,k) * nu_t_arr(i,j,k);
             }
         }
     }
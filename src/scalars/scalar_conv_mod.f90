@@ -0,0 +1,472 @@
+!
+!
+!  This module contains the subroutines to compute the convection term
+!  - div(u^MAC s) of the passive scalars.
+!
+!  All the scalars are done in one call: the face fluxes of every component
+!  are built from the same (already projected) MAC velocities, and the EB
+!  divergence is taken for all of them at once.
+!
+!
+module scalar_conv_mod
+
+   use amrex_error_module, only: amrex_abort
+   use amrex_fort_module,  only: ar => amrex_real
+   use iso_c_binding ,     only: c_int
+
+   use bc,                 only: minf_, nsw_, sym_, pinf_, pout_
+   use constant,           only: zero, half, one, kz, rz, r_lo
+
+   implicit none
+   private
+
+   public compute_scalar_conv, compute_scalar_conv_eb
+
+contains
+
+   !#####################################################
+
+   !  MAC VERSION (no cut cells in the tile)
+
+   !#####################################################
+   subroutine compute_scalar_conv(lo, hi, nscal, &
+                                  conv, clo, chi, &
+                                  s, sclo, schi, &
+                                  u, ulo, uhi, &
+                                  v, vlo, vhi, &
+                                  w, wlo, whi, &
+                                  xslopes, yslopes, zslopes, slo, shi, &
+                                  domlo, domhi, &
+                                  bc_ilo, bc_ihi, &
+                                  bc_jlo, bc_jhi, &
+                                  bc_klo, bc_khi, dx, ng) bind(C)
+
+      ! Tile bounds
+      integer(c_int),  intent(in   ) :: lo(3),  hi(3)
+
+      ! Number of scalars
+      integer(c_int),  intent(in   ) :: nscal
+
+      ! Array Bounds
+      integer(c_int),  intent(in   ) :: clo(3), chi(3)
+      integer(c_int),  intent(in   ) :: sclo(3), schi(3)
+      integer(c_int),  intent(in   ) :: slo(3), shi(3)
+      integer(c_int),  intent(in   ) :: ulo(3), uhi(3)
+      integer(c_int),  intent(in   ) :: vlo(3), vhi(3)
+      integer(c_int),  intent(in   ) :: wlo(3), whi(3)
+      integer(c_int),  intent(in   ) :: domlo(3), domhi(3), ng
+
+      ! Grid
+      real(ar),        intent(in   ) :: dx(3)
+
+      ! Arrays
+      real(ar),        intent(in   ) ::                            &
+           & s(sclo(1):schi(1),sclo(2):schi(2),sclo(3):schi(3),nscal), &
+           & xslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & yslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & zslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & u(ulo(1):uhi(1),ulo(2):uhi(2),ulo(3):uhi(3)), &
+           & v(vlo(1):vhi(1),vlo(2):vhi(2),vlo(3):vhi(3)), &
+           & w(wlo(1):whi(1),wlo(2):whi(2),wlo(3):whi(3))
+
+      real(ar),        intent(  out) ::                           &
+           & conv(clo(1):chi(1),clo(2):chi(2),clo(3):chi(3),nscal)
+
+      ! BC types
+      integer(c_int), intent(in   ) ::  &
+           & bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
+           & bc_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
+
+      ! Convective fluxes on the faces of the tile: each face is visited once
+      real(ar) :: fx(lo(1):hi(1)+1,lo(2):hi(2)  ,lo(3):hi(3)  ,nscal)
+      real(ar) :: fy(lo(1):hi(1)  ,lo(2):hi(2)+1,lo(3):hi(3)  ,nscal)
+      real(ar) :: fz(lo(1):hi(1)  ,lo(2):hi(2)  ,lo(3):hi(3)+1,nscal)
+
+      ! Local variables
+      integer(c_int)                 :: i, j, k, n
+      real(ar)                       :: idx, idy, idz, divumac
+      real(ar)                       :: r_c, r_w, r_e
+
+      idx = one / dx(1)
+      idy = one / dx(2)
+      idz = zero
+      if (kz > 0) idz = one / dx(3)
+
+      ! Radii of the cell centre and of the x faces (see compute_ugradu)
+      r_c = one
+      r_w = one
+      r_e = one
+
+      call compute_scalar_fluxes(lo, hi, 0, nscal, &
+                                 s, sclo, schi, &
+                                 u, ulo, uhi, &
+                                 v, vlo, vhi, &
+                                 w, wlo, whi, &
+                                 xslopes, yslopes, zslopes, slo, shi, &
+                                 fx, fy, fz, &
+                                 domlo, domhi, &
+                                 bc_ilo, bc_ihi, &
+                                 bc_jlo, bc_jhi, &
+                                 bc_klo, bc_khi, ng)
+
+      ! ****************************************************
+      ! Define convective terms -- conservatively
+      !   conv = - ( div(u^MAC s) - s div(u^MAC) )
+      ! ****************************************************
+      do n = 1, nscal
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+
+                  if (rz) then
+                     r_w = r_lo + i * dx(1)
+                     r_e = r_w + dx(1)
+                     r_c = r_w + half * dx(1)
+                  end if
+
+                  divumac = (r_e * u(i+1,j,k) - r_w * u(i,j,k)) * idx / r_c + &
+                            (v(i,j+1,k) - v(i,j,k)) * idy + &
+                            (w(i,j,k+kz) - w(i,j,k)) * idz
+
+                  conv(i,j,k,n) = - ( (r_e * fx(i+1,j,k,n) - r_w * fx(i,j,k,n)) * idx / r_c + &
+                                      (fy(i,j+1,k,n) - fy(i,j,k,n)) * idy + &
+                                      (fz(i,j,k+kz,n) - fz(i,j,k,n)) * idz - &
+                                      s(i,j,k,n) * divumac )
+
+               end do
+            end do
+         end do
+      end do
+
+   end subroutine compute_scalar_conv
+
+   !#####################################################
+
+   !  EB VERSION
+
+   !#####################################################
+   subroutine compute_scalar_conv_eb(lo, hi, nscal, &
+                                     conv, clo, chi, &
+                                     s, sclo, schi, &
+                                     u, ulo, uhi, &
+                                     v, vlo, vhi, &
+                                     w, wlo, whi, &
+                                     afrac_x, axlo, axhi, &
+                                     afrac_y, aylo, ayhi, &
+                                     afrac_z, azlo, azhi, &
+                                     cent_x,  cxlo, cxhi, &
+                                     cent_y,  cylo, cyhi, &
+                                     cent_z,  czlo, czhi, &
+                                     flags,    flo,  fhi, &
+                                     vfrac,   vflo, vfhi, &
+                                     bcent,    blo,  bhi, &
+                                     xslopes, yslopes, zslopes, slo, shi, &
+                                     domlo, domhi, &
+                                     bc_ilo, bc_ihi, &
+                                     bc_jlo, bc_jhi, &
+                                     bc_klo, bc_khi, dx, ng) bind(C)
+
+      use divop_mod, only: compute_divop
+
+      ! Tile bounds
+      integer(c_int),  intent(in   ) :: lo(3),  hi(3)
+
+      ! Number of scalars
+      integer(c_int),  intent(in   ) :: nscal
+
+      ! Array Bounds
+      integer(c_int),  intent(in   ) :: clo(3), chi(3)
+      integer(c_int),  intent(in   ) :: sclo(3), schi(3)
+      integer(c_int),  intent(in   ) :: slo(3), shi(3)
+      integer(c_int),  intent(in   ) :: ulo(3), uhi(3)
+      integer(c_int),  intent(in   ) :: vlo(3), vhi(3)
+      integer(c_int),  intent(in   ) :: wlo(3), whi(3)
+      integer(c_int),  intent(in   ) :: axlo(3), axhi(3)
+      integer(c_int),  intent(in   ) :: aylo(3), ayhi(3)
+      integer(c_int),  intent(in   ) :: azlo(3), azhi(3)
+      integer(c_int),  intent(in   ) :: cxlo(3), cxhi(3)
+      integer(c_int),  intent(in   ) :: cylo(3), cyhi(3)
+      integer(c_int),  intent(in   ) :: czlo(3), czhi(3)
+      integer(c_int),  intent(in   ) ::  flo(3),  fhi(3)
+      integer(c_int),  intent(in   ) :: vflo(3), vfhi(3)
+      integer(c_int),  intent(in   ) ::  blo(3),  bhi(3)
+      integer(c_int),  intent(in   ) :: domlo(3), domhi(3), ng
+
+      ! Grid
+      real(ar),        intent(in   ) :: dx(3)
+
+      ! Arrays
+      real(ar),        intent(in   ) ::                            &
+           & s(sclo(1):schi(1),sclo(2):schi(2),sclo(3):schi(3),nscal), &
+           & xslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & yslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & zslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & u(ulo(1):uhi(1),ulo(2):uhi(2),ulo(3):uhi(3)), &
+           & v(vlo(1):vhi(1),vlo(2):vhi(2),vlo(3):vhi(3)), &
+           & w(wlo(1):whi(1),wlo(2):whi(2),wlo(3):whi(3)), &
+           & afrac_x(axlo(1):axhi(1),axlo(2):axhi(2),axlo(3):axhi(3)), &
+           & afrac_y(aylo(1):ayhi(1),aylo(2):ayhi(2),aylo(3):ayhi(3)), &
+           & afrac_z(azlo(1):azhi(1),azlo(2):azhi(2),azlo(3):azhi(3)), &
+           & cent_x(cxlo(1):cxhi(1),cxlo(2):cxhi(2),cxlo(3):cxhi(3),2),&
+           & cent_y(cylo(1):cyhi(1),cylo(2):cyhi(2),cylo(3):cyhi(3),2),&
+           & cent_z(czlo(1):czhi(1),czlo(2):czhi(2),czlo(3):czhi(3),2),&
+           & vfrac(vflo(1):vfhi(1),vflo(2):vfhi(2),vflo(3):vfhi(3)), &
+           & bcent(blo(1):bhi(1),blo(2):bhi(2),blo(3):bhi(3),3)
+
+      real(ar),        intent(  out) ::                           &
+           & conv(clo(1):chi(1),clo(2):chi(2),clo(3):chi(3),nscal)
+
+      ! BC types
+      integer(c_int), intent(in   ) ::  &
+           & bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
+           & bc_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
+           & flags(flo(1):fhi(1),flo(2):fhi(2),flo(3):fhi(3))
+
+      ! Temporary array to handle convective fluxes at the cell faces (staggered)
+      ! Just reserve space for the tile + 3 ghost layers
+      integer, parameter :: nh = 3 ! Number of Halo layers
+      real(ar) :: fx(lo(1)-nh:hi(1)+nh+1,lo(2)-nh:hi(2)+nh  ,lo(3)-nh:hi(3)+nh  ,nscal)
+      real(ar) :: fy(lo(1)-nh:hi(1)+nh  ,lo(2)-nh:hi(2)+nh+1,lo(3)-nh:hi(3)+nh  ,nscal)
+      real(ar) :: fz(lo(1)-nh:hi(1)+nh  ,lo(2)-nh:hi(2)+nh  ,lo(3)-nh:hi(3)+nh+1,nscal)
+
+      integer(c_int)  :: fxlo(3), fxhi(3), fylo(3), fyhi(3), fzlo(3), fzhi(3)
+      integer         :: i, j, k, n
+
+      ! Check number of ghost cells
+      if (ng < 5) call amrex_abort( "compute_scalar_conv_eb(): ng must be >= 5")
+
+      fxlo = lo - nh
+      fylo = lo - nh
+      fzlo = lo - nh
+
+      fxhi = hi + nh + [1,0,0]
+      fyhi = hi + nh + [0,1,0]
+      fzhi = hi + nh + [0,0,1]
+
+      !
+      ! First compute the convective fluxes at the face center
+      ! Do this on ALL faces on the tile, i.e. INCLUDE as many ghost faces as
+      ! possible
+      !
+      call compute_scalar_fluxes(lo, hi, nh, nscal, &
+                                 s, sclo, schi, &
+                                 u, ulo, uhi, &
+                                 v, vlo, vhi, &
+                                 w, wlo, whi, &
+                                 xslopes, yslopes, zslopes, slo, shi, &
+                                 fx, fy, fz, &
+                                 domlo, domhi, &
+                                 bc_ilo, bc_ihi, &
+                                 bc_jlo, bc_jhi, &
+                                 bc_klo, bc_khi, ng, &
+                                 afrac_x(fxlo(1):fxhi(1),fxlo(2):fxhi(2),fxlo(3):fxhi(3)), &
+                                 afrac_y(fylo(1):fyhi(1),fylo(2):fyhi(2),fylo(3):fyhi(3)), &
+                                 afrac_z(fzlo(1):fzhi(1),fzlo(2):fzhi(2),fzlo(3):fzhi(3)))
+
+      ! Divergence of all the scalar fluxes with the EB algorithm
+      call compute_divop(lo, hi, nscal, &
+                         conv, clo, chi, &
+                         s, sclo, schi, &
+                         fx, fxlo, fxhi, &
+                         fy, fylo, fyhi, &
+                         fz, fzlo, fzhi, &
+                         afrac_x, axlo, axhi, &
+                         afrac_y, aylo, ayhi, &
+                         afrac_z, azlo, azhi, &
+                         cent_x, cxlo, cxhi, &
+                         cent_y, cylo, cyhi, &
+                         cent_z, czlo, czhi, &
+                         flags, flo, fhi, &
+                         vfrac, vflo, vfhi, &
+                         bcent, blo, bhi, &
+                         domlo, domhi, &
+                         dx, ng )
+
+      ! Return the negative
+      do n = 1, nscal
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  conv(i,j,k,n) = - conv(i,j,k,n)
+               end do
+            end do
+         end do
+      end do
+
+   end subroutine compute_scalar_conv_eb
+
+   !
+   ! Upwind fluxes u^MAC s of all the scalars on the faces of the tile grown by nh.
+   ! At MINF, NSW, PINF and POUT boundaries, the face value is the one held in the
+   ! ghost cell. If the area fractions are given, faces without area get no flux.
+   !
+   subroutine compute_scalar_fluxes(lo, hi, nh, nscal, &
+                                    s, sclo, schi, &
+                                    u, ulo, uhi, &
+                                    v, vlo, vhi, &
+                                    w, wlo, whi, &
+                                    xslopes, yslopes, zslopes, slo, shi, &
+                                    fx, fy, fz, &
+                                    domlo, domhi, &
+                                    bc_ilo, bc_ihi, &
+                                    bc_jlo, bc_jhi, &
+                                    bc_klo, bc_khi, ng, &
+                                    afrac_x, afrac_y, afrac_z)
+
+      integer(c_int),  intent(in   ) :: lo(3), hi(3), nh, nscal
+      integer(c_int),  intent(in   ) :: sclo(3), schi(3), slo(3), shi(3)
+      integer(c_int),  intent(in   ) :: ulo(3), uhi(3), vlo(3), vhi(3), wlo(3), whi(3)
+      integer(c_int),  intent(in   ) :: domlo(3), domhi(3), ng
+
+      real(ar),        intent(in   ) ::                            &
+           & s(sclo(1):schi(1),sclo(2):schi(2),sclo(3):schi(3),nscal), &
+           & xslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & yslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & zslopes(slo(1):shi(1),slo(2):shi(2),slo(3):shi(3),nscal), &
+           & u(ulo(1):uhi(1),ulo(2):uhi(2),ulo(3):uhi(3)), &
+           & v(vlo(1):vhi(1),vlo(2):vhi(2),vlo(3):vhi(3)), &
+           & w(wlo(1):whi(1),wlo(2):whi(2),wlo(3):whi(3))
+
+      real(ar),        intent(  out) ::                                        &
+           & fx(lo(1)-nh:hi(1)+nh+1,lo(2)-nh:hi(2)+nh  ,lo(3)-nh:hi(3)+nh  ,nscal), &
+           & fy(lo(1)-nh:hi(1)+nh  ,lo(2)-nh:hi(2)+nh+1,lo(3)-nh:hi(3)+nh  ,nscal), &
+           & fz(lo(1)-nh:hi(1)+nh  ,lo(2)-nh:hi(2)+nh  ,lo(3)-nh:hi(3)+nh+1,nscal)
+
+      integer(c_int), intent(in   ) ::  &
+           & bc_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+           & bc_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
+           & bc_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
+
+      ! Area fractions on the same faces (EB tiles only)
+      real(ar),        intent(in   ), optional ::                                   &
+           & afrac_x(lo(1)-nh:hi(1)+nh+1,lo(2)-nh:hi(2)+nh  ,lo(3)-nh:hi(3)+nh  ), &
+           & afrac_y(lo(1)-nh:hi(1)+nh  ,lo(2)-nh:hi(2)+nh+1,lo(3)-nh:hi(3)+nh  ), &
+           & afrac_z(lo(1)-nh:hi(1)+nh  ,lo(2)-nh:hi(2)+nh  ,lo(3)-nh:hi(3)+nh+1)
+
+      ! Local variables
+      real(ar)                       :: s_face, spls, smns
+      integer                        :: i, j, k, n
+      logical                        :: is_eb
+      integer, parameter             :: bc_list(5) = [MINF_, NSW_, SYM_, PINF_, POUT_]
+
+      is_eb = present(afrac_x)
+
+      do n = 1, nscal
+
+         !
+         ! ===================   X   ===================
+         !
+         do k = lo(3)-nh, hi(3)+nh
+            do j = lo(2)-nh, hi(2)+nh
+               do i = lo(1)-nh, hi(1)+nh+1
+                  if (is_eb) then
+                     if (afrac_x(i,j,k) <= zero) then
+                        fx(i,j,k,n) = zero
+                        cycle
+                     end if
+                  end if
+                  if ( i <= domlo(1) .and. any(bc_ilo(j,k,1) == bc_list) ) then
+                     s_face = s(domlo(1)-1,j,k,n)
+                  else if ( i >= domhi(1)+1 .and. any(bc_ihi(j,k,1) == bc_list) ) then
+                     s_face = s(domhi(1)+1,j,k,n)
+                  else
+                     spls   = s(i  ,j,k,n) - half * xslopes(i  ,j,k,n)
+                     smns   = s(i-1,j,k,n) + half * xslopes(i-1,j,k,n)
+                     s_face = upwind( smns, spls, u(i,j,k) )
+                  end if
+                  fx(i,j,k,n) = u(i,j,k) * s_face
+               end do
+            end do
+         end do
+
+         !
+         ! ===================   Y   ===================
+         !
+         do k = lo(3)-nh, hi(3)+nh
+            do j = lo(2)-nh, hi(2)+nh+1
+               do i = lo(1)-nh, hi(1)+nh
+                  if (is_eb) then
+                     if (afrac_y(i,j,k) <= zero) then
+                        fy(i,j,k,n) = zero
+                        cycle
+                     end if
+                  end if
+                  if ( j <= domlo(2) .and. any(bc_jlo(i,k,1) == bc_list) ) then
+                     s_face = s(i,domlo(2)-1,k,n)
+                  else if ( j >= domhi(2)+1 .and. any(bc_jhi(i,k,1) == bc_list) ) then
+                     s_face = s(i,domhi(2)+1,k,n)
+                  else
+                     spls   = s(i,j  ,k,n) - half * yslopes(i,j  ,k,n)
+                     smns   = s(i,j-1,k,n) + half * yslopes(i,j-1,k,n)
+                     s_face = upwind( smns, spls, v(i,j,k) )
+                  end if
+                  fy(i,j,k,n) = v(i,j,k) * s_face
+               end do
+            end do
+         end do
+
+         !
+         ! ===================   Z   ===================
+         !
+         ! In 2D there are no z faces: the fluxes are zero
+         if (kz == 0) then
+            fz(:,:,:,n) = zero
+            cycle
+         end if
+
+         do k = lo(3)-nh, hi(3)+nh+1
+            do j = lo(2)-nh, hi(2)+nh
+               do i = lo(1)-nh, hi(1)+nh
+                  if (is_eb) then
+                     if (afrac_z(i,j,k) <= zero) then
+                        fz(i,j,k,n) = zero
+                        cycle
+                     end if
+                  end if
+                  if ( k <= domlo(3) .and. any(bc_klo(i,j,1) == bc_list) ) then
+                     s_face = s(i,j,domlo(3)-1,n)
+                  else if ( k >= domhi(3)+1 .and. any(bc_khi(i,j,1) == bc_list) ) then
+                     s_face = s(i,j,domhi(3)+1,n)
+                  else
+                     spls   = s(i,j,k  ,n) - half * zslopes(i,j,k  ,n)
+                     smns   = s(i,j,k-1,n) + half * zslopes(i,j,k-1,n)
+                     s_face = upwind( smns, spls, w(i,j,k) )
+                  end if
+                  fz(i,j,k,n) = w(i,j,k) * s_face
+               end do
+            end do
+         end do
+
+      end do
+
+   end subroutine compute_scalar_fluxes
+
+   ! Upwind face value
+   function upwind ( smns, spls, uedge ) result (ev)
+
+      ! Small value to protect against tiny velocities used in upwinding
+      real(ar), parameter  :: small_vel = 1.0d-10
+
+      real(ar), intent(in) :: smns, spls, uedge
+      real(ar)             :: ev
+
+      if ( abs(uedge) .lt. small_vel) then
+         ev = half * ( spls + smns )
+      else
+         ev = merge ( smns, spls, uedge >= zero )
+      end if
+
+   end function upwind
+
+end module scalar_conv_mod
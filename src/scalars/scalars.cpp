@@ -0,0 +1,259 @@
+#include <AMReX_EBMultiFabUtil.H>
+#include <AMReX_ParmParse.H>
+
+#include <incflo.H>
+#include <scalars_F.H>
+
+//
+// Read the transported scalars from ParmParse
+//
+//   scalars.names        one name per scalar (none: no scalars)
+//   scalars.diffusivity  one diffusivity per scalar (default 0: no diffusion solve)
+//   scalars.ic           initial values (default 0)
+//   scalars.box_lo/hi    optional box with other initial values, scalars.box_ic
+//   xlo.scalars, ...     Dirichlet values on a domain face (default: zero gradient)
+//
+//   boussinesq.temperature  name of the scalar that drives the buoyancy (default: none)
+//   boussinesq.beta         thermal expansion coefficient
+//   boussinesq.T_ref        reference temperature, at which the buoyancy vanishes
+//
+void incflo::ReadScalarParameters()
+{
+    ParmParse pp("scalars");
+
+    pp.queryarr("names", scal_names);
+    nscal = scal_names.size();
+
+    if(nscal == 0)
+    {
+        return;
+    }
+
+    scal_diff.assign(nscal, 0.0);
+    pp.queryarr("diffusivity", scal_diff);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(scal_diff.size() == nscal,
+                                     "scalars.diffusivity needs one value per scalar");
+
+    scal_ic.assign(nscal, 0.0);
+    pp.queryarr("ic", scal_ic);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(scal_ic.size() == nscal,
+                                     "scalars.ic needs one value per scalar");
+
+    pp.queryarr("box_lo", scal_box_lo);
+    pp.queryarr("box_hi", scal_box_hi);
+    pp.queryarr("box_ic", scal_box_ic);
+    if(!scal_box_lo.empty())
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(scal_box_lo.size() == AMREX_SPACEDIM &&
+                                         scal_box_hi.size() == AMREX_SPACEDIM,
+                                         "scalars.box_lo and scalars.box_hi need one value per direction");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(scal_box_ic.size() == nscal,
+                                         "scalars.box_ic needs one value per scalar");
+    }
+
+    const std::string faces[6] = {"xlo", "xhi", "ylo", "yhi", "zlo", "zhi"};
+    for(int f = 0; f < 6; f++)
+    {
+        ParmParse ppf(faces[f]);
+        ppf.queryarr("scalars", scal_bc_values[f]);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(scal_bc_values[f].empty() || scal_bc_values[f].size() == nscal,
+                                         faces[f] + ".scalars needs one value per scalar");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(scal_bc_values[f].empty() ||
+                                         (f / 2 < AMREX_SPACEDIM && !geom[0].isPeriodic(f / 2)),
+                                         faces[f] + ".scalars given on a periodic face");
+    }
+
+    // Boussinesq buoyancy: the body force is g ( 1 - beta (T - T_ref) )
+    {
+        ParmParse ppb("boussinesq");
+
+        std::string temp_name;
+        if(ppb.query("temperature", temp_name))
+        {
+            for(int n = 0; n < nscal; n++)
+            {
+                if(scal_names[n] == temp_name)
+                {
+                    temp_comp = n;
+                }
+            }
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(temp_comp >= 0,
+                                             "boussinesq.temperature is not one of scalars.names");
+
+            ppb.query("beta", thermal_expansion);
+            ppb.query("T_ref", T_ref);
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(thermal_expansion > 0.0,
+                                             "boussinesq.beta must be positive");
+
+            amrex::Print() << "Boussinesq buoyancy from " << temp_name
+                           << " with beta = " << thermal_expansion
+                           << ", T_ref = " << T_ref << std::endl;
+        }
+    }
+
+    // The scalars are always written in the plot files
+    pltVarCount += nscal;
+
+    if(incflo_verbose > 0)
+    {
+        for(int n = 0; n < nscal; n++)
+        {
+            amrex::Print() << "Transporting scalar " << scal_names[n]
+                           << " with diffusivity " << scal_diff[n] << std::endl;
+        }
+    }
+}
+
+//
+// Set the initial values of the scalars
+//
+void incflo::InitScalars()
+{
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        const Real* dx = geom[lev].CellSize();
+        const Real* plo = geom[lev].ProbLo();
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi(*scal[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            const auto& s = scal[lev]->array(mfi);
+
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+
+            for(int k = lo.z; k <= hi.z; k++)
+            for(int j = lo.y; j <= hi.y; j++)
+            for(int i = lo.x; i <= hi.x; i++)
+            {
+                const Real x[AMREX_SPACEDIM] = {AMREX_D_DECL(plo[0] + (i + 0.5) * dx[0],
+                                                             plo[1] + (j + 0.5) * dx[1],
+                                                             plo[2] + (k + 0.5) * dx[2])};
+
+                bool in_box = !scal_box_lo.empty();
+                for(int d = 0; d < AMREX_SPACEDIM && in_box; d++)
+                {
+                    in_box = (x[d] >= scal_box_lo[d] && x[d] <= scal_box_hi[d]);
+                }
+
+                for(int n = 0; n < nscal; n++)
+                {
+                    s(i,j,k,n) = in_box ? scal_box_ic[n] : scal_ic[n];
+                }
+            }
+        }
+    }
+}
+
+//
+// Compute the convective term of all the scalars: conv_s = - div(u^MAC s)
+//
+// This uses the MAC velocities left by the last call to ComputeUGradU, which are
+// already projected, and the scalars at "time". All the scalars go through a single
+// fillpatch, slope computation and convection kernel per tile.
+//
+void incflo::ComputeScalarConvection(Vector<std::unique_ptr<MultiFab>>& conv_s, Real time)
+{
+	BL_PROFILE("incflo::ComputeScalarConvection");
+
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        Box domain(geom[lev].Domain());
+
+        // Scalars with ghost cells
+        MultiFab Sborder(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]);
+        FillPatchScal(lev, time, Sborder, 0, nscal);
+
+        // Compute the slopes of all the scalars
+        ComputeSlopes(lev, Sborder, *xslopes_scal[lev], *yslopes_scal[lev], *zslopes_scal[lev]);
+
+        // Get EB geometric info
+        Array< const MultiCutFab*,AMREX_SPACEDIM> areafrac;
+        Array< const MultiCutFab*,AMREX_SPACEDIM> facecent;
+        const amrex::MultiFab*                    volfrac;
+        const amrex::MultiCutFab*                 bndrycent;
+
+        areafrac  =   ebfactory[lev] -> getAreaFrac();
+        facecent  =   ebfactory[lev] -> getFaceCent();
+        volfrac   = &(ebfactory[lev] -> getVolFrac());
+        bndrycent = &(ebfactory[lev] -> getBndryCent());
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for(MFIter mfi(Sborder, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            // Tilebox
+            Box bx = mfi.tilebox();
+
+            // this is to check efficiently if this tile contains any eb stuff
+            const EBFArrayBox& s_fab = static_cast<EBFArrayBox const&>(Sborder[mfi]);
+            const EBCellFlagFab& flags = s_fab.getEBCellFlagFab();
+
+            if(flags.getType(amrex::grow(bx, 0)) == FabType::covered)
+            {
+                conv_s[lev]->setVal(1.2345e300, bx, 0, nscal);
+            }
+            else if(flags.getType(amrex::grow(bx, nghost)) == FabType::regular)
+            {
+                // No cut cells in tile + nghost-cell witdh halo -> use non-eb routine
+                compute_scalar_conv(BL_TO_FORTRAN_BOX(bx), &nscal,
+                                    BL_TO_FORTRAN_ANYD((*conv_s[lev])[mfi]),
+                                    BL_TO_FORTRAN_ANYD(Sborder[mfi]),
+                                    BL_TO_FORTRAN_ANYD((*m_u_mac[lev])[mfi]),
+                                    BL_TO_FORTRAN_ANYD((*m_v_mac[lev])[mfi]),
+                                    BL_TO_FORTRAN_ANYD((*m_w_mac[lev])[mfi]),
+                                    (*xslopes_scal[lev])[mfi].dataPtr(),
+                                    (*yslopes_scal[lev])[mfi].dataPtr(),
+                                    BL_TO_FORTRAN_ANYD((*zslopes_scal[lev])[mfi]),
+                                    BL_TO_FORTRAN_BOX(domain),
+                                    bc_ilo[lev]->dataPtr(),
+                                    bc_ihi[lev]->dataPtr(),
+                                    bc_jlo[lev]->dataPtr(),
+                                    bc_jhi[lev]->dataPtr(),
+                                    bc_klo[lev]->dataPtr(),
+                                    bc_khi[lev]->dataPtr(),
+                                    AMREX_ZFILL(geom[lev].CellSize()),
+                                    &nghost);
+            }
+            else
+            {
+#if (AMREX_SPACEDIM == 3)
+                compute_scalar_conv_eb(BL_TO_FORTRAN_BOX(bx), &nscal,
+                                       BL_TO_FORTRAN_ANYD((*conv_s[lev])[mfi]),
+                                       BL_TO_FORTRAN_ANYD(Sborder[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*m_u_mac[lev])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*m_v_mac[lev])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*m_w_mac[lev])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*areafrac[0])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*areafrac[1])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*areafrac[2])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*facecent[0])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*facecent[1])[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*facecent[2])[mfi]),
+                                       BL_TO_FORTRAN_ANYD(flags),
+                                       BL_TO_FORTRAN_ANYD((*volfrac)[mfi]),
+                                       BL_TO_FORTRAN_ANYD((*bndrycent)[mfi]),
+                                       (*xslopes_scal[lev])[mfi].dataPtr(),
+                                       (*yslopes_scal[lev])[mfi].dataPtr(),
+                                       BL_TO_FORTRAN_ANYD((*zslopes_scal[lev])[mfi]),
+                                       domain.loVect(),
+                                       domain.hiVect(),
+                                       bc_ilo[lev]->dataPtr(),
+                                       bc_ihi[lev]->dataPtr(),
+                                       bc_jlo[lev]->dataPtr(),
+                                       bc_jhi[lev]->dataPtr(),
+                                       bc_klo[lev]->dataPtr(),
+                                       bc_khi[lev]->dataPtr(),
+                                       geom[lev].CellSize(),
+                                       &nghost);
+#else
+                amrex::Abort("ComputeScalarConvection: cut cells are only supported in 3D");
+#endif
+            }
+        }
+    }
+}
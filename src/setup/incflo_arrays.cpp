@@ -34,6 +34,10 @@ void incflo::AllocateArrays(int lev)
 	strainrate[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
 	strainrate[lev]->setVal(0.);
 
+	// Turbulent (subgrid-scale) viscosity
+	nu_t[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
+	nu_t[lev]->setVal(0.);
+
 	// Vorticity
 	vort[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
 	vort[lev]->setVal(0.);
@@ -62,11 +66,32 @@ void incflo::AllocateArrays(int lev)
 	zslopes[lev].reset(new MultiFab(grids[lev], dmap[lev], 3, nghost, MFInfo(), *ebfactory[lev]));
 	zslopes[lev]->setVal(0.);
 
+    // Passive scalars, their convective terms and slopes
+    if(nscal > 0)
+    {
+        scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        scal_o[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        scal[lev]->setVal(0.);
+        scal_o[lev]->setVal(0.);
+
+        conv_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, 0, MFInfo(), *ebfactory[lev]));
+        conv_scal_old[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, 0, MFInfo(), *ebfactory[lev]));
+        conv_scal[lev]->setVal(0.);
+        conv_scal_old[lev]->setVal(0.);
+
+        xslopes_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        yslopes_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        zslopes_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        xslopes_scal[lev]->setVal(0.);
+        yslopes_scal[lev]->setVal(0.);
+        zslopes_scal[lev]->setVal(0.);
+    }
+
 	// ********************************************************************************
 	// Node-based arrays
 	// ********************************************************************************
 
-    const BoxArray & nd_grids = amrex::convert(grids[lev], IntVect{1,1,1});
+    const BoxArray & nd_grids = amrex::convert(grids[lev], IntVect::TheNodeVector());
 
     // Pressure
     p0[lev].reset(new MultiFab(nd_grids, dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
@@ -94,11 +119,18 @@ void incflo::AllocateArrays(int lev)
 	m_v_mac[lev].reset(new MultiFab(y_edge_ba, dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
 	m_v_mac[lev]->setVal(0.);
 
-	// Create a BoxArray on y-faces.
+	// Create a BoxArray on z-faces. There are none in 2D, where w_mac
+	// is a cell-centred array of zeros, i.e. there is no flux in z.
     BoxArray z_edge_ba = grids[lev];
+#if (AMREX_SPACEDIM == 3)
     z_edge_ba.surroundingNodes(2);
+#endif
 	m_w_mac[lev].reset(new MultiFab(z_edge_ba, dmap[lev], 1, nghost, MFInfo(), *ebfactory[lev]));
 	m_w_mac[lev]->setVal(0.);
+
+	// Velocity of the EB walls
+	eb_vel[lev].reset(new MultiFab(grids[lev], dmap[lev], 3, nghost, MFInfo(), *ebfactory[lev]));
+	eb_vel[lev]->setVal(0.);
 }
 
 void incflo::RegridArrays(int lev)
@@ -165,6 +197,12 @@ void incflo::RegridArrays(int lev)
 	strainrate[lev] = std::move(strainrate_new);
 	strainrate[lev]->setVal(0.);
 
+	// Turbulent viscosity
+	std::unique_ptr<MultiFab> nu_t_new(new MultiFab(grids[lev], dmap[lev], 1, nghost,
+                                                    MFInfo(), *ebfactory[lev]));
+	nu_t[lev] = std::move(nu_t_new);
+	nu_t[lev]->setVal(0.);
+
 	// Vorticity
 	std::unique_ptr<MultiFab> vort_new(new MultiFab(grids[lev], dmap[lev], 1, nghost,
                                                     MFInfo(), *ebfactory[lev]));
@@ -211,12 +249,40 @@ void incflo::RegridArrays(int lev)
     zslopes[lev] = std::move(zslopes_new);
     zslopes[lev] -> setVal(0.);
 
+    // Passive scalars: the state is copied, the rest is recomputed every time step
+    if(nscal > 0)
+    {
+        std::unique_ptr<MultiFab> scal_new(new MultiFab(grids[lev], dmap[lev], nscal, nghost,
+                                                        MFInfo(), *ebfactory[lev]));
+        scal_new->setVal(0.);
+        scal_new->copy(*scal[lev], 0, 0, nscal, 0, nghost);
+        scal[lev] = std::move(scal_new);
+
+        std::unique_ptr<MultiFab> scal_o_new(new MultiFab(grids[lev], dmap[lev], nscal, nghost,
+                                                          MFInfo(), *ebfactory[lev]));
+        scal_o_new->setVal(0.);
+        scal_o_new->copy(*scal_o[lev], 0, 0, nscal, 0, nghost);
+        scal_o[lev] = std::move(scal_o_new);
+
+        conv_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, 0, MFInfo(), *ebfactory[lev]));
+        conv_scal_old[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, 0, MFInfo(), *ebfactory[lev]));
+        conv_scal[lev]->setVal(0.);
+        conv_scal_old[lev]->setVal(0.);
+
+        xslopes_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        yslopes_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        zslopes_scal[lev].reset(new MultiFab(grids[lev], dmap[lev], nscal, nghost, MFInfo(), *ebfactory[lev]));
+        xslopes_scal[lev]->setVal(0.);
+        yslopes_scal[lev]->setVal(0.);
+        zslopes_scal[lev]->setVal(0.);
+    }
+
 	/****************************************************************************
     * Node-based Arrays                                                        *
     ****************************************************************************/
 
     // Pressures, projection vars
-    const BoxArray & nd_grids = amrex::convert(grids[lev], IntVect{1,1,1});
+    const BoxArray & nd_grids = amrex::convert(grids[lev], IntVect::TheNodeVector());
 
     std::unique_ptr<MultiFab> p_new(new MultiFab(nd_grids, dmap[lev], 1, nghost, 
                                                  MFInfo(), *ebfactory[lev]));
@@ -258,13 +324,27 @@ void incflo::RegridArrays(int lev)
     m_v_mac[lev] -> setVal(0.0);
 
     BoxArray z_ba = grids[lev];
+#if (AMREX_SPACEDIM == 3)
     z_ba = z_ba.surroundingNodes(2);
+#endif
 
     // MAC velocity
     std::unique_ptr<MultiFab> w_mac_new(new MultiFab(z_ba, dmap[lev], 1, nghost, 
                                                      MFInfo(), *ebfactory[lev]));
     m_w_mac[lev] = std::move(w_mac_new);
     m_w_mac[lev] -> setVal(0.0);
+
+	// Velocity of the EB walls
+	std::unique_ptr<MultiFab> eb_vel_new(new MultiFab(grids[lev], dmap[lev], 3, nghost,
+                                                      MFInfo(), *ebfactory[lev]));
+	eb_vel_new->setVal(0.);
+	eb_vel_new->copy(*eb_vel[lev], 0, 0, 3, 0, nghost);
+	eb_vel[lev] = std::move(eb_vel_new);
+
+    if(memory_report)
+    {
+        ReportMemory("regrid of level " + std::to_string(lev));
+    }
 }
 
 // Resize all arrays when instance of incflo class is constructed.
@@ -293,6 +373,7 @@ void incflo::ResizeArrays()
 	eta.resize(max_level + 1);
 	eta_old.resize(max_level + 1);
     strainrate.resize(max_level + 1);
+    nu_t.resize(max_level + 1);
 	vort.resize(max_level + 1);
 	divu.resize(max_level + 1);
 
@@ -307,11 +388,23 @@ void incflo::ResizeArrays()
 	m_v_mac.resize(max_level + 1);
 	m_w_mac.resize(max_level + 1);
 
+    // Velocity of the EB walls
+	eb_vel.resize(max_level + 1);
+
     // Slopes used for upwinding convective terms
 	xslopes.resize(max_level + 1);
 	yslopes.resize(max_level + 1);
 	zslopes.resize(max_level + 1);
 
+    // Passive scalars (allocated only if there are any)
+    scal.resize(max_level + 1);
+    scal_o.resize(max_level + 1);
+    conv_scal.resize(max_level + 1);
+    conv_scal_old.resize(max_level + 1);
+    xslopes_scal.resize(max_level + 1);
+    yslopes_scal.resize(max_level + 1);
+    zslopes_scal.resize(max_level + 1);
+
     // BCs
 	bc_ilo.resize(max_level + 1);
 	bc_ihi.resize(max_level + 1);
@@ -332,21 +425,33 @@ void incflo::MakeBCArrays()
         // problem domain.
         Box domainx(geom[lev].Domain());
         domainx.grow(1, nghost);
+#if (AMREX_SPACEDIM == 3)
         domainx.grow(2, nghost);
+#endif
         Box box_ilo = amrex::adjCellLo(domainx, 0, 1);
         Box box_ihi = amrex::adjCellHi(domainx, 0, 1);
 
         Box domainy(geom[lev].Domain());
         domainy.grow(0, nghost);
+#if (AMREX_SPACEDIM == 3)
         domainy.grow(2, nghost);
+#endif
         Box box_jlo = amrex::adjCellLo(domainy, 1, 1);
         Box box_jhi = amrex::adjCellHi(domainy, 1, 1);
 
+        // In 2D there is no z face: the z arrays only have the size the
+        // Fortran expects (one plane of the domain grown in x and y), with
+        // the cyclic BC type (see set_bc_type), so that they are never used
         Box domainz(geom[lev].Domain());
         domainz.grow(0, nghost);
         domainz.grow(1, nghost);
+#if (AMREX_SPACEDIM == 3)
         Box box_klo = amrex::adjCellLo(domainz, 2, 1);
         Box box_khi = amrex::adjCellHi(domainz, 2, 1);
+#else
+        Box box_klo = domainz;
+        Box box_khi = domainz;
+#endif
 
         // Note that each of these is a single IArrayBox so every process has a copy of them
         bc_ilo[lev].reset(new IArrayBox(box_ilo, 2));
@@ -358,3 +463,74 @@ void incflo::MakeBCArrays()
     }
 }
 
+//
+// Print the memory used by the fields of all levels, grouped in families
+//
+void incflo::ReportMemory(const std::string& label)
+{
+    BL_PROFILE("incflo::ReportMemory()");
+
+    MemReport::clear();
+
+    long ncells = 0;
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        ncells += grids[lev].numPts();
+
+        MemReport::add("state", "vel", lev, *vel[lev]);
+        MemReport::add("state", "vel_o", lev, *vel_o[lev]);
+        MemReport::add("state", "ro", lev, *ro[lev]);
+        MemReport::add("state", "p", lev, *p[lev]);
+        MemReport::add("state", "p0", lev, *p0[lev]);
+        MemReport::add("state", "gp", lev, *gp[lev]);
+        if(nscal > 0)
+        {
+            MemReport::add("state", "scal", lev, *scal[lev]);
+            MemReport::add("state", "scal_o", lev, *scal_o[lev]);
+        }
+
+        MemReport::add("derived", "eta", lev, *eta[lev]);
+        MemReport::add("derived", "eta_old", lev, *eta_old[lev]);
+        MemReport::add("derived", "strainrate", lev, *strainrate[lev]);
+        MemReport::add("derived", "nu_t", lev, *nu_t[lev]);
+        MemReport::add("derived", "vort", lev, *vort[lev]);
+        MemReport::add("derived", "divu", lev, *divu[lev]);
+
+        MemReport::add("rhs", "conv", lev, *conv[lev]);
+        MemReport::add("rhs", "conv_old", lev, *conv_old[lev]);
+        MemReport::add("rhs", "divtau", lev, *divtau[lev]);
+        MemReport::add("rhs", "divtau_old", lev, *divtau_old[lev]);
+        if(nscal > 0)
+        {
+            MemReport::add("rhs", "conv_scal", lev, *conv_scal[lev]);
+            MemReport::add("rhs", "conv_scal_old", lev, *conv_scal_old[lev]);
+        }
+
+        MemReport::add("slopes", "xslopes", lev, *xslopes[lev]);
+        MemReport::add("slopes", "yslopes", lev, *yslopes[lev]);
+        MemReport::add("slopes", "zslopes", lev, *zslopes[lev]);
+        if(nscal > 0)
+        {
+            MemReport::add("slopes", "xslopes_scal", lev, *xslopes_scal[lev]);
+            MemReport::add("slopes", "yslopes_scal", lev, *yslopes_scal[lev]);
+            MemReport::add("slopes", "zslopes_scal", lev, *zslopes_scal[lev]);
+        }
+
+        MemReport::add("mac", "u_mac", lev, *m_u_mac[lev]);
+        MemReport::add("mac", "v_mac", lev, *m_v_mac[lev]);
+        MemReport::add("mac", "w_mac", lev, *m_w_mac[lev]);
+
+        MemReport::add("eb", "eb_vel", lev, *eb_vel[lev]);
+        MemReport::addEBFactory(lev, *ebfactory[lev]);
+    }
+
+    // The solvers are only there after initialisation
+    if(mac_projection)
+        mac_projection->account_memory();
+    if(poisson_equation)
+        poisson_equation->accountMemory();
+    if(diffusion_equation)
+        diffusion_equation->accountMemory();
+
+    MemReport::print(label, ncells);
+}
@@ -27,6 +27,7 @@ void incflo::ReadParameters()
 		pp.query("check_file", check_file);
 		pp.query("check_int", check_int);
 		pp.query("restart", restart_file);
+		pp.query("check_minimal", check_minimal);
 
 		pp.query("plot_file", plot_file);
 		pp.query("plot_int", plot_int);
@@ -88,6 +89,46 @@ void incflo::ReadParameters()
 		pp.query("steady_state_tol", steady_state_tol);
         pp.query("initial_iterations", initial_iterations);
         pp.query("do_initial_proj", do_initial_proj);
+        pp.query("immersed_boundary", use_immersed_boundary);
+        pp.query("tracers", use_tracers);
+
+        // Per-step performance log (JSON lines), off by default
+        std::string perf_log;
+        pp.query("perf_log", perf_log);
+        PerfLog::open(perf_log);
+
+        // Tile-cost profiler, off by default
+        std::string tile_cost;
+        pp.query("tile_cost", tile_cost);
+        TileCost::enable(tile_cost);
+        pp.query("tile_cost_balance", tile_cost_balance);
+        pp.query("memory_report", memory_report);
+
+        // Solver tuning mode: sweeps the MLMG settings on the first step and stops
+        std::string tune_solvers;
+        pp.query("tune_solvers", tune_solvers);
+        SolverTuning::enable(tune_solvers);
+#if (AMREX_SPACEDIM == 2)
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!use_immersed_boundary && !use_tracers,
+                                         "incflo.immersed_boundary and incflo.tracers are only implemented in 3D");
+#endif
+
+        // Axisymmetric (RZ) runs are set with geometry.coord_sys = 1: x is the radius r,
+        // y the axis and the third velocity component the swirl. A domain starting at
+        // r = 0 has the axis as its xlo boundary.
+        if(geom[0].IsRZ())
+        {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(AMREX_SPACEDIM == 2,
+                                             "geometry.coord_sys = 1 (RZ) needs the 2D build");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(geom[0].ProbLo(0) >= 0.0 && !geom[0].isPeriodic(0),
+                                             "RZ: the radius x must be non-negative and not periodic");
+            amrex::Print() << "Axisymmetric (RZ) coordinates" << std::endl;
+        }
+        else
+        {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(geom[0].IsCartesian(),
+                                             "geometry.coord_sys must be 0 (Cartesian) or 1 (RZ)");
+        }
 
         // Physics
 		pp.queryarr("delp", delp, 0, 3);
@@ -184,25 +225,79 @@ void incflo::ReadParameters()
             amrex::Abort("Unknown fluid_model! Choose either newtonian, powerlaw, bingham, hb, smd");
         }
 
+        // Small cut-cell treatment (to pass to Fortran)
+        pp.query("redistribution_type", redistribution_type);
+        int redist_type = 0;
+        if(redistribution_type == "StateRedist")
+        {
+            redist_type = 1;
+        }
+        else if(redistribution_type != "FluxRedist")
+        {
+            amrex::Abort("Unknown redistribution_type! Choose either FluxRedist or StateRedist");
+        }
+
         // Get cyclicity, (to pass to Fortran)
-        Vector<int> is_cyclic(3);
-        for(int dir = 0; dir < 3; dir++)
+        Vector<int> is_cyclic(3, 0);
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
         {
             is_cyclic[dir] = geom[0].isPeriodic(dir);
         }
 
+        // Axisymmetric coordinates (to pass to Fortran)
+        int rz = geom[0].IsRZ() ? 1 : 0;
+        Real r_lo = geom[0].ProbLo(0);
+
         // Loads constants given at runtime `inputs` file into the Fortran module "constant"
         fortran_get_data(is_cyclic.dataPtr(),
                          delp.dataPtr(), gravity.dataPtr(), &ro_0, &mu,
                          &ic_u, &ic_v, &ic_w, &ic_p,
                          &n, &tau_0, &papa_reg, &eta_0,
-                         fluid_model.c_str(), fluid_model.size());
+                         fluid_model.c_str(), fluid_model.size(),
+                         &redist_type, &rz, &r_lo);
 	}
+    {
+        // Prefix les: subgrid-scale model, with the usual default coefficients
+        ParmParse pp("les");
+
+        std::string les_model_name = "none";
+        pp.query("model", les_model_name);
+        if(les_model_name == "smagorinsky")
+        {
+            les_model = 1;
+            les_coef = 0.17;
+        }
+        else if(les_model_name == "wale")
+        {
+            les_model = 2;
+            les_coef = 0.5;
+        }
+        else if(les_model_name == "vreman")
+        {
+            les_model = 3;
+            les_coef = 0.07;
+        }
+        else if(les_model_name != "none")
+        {
+            amrex::Abort("Unknown les.model! Choose either none, smagorinsky, wale, vreman");
+        }
+        pp.query("coef", les_coef);
+
+        if(les_model > 0)
+        {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(les_coef > 0.0, "les.coef must be positive");
+            amrex::Print() << "LES with " << les_model_name
+                           << " model, coefficient " << les_coef << std::endl;
+        }
+    }
     {
         // Prefix cylinder
 		ParmParse pp("cylinder");
 		pp.query("speed", cyl_speed);
     }
+
+    // Passive scalars (prefix scalars)
+    ReadScalarParameters();
 }
 
 void incflo::PostInit(int restart_flag)
@@ -210,6 +305,13 @@ void incflo::PostInit(int restart_flag)
     // Set the BC types on domain boundary
     SetBCTypes();
 
+    // On restart, a moving EB is first brought to its position at the restart time
+    if(restart_flag && eb_moving && cur_time > 0.0)
+    {
+        MoveEB(cur_time);
+    }
+    UpdateEBVelocity(cur_time);
+
     // Reset MAC projection object
     mac_projection.reset(new MacProjection(this, nghost, &ebfactory, probtype));
     mac_projection->set_bcs(bc_ilo, bc_ihi, bc_jlo, bc_jhi, bc_klo, bc_khi);
@@ -222,7 +324,34 @@ void incflo::PostInit(int restart_flag)
     diffusion_equation.reset(new DiffusionEquation(this, &ebfactory,
                                                    bc_ilo, bc_ihi,
                                                    bc_jlo, bc_jhi,
-                                                   bc_klo, bc_khi, nghost, cyl_speed));
+                                                   bc_klo, bc_khi, nghost));
+
+    if(eb_motion_check)
+    {
+        CheckEBMotion();
+    }
+
+    // Direct-forcing immersed boundaries work on the regular grid only
+    if(use_immersed_boundary)
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!eb_body_if,
+                                         "incflo.immersed_boundary does not mix with an EB geometry");
+        immersed_boundary.reset(new ImmersedBoundary(this, cur_time));
+    }
+
+    // Passive tracers, read back from the checkpoint if it holds them
+    if(use_tracers)
+    {
+        tracers.reset(new TracerParticleContainer(this));
+        if(restart_flag && amrex::FileExists(restart_file + "/tracers/Header"))
+        {
+            tracers->Restart(restart_file, "tracers");
+        }
+        else
+        {
+            tracers->InitInFluid(ebfactory, cur_time);
+        }
+    }
 
     // Initial fluid arrays: pressure, velocity, density, viscosity
     if(!restart_flag)
@@ -230,6 +359,33 @@ void incflo::PostInit(int restart_flag)
         InitFluid();
     }
 
+    // Passive scalars: Dirichlet where a face value is given, periodic or zero gradient elsewhere
+    if(nscal > 0)
+    {
+        int scal_bc_lo[3], scal_bc_hi[3];
+        for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+        {
+            if(geom[0].isPeriodic(dir))
+            {
+                scal_bc_lo[dir] = scal_bc_hi[dir] = static_cast<int>(LinOpBCType::Periodic);
+            }
+            else
+            {
+                scal_bc_lo[dir] = static_cast<int>(scal_bc_values[2 * dir].empty() ?
+                                                   LinOpBCType::Neumann : LinOpBCType::Dirichlet);
+                scal_bc_hi[dir] = static_cast<int>(scal_bc_values[2 * dir + 1].empty() ?
+                                                   LinOpBCType::Neumann : LinOpBCType::Dirichlet);
+            }
+        }
+        diffusion_equation->setScalarBC(scal_bc_lo, scal_bc_hi);
+
+        if(!restart_flag)
+        {
+            InitScalars();
+        }
+        FillScalBC();
+    }
+
     // Set the background pressure and gradients in "DELP" cases
     SetBackgroundPressure();
 
@@ -248,11 +404,14 @@ void incflo::PostInit(int restart_flag)
     }
 }
 
+//
+// In 2D the Fortran routines see a single cell of unit width in z
+//
 void incflo::InitFluid()
 {
 	Real xlen = geom[0].ProbHi(0) - geom[0].ProbLo(0);
 	Real ylen = geom[0].ProbHi(1) - geom[0].ProbLo(1);
-	Real zlen = geom[0].ProbHi(2) - geom[0].ProbLo(2);
+	Real zlen = AMREX_D_PICK(0., 1., geom[0].ProbHi(2) - geom[0].ProbLo(2));
 
     for(int lev = 0; lev <= max_level; lev++)
     {
@@ -260,7 +419,7 @@ void incflo::InitFluid()
 
         Real dx = geom[lev].CellSize(0);
         Real dy = geom[lev].CellSize(1);
-        Real dz = geom[lev].CellSize(2);
+        Real dz = AMREX_D_PICK(0., 1., geom[lev].CellSize(2));
 
         // We deliberately don't tile this loop since we will be looping
         //    over bc's on faces and it makes more sense to do this one grid at a time
@@ -268,9 +427,9 @@ void incflo::InitFluid()
         {
             const Box& bx = mfi.validbox();
             const Box& sbx = (*ro[lev])[mfi].box();
-            init_fluid(sbx.loVect(), sbx.hiVect(),
-                       bx.loVect(), bx.hiVect(),
-                       domain.loVect(), domain.hiVect(),
+            init_fluid(BL_TO_FORTRAN_BOX(sbx),
+                       BL_TO_FORTRAN_BOX(bx),
+                       BL_TO_FORTRAN_BOX(domain),
                        (*ro[lev])[mfi].dataPtr(),
                        (*p[lev])[mfi].dataPtr(),
                        (*vel[lev])[mfi].dataPtr(),
@@ -287,16 +446,16 @@ void incflo::SetBCTypes()
     {
         Real dx = geom[lev].CellSize(0);
         Real dy = geom[lev].CellSize(1);
-        Real dz = geom[lev].CellSize(2);
+        Real dz = AMREX_D_PICK(0., 1., geom[lev].CellSize(2));
         Real xlen = geom[lev].ProbHi(0) - geom[lev].ProbLo(0);
         Real ylen = geom[lev].ProbHi(1) - geom[lev].ProbLo(1);
-        Real zlen = geom[lev].ProbHi(2) - geom[lev].ProbLo(2);
+        Real zlen = AMREX_D_PICK(0., 1., geom[lev].ProbHi(2) - geom[lev].ProbLo(2));
         Box domain(geom[lev].Domain());
 
         set_bc_type(bc_ilo[lev]->dataPtr(), bc_ihi[lev]->dataPtr(),
                     bc_jlo[lev]->dataPtr(), bc_jhi[lev]->dataPtr(),
                     bc_klo[lev]->dataPtr(), bc_khi[lev]->dataPtr(),
-                    domain.loVect(), domain.hiVect(),
+                    BL_TO_FORTRAN_BOX(domain),
                     &dx, &dy, &dz, &xlen, &ylen, &zlen, &nghost);
     }
 }
@@ -305,20 +464,22 @@ void incflo::SetBackgroundPressure()
 {
 	Real xlen = geom[0].ProbHi(0) - geom[0].ProbLo(0);
 	Real ylen = geom[0].ProbHi(1) - geom[0].ProbLo(1);
-	Real zlen = geom[0].ProbHi(2) - geom[0].ProbLo(2);
+	Real zlen = AMREX_D_PICK(0., 1., geom[0].ProbHi(2) - geom[0].ProbLo(2));
 
 	int delp_dir;
 	set_delp_dir(&delp_dir);
 
-    IntVect press_per = IntVect(geom[0].isPeriodic(0),
-                                geom[0].isPeriodic(1),
-                                geom[0].isPeriodic(2));
+    IntVect press_per = IntVect(AMREX_D_DECL(geom[0].isPeriodic(0),
+                                             geom[0].isPeriodic(1),
+                                             geom[0].isPeriodic(2)));
 
 	// Here we set a separate periodicity flag for p0 because when we use
 	// pressure drop (delp) boundary conditions we fill all variables *except* p0
 	// periodically
     if(delp_dir > -1)
     {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(delp_dir < AMREX_SPACEDIM,
+                                         "There is no pressure drop in z in 2D");
         press_per[delp_dir] = 0;
     }
 	p0_periodicity = Periodicity(press_per);
@@ -327,7 +488,7 @@ void incflo::SetBackgroundPressure()
     {
         Real dx = geom[lev].CellSize(0);
         Real dy = geom[lev].CellSize(1);
-        Real dz = geom[lev].CellSize(2);
+        Real dz = AMREX_D_PICK(0., 1., geom[lev].CellSize(2));
 
         Box domain(geom[lev].Domain());
 
@@ -337,8 +498,8 @@ void incflo::SetBackgroundPressure()
         {
             const Box& bx = mfi.validbox();
 
-            set_p0(bx.loVect(), bx.hiVect(),
-                   domain.loVect(), domain.hiVect(),
+            set_p0(BL_TO_FORTRAN_BOX(bx),
+                   BL_TO_FORTRAN_BOX(domain),
                    BL_TO_FORTRAN_ANYD((*p0[lev])[mfi]),
                    &gp0[0],
                    &dx, &dy, &dz, &xlen, &ylen, &zlen,
@@ -374,10 +535,14 @@ void incflo::InitialIterations()
     FillScalarBC();
     FillVelocityBC(cur_time, 0);
 
-    // Copy vel into vel_o
+    // Copy vel into vel_o (and the scalars, which the predictor also advances)
     for(int lev = 0; lev <= finest_level; lev++)
     {
         MultiFab::Copy(*vel_o[lev], *vel[lev], 0, 0, vel[lev]->nComp(), vel_o[lev]->nGrow());
+        if(nscal > 0)
+        {
+            MultiFab::Copy(*scal_o[lev], *scal[lev], 0, 0, nscal, scal_o[lev]->nGrow());
+        }
     }
 
 	for(int iter = 0; iter < initial_iterations; ++iter)
@@ -390,6 +555,10 @@ void incflo::InitialIterations()
         {
             // Replace vel by the original values
             MultiFab::Copy(*vel[lev], *vel_o[lev], 0, 0, vel[lev]->nComp(), vel[lev]->nGrow());
+            if(nscal > 0)
+            {
+                MultiFab::Copy(*scal[lev], *scal_o[lev], 0, 0, nscal, scal[lev]->nGrow());
+            }
         }
         // Reset the boundary values (necessary if they are time-dependent)
         FillVelocityBC(cur_time, 0);
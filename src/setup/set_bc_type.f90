@@ -21,9 +21,9 @@ contains
 
       use bc,       only: bc_defined, bc_type, bc_plane
       use bc,       only: cyclic_x, cyclic_y, cyclic_z
-      use bc,       only: minf_, nsw_, pinf_, pout_
+      use bc,       only: minf_, nsw_, pinf_, pout_, axis_, sym_
       use bc,       only: undef_cell
-      use constant, only: dim_bc
+      use constant, only: dim_bc, kz
 
       implicit none
 
@@ -34,13 +34,13 @@ contains
       real(rt)  ,     intent(in   ) :: xlength, ylength, zlength
 
       integer(c_int), intent(inout) :: bc_ilo_type&
-         (domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2)
+         (domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2)
       integer(c_int), intent(inout) :: bc_ihi_type&
-         (domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2)
+         (domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2)
       integer(c_int), intent(inout) :: bc_jlo_type&
-         (domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2)
+         (domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2)
       integer(c_int), intent(inout) :: bc_jhi_type&
-         (domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2)
+         (domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2)
       integer(c_int), intent(inout) :: bc_klo_type&
          (domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
       integer(c_int), intent(inout) :: bc_khi_type&
@@ -64,6 +64,8 @@ contains
             case('P_INFLOW'      ,'PI' ); type = pinf_
             case('P_OUTFLOW'     ,'PO' ); type = pout_
             case('MASS_INFLOW'   ,'MI' ); type = minf_
+            case('AXIS'                ); type = axis_
+            case('SYMMETRY'      ,'SYM'); type = sym_
             case default
                write(6,*) 'unknown bc type'
                stop 7655
@@ -211,6 +213,18 @@ subroutine set_bc_mod(pid, ptype, plo, phi, ploc, ppg, pvel) &
 
      bc_defined(pid) = .true.
 
+  case(AXIS_)
+
+     bc_type(pid) = 'AXIS'
+
+     bc_defined(pid) = .true.
+
+  case(SYM_)
+
+     bc_type(pid) = 'SYM'
+
+     bc_defined(pid) = .true.
+
   case DEFAULT
 
      bc_defined(pid) = .false.
@@ -15,7 +15,7 @@ subroutine set_p0(lo, hi, domlo, domhi, &
    use bc,       only: dim_bc, bc_type, bc_p, bc_defined
    use bc,       only: pinf_, pout_, minf_
    use constant, only: delp, gravity, ro_0, ic_p
-   use constant, only: zero, undefined, is_defined
+   use constant, only: zero, undefined, is_defined, kz
 
    use amrex_fort_module, only : ar => amrex_real
    use iso_c_binding , only: c_int
@@ -34,10 +34,10 @@ subroutine set_p0(lo, hi, domlo, domhi, &
    integer,  intent(in)    :: delp_dir_in, ng
 
    integer(c_int), intent(in   ) :: &
-      bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-      bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-      bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
-      bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng:domhi(3)+ng,2), &
+      bct_ilo(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+      bct_ihi(domlo(2)-ng:domhi(2)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+      bct_jlo(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
+      bct_jhi(domlo(1)-ng:domhi(1)+ng,domlo(3)-ng*kz:domhi(3)+ng*kz,2), &
       bct_klo(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2), &
       bct_khi(domlo(1)-ng:domhi(1)+ng,domlo(2)-ng:domhi(2)+ng,2)
 
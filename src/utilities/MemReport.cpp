@@ -0,0 +1,147 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+#include <MemReport.H>
+
+#include <iomanip>
+#include <map>
+
+using namespace amrex;
+
+namespace
+{
+    struct Record
+    {
+        std::string family;
+        std::string name;
+        int lev;
+        long valid;
+        long ghost;
+    };
+
+    // Records of this rank, in the same order on all ranks
+    Vector<Record> records;
+
+    constexpr Real MB = 1024.0 * 1024.0;
+
+    // Cut-cell data only exists on the boxes with cut cells
+    long cutFabBytes(const MultiCutFab& mcf, const MultiFab& volfrac, long& valid)
+    {
+        long total = 0;
+        valid = 0;
+        for(MFIter mfi(volfrac); mfi.isValid(); ++mfi)
+        {
+            if(mcf.ok(mfi))
+            {
+                total += mcf[mfi].nBytes();
+                valid += mfi.validbox().numPts() * mcf.nComp() * sizeof(Real);
+            }
+        }
+        return total;
+    }
+}
+
+void MemReport::clear()
+{
+    records.clear();
+}
+
+void MemReport::addBytes(const std::string& family, const std::string& name, int lev,
+                         long valid_bytes, long ghost_bytes)
+{
+    records.push_back({family, name, lev, valid_bytes, ghost_bytes});
+}
+
+void MemReport::addEBFactory(int lev, const EBFArrayBoxFactory& factory)
+{
+    const MultiFab& volfrac = factory.getVolFrac();
+
+    add("eb", "flags", lev, factory.getMultiEBCellFlagFab());
+    add("eb", "volfrac", lev, volfrac);
+
+    long valid;
+    long total = cutFabBytes(factory.getCentroid(), volfrac, valid);
+    addBytes("eb", "centroid", lev, valid, total - valid);
+    total = cutFabBytes(factory.getBndryCent(), volfrac, valid);
+    addBytes("eb", "bndrycent", lev, valid, total - valid);
+
+    const auto& areafrac = factory.getAreaFrac();
+    const auto& facecent = factory.getFaceCent();
+    for(int dir = 0; dir < AMREX_SPACEDIM; dir++)
+    {
+        total = cutFabBytes(*areafrac[dir], volfrac, valid);
+        addBytes("eb", std::string("areafrac_") + "xyz"[dir], lev, valid, total - valid);
+        total = cutFabBytes(*facecent[dir], volfrac, valid);
+        addBytes("eb", std::string("facecent_") + "xyz"[dir], lev, valid, total - valid);
+    }
+}
+
+void MemReport::print(const std::string& label, long ncells)
+{
+    const int nrec = records.size();
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+
+    // Sum and rank maximum of the valid and ghost bytes of each record
+    Vector<long> sum(2 * nrec);
+    for(int r = 0; r < nrec; r++)
+    {
+        sum[2 * r] = records[r].valid;
+        sum[2 * r + 1] = records[r].ghost;
+    }
+    Vector<long> max(nrec);
+    for(int r = 0; r < nrec; r++)
+    {
+        max[r] = records[r].valid + records[r].ghost;
+    }
+    ParallelDescriptor::ReduceLongSum(sum.dataPtr(), sum.size(), ioproc);
+    ParallelDescriptor::ReduceLongMax(max.dataPtr(), max.size(), ioproc);
+
+    // Largest rank footprint
+    long rank_total = 0;
+    for(const Record& rec : records)
+    {
+        rank_total += rec.valid + rec.ghost;
+    }
+    ParallelDescriptor::ReduceLongMax(rank_total, ioproc);
+
+    if(ParallelDescriptor::IOProcessor())
+    {
+        std::map<std::string, long> family_bytes;
+        long valid_total = 0;
+        long ghost_total = 0;
+
+        amrex::Print() << "\nMemory report (" << label << "), MB over all ranks:\n"
+                       << "  family     field             level      valid      ghost  ghost%   rank max\n";
+        for(int r = 0; r < nrec; r++)
+        {
+            const Record& rec = records[r];
+            long valid = sum[2 * r];
+            long ghost = sum[2 * r + 1];
+
+            amrex::Print() << "  " << std::left << std::setw(10) << rec.family
+                           << " " << std::setw(16) << rec.name << std::right
+                           << std::setw(7) << rec.lev
+                           << std::fixed << std::setprecision(2)
+                           << std::setw(11) << valid / MB
+                           << std::setw(11) << ghost / MB
+                           << std::setw(8) << (valid + ghost > 0 ? 100.0 * ghost / (valid + ghost) : 0.0)
+                           << std::setw(11) << max[r] / MB << '\n';
+
+            family_bytes[rec.family] += valid + ghost;
+            valid_total += valid;
+            ghost_total += ghost;
+        }
+
+        amrex::Print() << "  By family:";
+        for(const auto& fb : family_bytes)
+        {
+            amrex::Print() << " " << fb.first << " " << fb.second / MB;
+        }
+        amrex::Print() << "\n  Total: " << (valid_total + ghost_total) / MB << " MB ("
+                       << ghost_total / MB << " MB in ghost cells), largest rank "
+                       << rank_total / MB << " MB\n"
+                       << "  Predicted bytes per cell: "
+                       << (ncells > 0 ? static_cast<Real>(valid_total + ghost_total) / ncells : 0.0)
+                       << std::defaultfloat << std::endl;
+    }
+}
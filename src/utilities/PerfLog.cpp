@@ -0,0 +1,194 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Vector.H>
+
+#include <PerfLog.H>
+
+#include <sys/resource.h>
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+using namespace amrex;
+
+namespace
+{
+    const char* phase_names[PerfLog::n_phases] = {"ugradu", "mac_projection", "derived", "divtau",
+                                                  "diffusion", "nodal_projection", "fill_vel_bc",
+                                                  "io", "step"};
+
+    struct SolveRecord
+    {
+        std::string name;
+        int iterations;
+        Real residual;
+    };
+
+    std::string log_file;
+
+    // Accumulated over the current step, on this rank
+    Real phase_time[PerfLog::n_phases] = {0.0};
+    Vector<SolveRecord> solves;
+    Real cfl_conv = 0.0;
+    Real cfl_diff = 0.0;
+    Real cfl_forc = 0.0;
+
+    // Nesting depth of the pauses, start of the outermost one, and the total time paused
+    int pause_depth = 0;
+    Real pause_start = 0.0;
+    Real paused_time = 0.0;
+
+    // A number of the log: JSON has no NaN or infinity, so those are written as null
+    struct Number
+    {
+        Real value;
+    };
+
+    std::ostream& operator<<(std::ostream& os, Number x)
+    {
+        if(std::isfinite(x.value))
+        {
+            return os << x.value;
+        }
+        return os << "null";
+    }
+}
+
+PerfLog::Timer::Timer(Phase phase)
+    : m_phase(phase), m_start(ParallelDescriptor::second()), m_paused(paused_time)
+{
+}
+
+PerfLog::Timer::~Timer()
+{
+    addTime(m_phase, ParallelDescriptor::second() - m_start - (paused_time - m_paused));
+}
+
+PerfLog::Pause::Pause()
+{
+    if(pause_depth++ == 0)
+    {
+        pause_start = ParallelDescriptor::second();
+    }
+}
+
+PerfLog::Pause::~Pause()
+{
+    if(--pause_depth == 0)
+    {
+        paused_time += ParallelDescriptor::second() - pause_start;
+    }
+}
+
+void PerfLog::open(const std::string& filename)
+{
+    log_file = filename;
+}
+
+bool PerfLog::isOpen()
+{
+    return !log_file.empty();
+}
+
+void PerfLog::addTime(Phase phase, Real seconds)
+{
+    if(pause_depth == 0)
+    {
+        phase_time[phase] += seconds;
+    }
+}
+
+void PerfLog::addSolve(const std::string& name, int iterations, Real residual)
+{
+    if(isOpen() && pause_depth == 0)
+    {
+        solves.push_back({name, iterations, residual});
+    }
+}
+
+void PerfLog::setCFL(Real conv, Real diff, Real forc)
+{
+    cfl_conv = conv;
+    cfl_diff = diff;
+    cfl_forc = forc;
+}
+
+long PerfLog::memoryHighWaterMark()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    // Linux reports kilobytes
+    return usage.ru_maxrss * 1024L;
+#endif
+}
+
+void PerfLog::writeStep(int nstep, Real time, Real dt)
+{
+    if(isOpen())
+    {
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int ioproc = ParallelDescriptor::IOProcessorNumber();
+
+        // The phases and the memory are reduced in one go
+        Real tmin[n_phases + 1], tmax[n_phases + 1], tsum[n_phases + 1];
+        for(int n = 0; n < n_phases; n++)
+        {
+            tmin[n] = tmax[n] = tsum[n] = phase_time[n];
+        }
+        tmin[n_phases] = tmax[n_phases] = tsum[n_phases] = static_cast<Real>(memoryHighWaterMark());
+
+        ParallelDescriptor::ReduceRealMin(tmin, n_phases + 1, ioproc);
+        ParallelDescriptor::ReduceRealMax(tmax, n_phases + 1, ioproc);
+        ParallelDescriptor::ReduceRealSum(tsum, n_phases + 1, ioproc);
+
+        if(ParallelDescriptor::IOProcessor())
+        {
+            std::ofstream ofs(log_file, std::ios::app);
+            ofs << std::setprecision(6);
+
+            ofs << "{\"step\": " << nstep
+                << ", \"time\": " << Number{time}
+                << ", \"dt\": " << Number{dt}
+                << ", \"nprocs\": " << nprocs
+                << ", \"cfl\": {\"conv\": " << Number{cfl_conv}
+                << ", \"diff\": " << Number{cfl_diff}
+                << ", \"forc\": " << Number{cfl_forc} << "}";
+
+            ofs << ", \"phases\": {";
+            for(int n = 0; n < n_phases; n++)
+            {
+                ofs << (n > 0 ? ", " : "") << "\"" << phase_names[n] << "\": ["
+                    << Number{tmin[n]} << ", " << Number{tsum[n] / nprocs} << ", " << Number{tmax[n]} << "]";
+            }
+            ofs << "}";
+
+            ofs << ", \"solves\": [";
+            for(int s = 0; s < solves.size(); s++)
+            {
+                ofs << (s > 0 ? ", " : "") << "{\"name\": \"" << solves[s].name
+                    << "\", \"iters\": " << solves[s].iterations
+                    << ", \"resid\": " << Number{solves[s].residual} << "}";
+            }
+            ofs << "]";
+
+            ofs << ", \"mem_hwm\": [" << std::setprecision(12)
+                << Number{tmin[n_phases]} << ", " << Number{tsum[n_phases] / nprocs} << ", "
+                << Number{tmax[n_phases]} << "]";
+
+            ofs << "}" << std::endl;
+        }
+    }
+}
+
+void PerfLog::startStep()
+{
+    for(int n = 0; n < n_phases; n++)
+    {
+        phase_time[n] = 0.0;
+    }
+    solves.clear();
+}
@@ -0,0 +1,216 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <PerfLog.H>
+#include <SolverTuning.H>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+using namespace amrex;
+
+namespace
+{
+    std::string output_file;
+    bool trial = false;
+
+    struct Sweep
+    {
+        std::string name;
+        Vector<SolverTuning::Settings> settings;
+        Vector<SolverTuning::Result> results;
+        Vector<Real> times;
+    };
+    Vector<Sweep> sweeps;
+
+    // All the combinations of the tune.* lists
+    Vector<SolverTuning::Settings> candidates()
+    {
+        Vector<std::string> bottom_solvers = {"bicgstab", "cg", "bicgcg", "smoother"};
+        Vector<int> max_coarsening_levels = {100, 4, 2};
+        Vector<int> smooths = {2, 4};
+        Vector<int> agglomeration = {1, 0};
+
+        ParmParse pp("tune");
+        pp.queryarr("bottom_solvers", bottom_solvers);
+        pp.queryarr("max_coarsening_levels", max_coarsening_levels);
+        pp.queryarr("smooths", smooths);
+        pp.queryarr("agglomeration", agglomeration);
+
+        Vector<SolverTuning::Settings> settings;
+        for(const std::string& bottom : bottom_solvers)
+        for(int coarsening : max_coarsening_levels)
+        for(int smooth : smooths)
+        for(int agg : agglomeration)
+        {
+            settings.push_back({bottom, coarsening, smooth, agg});
+        }
+        return settings;
+    }
+
+    void printSetting(const SolverTuning::Settings& s)
+    {
+        amrex::Print() << std::setw(10) << s.bottom_solver << std::setw(12) << s.max_coarsening_level
+                       << std::setw(8) << s.smooth << std::setw(8) << s.agglomeration;
+    }
+}
+
+void SolverTuning::enable(const std::string& filename)
+{
+    output_file = filename;
+}
+
+bool SolverTuning::isEnabled()
+{
+    return !output_file.empty();
+}
+
+bool SolverTuning::needsTuning(const std::string& name)
+{
+    if(!isEnabled())
+    {
+        return false;
+    }
+    for(const Sweep& sweep : sweeps)
+    {
+        if(sweep.name == name)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SolverTuning::inTrial()
+{
+    return trial;
+}
+
+void SolverTuning::tune(const std::string& name, const Settings& current,
+                        const std::function<void(const Settings&)>& apply,
+                        const std::function<Result()>& solve)
+{
+    Sweep sweep;
+    sweep.name = name;
+    // The current setting comes first, as the reference
+    const Vector<Settings> settings = candidates();
+    sweep.settings.push_back(current);
+    sweep.settings.insert(sweep.settings.end(), settings.begin(), settings.end());
+
+    amrex::Print() << "\nTuning the " << name << " solver over " << sweep.settings.size() - 1
+                   << " settings (the first is the current one):\n"
+                   << "    bottom  coarsening  smooth  agglom       time   iters   residual\n";
+
+    PerfLog::Pause pause;
+    trial = true;
+
+    for(const Settings& s : sweep.settings)
+    {
+        apply(s);
+
+        ParallelDescriptor::Barrier();
+        Real strt = ParallelDescriptor::second();
+        Result result = {0, 0.0};
+        bool converged = true;
+        try
+        {
+            result = solve();
+        }
+        catch(const std::exception& e)
+        {
+            // MLMG did not converge: all ranks see the same residuals and throw together
+            converged = false;
+        }
+        Real time = ParallelDescriptor::second() - strt;
+        ParallelDescriptor::ReduceRealMax(time);
+        if(!converged)
+        {
+            time = std::numeric_limits<Real>::infinity();
+        }
+
+        sweep.results.push_back(result);
+        sweep.times.push_back(time);
+
+        printSetting(s);
+        if(converged)
+        {
+            amrex::Print() << std::setw(11) << std::setprecision(4) << time
+                           << std::setw(8) << result.iterations
+                           << std::setw(11) << std::setprecision(3) << result.residual << std::endl;
+        }
+        else
+        {
+            amrex::Print() << "     failed (no convergence)" << std::endl;
+        }
+    }
+
+    trial = false;
+    apply(current);
+    sweeps.push_back(sweep);
+}
+
+void SolverTuning::write()
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    std::ofstream ofs;
+    if(ParallelDescriptor::IOProcessor())
+    {
+        ofs.open(output_file);
+        if(!ofs.good())
+        {
+            amrex::FileOpenFailed(output_file);
+        }
+        ofs << "# Solver settings from incflo.tune_solvers\n";
+    }
+
+    amrex::Print() << "\nFastest solver settings:\n"
+                   << "    solver    bottom  coarsening  smooth  agglom       time    speedup\n";
+    for(const Sweep& sweep : sweeps)
+    {
+        int best = 0;
+        for(int n = 1; n < sweep.times.size(); n++)
+        {
+            if(sweep.times[n] < sweep.times[best])
+            {
+                best = n;
+            }
+        }
+        const Settings& s = sweep.settings[best];
+
+        if(sweep.times[best] == std::numeric_limits<Real>::infinity())
+        {
+            amrex::Print() << std::setw(10) << sweep.name << "  no setting converged" << std::endl;
+            if(ParallelDescriptor::IOProcessor())
+            {
+                ofs << "\n# " << sweep.name << ": no setting converged\n";
+            }
+            continue;
+        }
+
+        amrex::Print() << std::setw(10) << sweep.name;
+        printSetting(s);
+        amrex::Print() << std::setw(11) << std::setprecision(4) << sweep.times[best]
+                       << std::setw(11) << sweep.times[0] / sweep.times[best] << std::endl;
+
+        if(ParallelDescriptor::IOProcessor())
+        {
+            const std::string& p = sweep.name;
+            ofs << "\n# " << sweep.times[best] << " s (" << sweep.results[best].iterations << " iterations), "
+                << sweep.times[0] / sweep.times[best] << " times faster than the current setting\n"
+                << p << ".bottom_solver_type      = " << s.bottom_solver << "\n"
+                << p << ".mg_max_coarsening_level = " << s.max_coarsening_level << "\n"
+                << p << ".mg_pre_smooth           = " << s.smooth << "\n"
+                << p << ".mg_post_smooth          = " << s.smooth << "\n"
+                << p << ".mg_agglomeration        = " << s.agglomeration << "\n";
+        }
+    }
+
+    amrex::Print() << "Solver settings written to " << output_file << std::endl;
+}
@@ -0,0 +1,324 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <TileCost.H>
+
+#include <fstream>
+#include <sstream>
+
+using namespace amrex;
+
+namespace
+{
+    const char* kernel_names[TileCost::n_kernels] = {"slopes", "face_velocities", "ugradu", "divtau",
+                                                     "strainrate", "vorticity", "viscosity"};
+    const char* type_names[TileCost::n_types] = {"regular", "cut", "covered"};
+
+    std::string file_prefix;
+
+    // Per box of a level: the time in each kernel and the cells of each type.
+    // A rank only fills the entries of its own boxes.
+    struct LevelCost
+    {
+        BoxArray ba;
+        DistributionMapping dm;
+        Vector<Real> time;
+        Vector<Real> cells;
+    };
+    Vector<LevelCost> levels;
+
+    // Per kernel and tile type on this rank: time, number of tiles and cells
+    Real rank_stats[TileCost::n_kernels][TileCost::n_types][3] = {};
+}
+
+TileCost::Timer::Timer(Kernel kernel, int lev, const MFIter& mfi, const EBCellFlagFab& flags)
+    : m_kernel(kernel), m_lev(-1), m_box(0), m_type(regular), m_cells(0), m_start(0.0)
+{
+    if(isEnabled() && lev < levels.size())
+    {
+        const Box& bx = mfi.tilebox();
+        const FabType fab_type = flags.getType(bx);
+
+        m_lev = lev;
+        m_box = mfi.index();
+        m_type = (fab_type == FabType::covered) ? covered :
+                 (fab_type == FabType::regular) ? regular : cut;
+        m_cells = bx.numPts();
+        m_start = ParallelDescriptor::second();
+    }
+}
+
+TileCost::Timer::~Timer()
+{
+    if(m_lev >= 0)
+    {
+        Real seconds = ParallelDescriptor::second() - m_start;
+
+#ifdef _OPENMP
+#pragma omp critical (tile_cost)
+#endif
+        {
+            levels[m_lev].time[m_box * n_kernels + m_kernel] += seconds;
+            rank_stats[m_kernel][m_type][0] += seconds;
+            rank_stats[m_kernel][m_type][1] += 1.0;
+            rank_stats[m_kernel][m_type][2] += m_cells;
+        }
+    }
+}
+
+void TileCost::enable(const std::string& prefix)
+{
+    file_prefix = prefix;
+}
+
+bool TileCost::isEnabled()
+{
+    return !file_prefix.empty();
+}
+
+void TileCost::define(int lev, const BoxArray& ba, const DistributionMapping& dm,
+                      const FabArray<EBCellFlagFab>& flags)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    if(levels.size() <= lev)
+    {
+        levels.resize(lev + 1);
+    }
+
+    LevelCost& level = levels[lev];
+    level.ba = ba;
+    level.dm = dm;
+    level.time.assign(ba.size() * n_kernels, 0.0);
+
+    countCells(lev, flags);
+}
+
+void TileCost::countCells(int lev, const FabArray<EBCellFlagFab>& flags)
+{
+    if(!isEnabled() || lev >= levels.size())
+    {
+        return;
+    }
+
+    LevelCost& level = levels[lev];
+    level.cells.assign(level.ba.size() * n_types, 0.0);
+
+    // One pass over the flags of each (untiled) box
+    for(MFIter mfi(flags); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& flag_arr = flags.array(mfi);
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        Real* cells = &level.cells[mfi.index() * n_types];
+        for(int k = lo.z; k <= hi.z; k++)
+        for(int j = lo.y; j <= hi.y; j++)
+        for(int i = lo.x; i <= hi.x; i++)
+        {
+            if(flag_arr(i,j,k).isCovered())
+            {
+                cells[covered] += 1.0;
+            }
+            else if(flag_arr(i,j,k).isRegular())
+            {
+                cells[regular] += 1.0;
+            }
+            else
+            {
+                cells[cut] += 1.0;
+            }
+        }
+    }
+}
+
+Vector<Real> TileCost::boxWeights(int lev)
+{
+    Vector<Real> weights;
+
+    if(isEnabled() && lev < levels.size())
+    {
+        const LevelCost& level = levels[lev];
+        weights.assign(level.ba.size(), 0.0);
+        for(int b = 0; b < level.ba.size(); b++)
+        {
+            for(int n = 0; n < n_kernels; n++)
+            {
+                weights[b] += level.time[b * n_kernels + n];
+            }
+        }
+        ParallelDescriptor::ReduceRealSum(weights.dataPtr(), weights.size());
+    }
+
+    return weights;
+}
+
+void TileCost::writeWeights(const std::string& filename, int finest_level)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    Vector<Vector<Real>> weights(finest_level + 1);
+    for(int lev = 0; lev <= finest_level; lev++)
+    {
+        weights[lev] = boxWeights(lev);
+    }
+
+    if(ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream ofs(filename);
+        ofs.precision(17);
+        for(int lev = 0; lev <= finest_level; lev++)
+        {
+            ofs << weights[lev].size();
+            for(Real w : weights[lev])
+            {
+                ofs << ' ' << w;
+            }
+            ofs << '\n';
+        }
+    }
+}
+
+Vector<Vector<Real>> TileCost::readWeights(const std::string& filename)
+{
+    Vector<Vector<Real>> weights;
+
+    // The I/O rank decides for all, so that they all take part in the broadcast
+    int exists = ParallelDescriptor::IOProcessor() ? amrex::FileExists(filename) : 0;
+    ParallelDescriptor::Bcast(&exists, 1, ParallelDescriptor::IOProcessorNumber());
+
+    if(exists)
+    {
+        Vector<char> file_chars;
+        ParallelDescriptor::ReadAndBcastFile(filename, file_chars);
+        std::istringstream is(std::string(file_chars.dataPtr()));
+
+        std::string line;
+        while(std::getline(is, line))
+        {
+            std::istringstream lis(line);
+            int nboxes = 0;
+            lis >> nboxes;
+            weights.emplace_back(nboxes);
+            for(int b = 0; b < nboxes; b++)
+            {
+                lis >> weights.back()[b];
+            }
+        }
+    }
+
+    return weights;
+}
+
+void TileCost::write()
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    const int nstats = n_kernels * n_types * 3;
+
+    // Gather the statistics of all ranks (each rank fills its own slot)
+    Vector<Real> all_stats(nprocs * nstats, 0.0);
+    std::copy(&rank_stats[0][0][0], &rank_stats[0][0][0] + nstats,
+              all_stats.begin() + ParallelDescriptor::MyProc() * nstats);
+    ParallelDescriptor::ReduceRealSum(all_stats.dataPtr(), all_stats.size(), ioproc);
+
+    for(LevelCost& level : levels)
+    {
+        ParallelDescriptor::ReduceRealSum(level.time.dataPtr(), level.time.size(), ioproc);
+        ParallelDescriptor::ReduceRealSum(level.cells.dataPtr(), level.cells.size(), ioproc);
+    }
+
+    if(ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream ranks(file_prefix + ".ranks");
+        ranks << "# rank kernel type time tiles cells\n";
+        for(int p = 0; p < nprocs; p++)
+        {
+            for(int n = 0; n < n_kernels; n++)
+            {
+                for(int t = 0; t < n_types; t++)
+                {
+                    const Real* s = &all_stats[((p * n_kernels + n) * n_types + t) * 3];
+                    ranks << p << ' ' << kernel_names[n] << ' ' << type_names[t] << ' '
+                          << s[0] << ' ' << static_cast<long>(s[1]) << ' ' << static_cast<long>(s[2]) << '\n';
+                }
+            }
+        }
+
+        std::ofstream boxes(file_prefix + ".boxes");
+        boxes << "# level box rank lo hi regular_cells cut_cells covered_cells total";
+        for(int n = 0; n < n_kernels; n++)
+        {
+            boxes << ' ' << kernel_names[n];
+        }
+        boxes << '\n';
+        for(int lev = 0; lev < levels.size(); lev++)
+        {
+            const LevelCost& level = levels[lev];
+            for(int b = 0; b < level.ba.size(); b++)
+            {
+                const Box& bx = level.ba[b];
+                boxes << lev << ' ' << b << ' ' << level.dm[b];
+                for(int d = 0; d < AMREX_SPACEDIM; d++)
+                {
+                    boxes << ' ' << bx.smallEnd(d);
+                }
+                for(int d = 0; d < AMREX_SPACEDIM; d++)
+                {
+                    boxes << ' ' << bx.bigEnd(d);
+                }
+                for(int t = 0; t < n_types; t++)
+                {
+                    boxes << ' ' << static_cast<long>(level.cells[b * n_types + t]);
+                }
+
+                Real total = 0.0;
+                for(int n = 0; n < n_kernels; n++)
+                {
+                    total += level.time[b * n_kernels + n];
+                }
+                boxes << ' ' << total;
+                for(int n = 0; n < n_kernels; n++)
+                {
+                    boxes << ' ' << level.time[b * n_kernels + n];
+                }
+                boxes << '\n';
+            }
+        }
+
+        // Load imbalance of each kernel: maximum over average of the rank times
+        amrex::Print() << "\nTile costs written to " << file_prefix << ".ranks and "
+                       << file_prefix << ".boxes" << std::endl;
+        for(int n = 0; n < n_kernels; n++)
+        {
+            Real tmax = 0.0;
+            Real tsum = 0.0;
+            for(int p = 0; p < nprocs; p++)
+            {
+                Real tp = 0.0;
+                for(int t = 0; t < n_types; t++)
+                {
+                    tp += all_stats[((p * n_kernels + n) * n_types + t) * 3];
+                }
+                tmax = amrex::max(tmax, tp);
+                tsum += tp;
+            }
+            amrex::Print() << "  " << kernel_names[n] << ": max " << tmax << " s, imbalance "
+                           << (tsum > 0.0 ? tmax * nprocs / tsum : 1.0) << std::endl;
+        }
+    }
+}
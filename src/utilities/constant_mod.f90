@@ -1,8 +1,18 @@
 module constant
 
-   use amrex_fort_module, only : rt => amrex_real
+   use amrex_fort_module, only : rt => amrex_real, amrex_spacedim
    use iso_c_binding , only: c_int, c_char
 
+! Offset to the k-1 and k+1 neighbours: 1 in 3D, 0 in 2D where
+! the third direction is a single plane and has no derivatives
+   integer, parameter :: kz = amrex_spacedim - 2
+
+! Axisymmetric (RZ) coordinates, in 2D only: x is the radius, y the axis
+! and the third velocity component the swirl. r_lo is the radius of the
+! low x face of the domain, so that cell i is centred at r_lo + (i+1/2) dx
+   logical  :: rz = .false.
+   real(rt) :: r_lo = 0.0d0
+
 ! Gravitational acceleration
    real(rt) :: gravity(3)
 
@@ -30,6 +40,9 @@ module constant
 ! Fluid type
    character(:), allocatable :: fluid_model
 
+! Small cut-cell treatment: 0 = flux redistribution, 1 = state redistribution
+   integer :: redist_type = 0
+
 ! Initial conditions
    real(rt) :: ic_u
    real(rt) :: ic_v
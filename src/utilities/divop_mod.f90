@@ -26,9 +26,10 @@ contains
    !
    ! WARNING: fx, fy, fz HAS to be filled with at least 3 GHOST nodes
    !
+   ! All ncomp components are done in one call. The viscous wall fluxes
+   ! (eta present) are only defined for the three velocity components.
    !
-   !
-   subroutine compute_divop(lo, hi, &
+   subroutine compute_divop(lo, hi, ncomp, &
                             div, dlo, dhi,       &
                             vel,vllo,vlhi,       &
                             fx, fxlo, fxhi,      &
@@ -45,15 +46,19 @@ contains
                             bcent,    blo,  bhi, &
                             domlo, domhi,        &
                             dx, ng, eta,         & 
-                            cyl_speed) bind(C)
+                            ebvel) bind(C)
 
       use bc
+      use constant,             only: redist_type
       use amrex_eb_util_module, only: amrex_eb_interpolate_to_face_centroid_per_cell
       use eb_wallflux_mod,      only: compute_diff_wallflux
 
       ! Tile bounds (cell centered)
       integer(c_int),  intent(in   ) :: lo(3),  hi(3)
 
+      ! Number of components
+      integer(c_int),  intent(in   ) :: ncomp
+
       ! Array Bounds
       integer(c_int),  intent(in   ) :: dlo(3), dhi(3)
       integer(c_int),  intent(in   ) :: vllo(3), vlhi(3)
@@ -80,9 +85,9 @@ contains
 
       ! Arrays
       real(ar),        intent(in   ) ::                       &
-           & fx(fxlo(1):fxhi(1),fxlo(2):fxhi(2),fxlo(3):fxhi(3),3), &
-           & fy(fylo(1):fyhi(1),fylo(2):fyhi(2),fylo(3):fyhi(3),3), &
-           & fz(fzlo(1):fzhi(1),fzlo(2):fzhi(2),fzlo(3):fzhi(3),3), &
+           & fx(fxlo(1):fxhi(1),fxlo(2):fxhi(2),fxlo(3):fxhi(3),ncomp), &
+           & fy(fylo(1):fyhi(1),fylo(2):fyhi(2),fylo(3):fyhi(3),ncomp), &
+           & fz(fzlo(1):fzhi(1),fzlo(2):fzhi(2),fzlo(3):fzhi(3),ncomp), &
            & afrac_x(axlo(1):axhi(1),axlo(2):axhi(2),axlo(3):axhi(3)), &
            & afrac_y(aylo(1):ayhi(1),aylo(2):ayhi(2),aylo(3):ayhi(3)), &
            & afrac_z(azlo(1):azhi(1),azlo(2):azhi(2),azlo(3):azhi(3)), &
@@ -90,15 +95,17 @@ contains
            & cent_y(cylo(1):cyhi(1),cylo(2):cyhi(2),cylo(3):cyhi(3),2),&
            & cent_z(czlo(1):czhi(1),czlo(2):czhi(2),czlo(3):czhi(3),2),&
            & vfrac(vflo(1):vfhi(1),vflo(2):vfhi(2),vflo(3):vfhi(3)),   &
-           &   vel(vllo(1):vlhi(1),vllo(2):vlhi(2),vllo(3):vlhi(3),3), &
+           &   vel(vllo(1):vlhi(1),vllo(2):vlhi(2),vllo(3):vlhi(3),ncomp), &
            & bcent(blo(1):bhi(1),blo(2):bhi(2),blo(3):bhi(3),3)
 
-      ! Optional arrays (only for viscous calculations)
+      ! Optional arrays (only for viscous calculations): viscosity,
+      ! and velocity of the EB walls
       real(ar),        intent(in   ), optional  ::                &
-           &     eta(vflo(1):vfhi(1),vflo(2):vfhi(2),vflo(3):vfhi(3))
+           &     eta(vflo(1):vfhi(1),vflo(2):vfhi(2),vflo(3):vfhi(3)),   &
+           &   ebvel(vllo(1):vlhi(1),vllo(2):vlhi(2),vllo(3):vlhi(3),3)
 
       real(ar),        intent(inout) ::                           &
-           & div(dlo(1):dhi(1),dlo(2):dhi(2),dlo(3):dhi(3),3)
+           & div(dlo(1):dhi(1),dlo(2):dhi(2),dlo(3):dhi(3),ncomp)
 
       ! BC types
       integer(c_int), intent(in   ) ::  &
@@ -111,14 +118,12 @@ contains
            &  delm(lo(1)-2:hi(1)+2,lo(2)-2:hi(2)+2,lo(3)-2:hi(3)+2), &
            &  mask(lo(1)-2:hi(1)+2,lo(2)-2:hi(2)+2,lo(3)-2:hi(3)+2)
 
-      ! Rotating cylinder 
-      real(rt),       intent(in   ), optional :: cyl_speed
-
       ! Local variables
       real(ar), allocatable :: divdiff_w(:,:)
       integer(c_int)        :: i, j, k, n, nbr(-1:1,-1:1,-1:1)
       integer(c_int)        :: nwalls
       real(ar)              :: idx, idy, idz
+      real(ar)              :: ubw(3)
       logical               :: is_dirichlet
 
       idx = one / dx(1)
@@ -135,6 +140,10 @@ contains
          is_dirichlet = .false.
       end if
 
+      if (is_dirichlet .and. ncomp /= 3) then
+         call amrex_abort("compute_divop(): viscous wall fluxes need ncomp = 3")
+      end if
+
       if ( abs(dx(1) - dx(2)) > epsilon(0.0_ar) .or.&
            abs(dx(1) - dx(3)) > epsilon(0.0_ar) .or.&
            abs(dx(3) - dx(2)) > epsilon(0.0_ar) ) then
@@ -178,7 +187,7 @@ contains
       !
       ! We use the EB algorithmm to compute the divergence at cell centers
       !
-      ncomp_loop: do n = 1, 3
+      ncomp_loop: do n = 1, ncomp
 
          !
          ! Step 1: compute conservative divergence on stencil (lo-2,hi+2)
@@ -232,6 +241,11 @@ contains
                         iwall = iwall + 1
                         if (is_dirichlet) then
                            if (n==1) then
+                              if (present(ebvel)) then
+                                 ubw = ebvel(i,j,k,:)
+                              else
+                                 ubw = zero
+                              end if
                               call compute_diff_wallflux(divdiff_w(:,iwall),  &
                                                          dx, i, j, k,         &
                                                          vel, vllo, vlhi,     &
@@ -241,7 +255,7 @@ contains
                                                          afrac_y, aylo, ayhi, &
                                                          afrac_z, azlo, azhi, & 
                                                          vfrac, vflo, vfhi,   & 
-                                                         cyl_speed)
+                                                         ubw)
                            end if
                            divc(i,j,k) = divc(i,j,k) - divdiff_w(n,iwall) / (dx(n) * vfrac(i,j,k))
                         end if
@@ -259,6 +273,22 @@ contains
             end do
          end block compute_divc
 
+         !
+         ! State redistribution replaces steps 2 and 3 below
+         !
+         if (redist_type == 1) then
+            call state_redistribution(lo, hi, divc, optmp, flags, flo, fhi, &
+                                      vfrac, vflo, vfhi, domlo, domhi)
+            do k = lo(3), hi(3)
+               do j = lo(2), hi(2)
+                  do i = lo(1), hi(1)
+                     div(i,j,k,n) = optmp(i,j,k)
+                  end do
+               end do
+            end do
+            cycle ncomp_loop
+         end if
+
          !
          ! Step 2: compute delta M ( mass gain or loss ) on (lo-1,hi+1)
          !
@@ -366,4 +396,148 @@ contains
 
    end subroutine compute_divop
 
+   !
+   ! State redistribution of the conservative divergence, with piecewise constant
+   ! neighbourhood averages (Berger & Giuliani, J. Comput. Phys. 428, 2021).
+   !
+   ! Each small cut cell (vfrac < 1/2) is merged with its connected neighbours into a
+   ! neighbourhood; every other cell is its own neighbourhood. With nrs(j) the number
+   ! of neighbourhoods cell j belongs to, the neighbourhood averages
+   !
+   !    qhat(i) = sum_{j in N(i)} vfrac(j) divc(j) / nrs(j) / sum_{j in N(i)} vfrac(j) / nrs(j)
+   !
+   ! are spread back as  div(j) = sum_{i : j in N(i)} qhat(i) / nrs(j).
+   ! This conserves sum vfrac * div, and removes the 1/vfrac factor of small cells
+   ! from the update, so that the time step is set by the full cells.
+   !
+   ! INPUTS:  divc on (lo-2,hi+2), flags and vfrac on (lo-4,hi+4)
+   ! OUTPUTS: div on (lo,hi)
+   !
+   subroutine state_redistribution(lo, hi, divc, div, flags, flo, fhi, &
+                                   vfrac, vflo, vfhi, domlo, domhi)
+
+      use bc, only: cyclic_x, cyclic_y, cyclic_z
+
+      integer(c_int),  intent(in   ) :: lo(3), hi(3)
+      integer(c_int),  intent(in   ) :: flo(3), fhi(3), vflo(3), vfhi(3)
+      integer(c_int),  intent(in   ) :: domlo(3), domhi(3)
+
+      real(ar),        intent(in   ) :: divc(lo(1)-2:hi(1)+2,lo(2)-2:hi(2)+2,lo(3)-2:hi(3)+2)
+      real(ar),        intent(  out) ::  div(lo(1)-2:hi(1)+2,lo(2)-2:hi(2)+2,lo(3)-2:hi(3)+2)
+      real(ar),        intent(in   ) :: vfrac(vflo(1):vfhi(1),vflo(2):vfhi(2),vflo(3):vfhi(3))
+      integer(c_int),  intent(in   ) :: flags(flo(1):fhi(1),flo(2):fhi(2),flo(3):fhi(3))
+
+      ! Local variables
+      logical  :: small(lo(1)-3:hi(1)+3,lo(2)-3:hi(2)+3,lo(3)-3:hi(3)+3)
+      real(ar) ::  mask(lo(1)-4:hi(1)+4,lo(2)-4:hi(2)+4,lo(3)-4:hi(3)+4)
+      real(ar) ::   nrs(lo(1)-2:hi(1)+2,lo(2)-2:hi(2)+2,lo(3)-2:hi(3)+2)
+      real(ar) ::  qhat(lo(1)-1:hi(1)+1,lo(2)-1:hi(2)+1,lo(3)-1:hi(3)+1)
+      real(ar) :: num, den
+      integer  :: i, j, k, ii, jj, kk, nbr(-1:1,-1:1,-1:1)
+
+      ! Sever the link to ghost cells when the BCs are not periodic
+      do k = lo(3)-4, hi(3)+4
+         do j = lo(2)-4, hi(2)+4
+            do i = lo(1)-4, hi(1)+4
+               if ( ( .not. cyclic_x .and. (i < domlo(1) .or. i > domhi(1)) ) .or. &
+                    ( .not. cyclic_y .and. (j < domlo(2) .or. j > domhi(2)) ) .or. &
+                    ( .not. cyclic_z .and. (k < domlo(3) .or. k > domhi(3)) ) ) then
+                  mask(i,j,k) = zero
+               else
+                  mask(i,j,k) = one
+               end if
+            end do
+         end do
+      end do
+
+      ! Cells owning a merged neighbourhood
+      do k = lo(3)-3, hi(3)+3
+         do j = lo(2)-3, hi(2)+3
+            do i = lo(1)-3, hi(1)+3
+               small(i,j,k) = is_single_valued_cell(flags(i,j,k)) .and. &
+                              vfrac(i,j,k) < half .and. mask(i,j,k) > zero
+            end do
+         end do
+      end do
+
+      ! Number of neighbourhoods each cell belongs to
+      nrs = one
+      do k = lo(3)-3, hi(3)+3
+         do j = lo(2)-3, hi(2)+3
+            do i = lo(1)-3, hi(1)+3
+               if (small(i,j,k)) then
+                  call get_neighbor_cells(flags(i,j,k), nbr)
+                  do kk = -1, 1
+                     do jj = -1, 1
+                        do ii = -1, 1
+                           if ( ( ii /= 0 .or. jj /= 0 .or. kk /= 0 ) .and. nbr(ii,jj,kk) == 1 &
+                                .and. i+ii >= lo(1)-2 .and. i+ii <= hi(1)+2 &
+                                .and. j+jj >= lo(2)-2 .and. j+jj <= hi(2)+2 &
+                                .and. k+kk >= lo(3)-2 .and. k+kk <= hi(3)+2 ) then
+                              nrs(i+ii,j+jj,k+kk) = nrs(i+ii,j+jj,k+kk) + mask(i+ii,j+jj,k+kk)
+                           end if
+                        end do
+                     end do
+                  end do
+               end if
+            end do
+         end do
+      end do
+
+      ! Neighbourhood averages
+      do k = lo(3)-1, hi(3)+1
+         do j = lo(2)-1, hi(2)+1
+            do i = lo(1)-1, hi(1)+1
+               if (small(i,j,k)) then
+                  call get_neighbor_cells(flags(i,j,k), nbr)
+                  num = zero
+                  den = zero
+                  do kk = -1, 1
+                     do jj = -1, 1
+                        do ii = -1, 1
+                           if ( nbr(ii,jj,kk) == 1 .or. ( ii == 0 .and. jj == 0 .and. kk == 0 ) ) then
+                              num = num + mask(i+ii,j+jj,k+kk) * vfrac(i+ii,j+jj,k+kk) &
+                                   * divc(i+ii,j+jj,k+kk) / nrs(i+ii,j+jj,k+kk)
+                              den = den + mask(i+ii,j+jj,k+kk) * vfrac(i+ii,j+jj,k+kk) &
+                                   / nrs(i+ii,j+jj,k+kk)
+                           end if
+                        end do
+                     end do
+                  end do
+                  qhat(i,j,k) = num / den
+               else if (.not. is_covered_cell(flags(i,j,k))) then
+                  qhat(i,j,k) = divc(i,j,k)
+               end if
+            end do
+         end do
+      end do
+
+      ! Spread the neighbourhood averages back to the cells
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+               if (is_covered_cell(flags(i,j,k))) then
+                  div(i,j,k) = divc(i,j,k)
+               else
+                  num = qhat(i,j,k)
+                  do kk = -1, 1
+                     do jj = -1, 1
+                        do ii = -1, 1
+                           if ( ( ii /= 0 .or. jj /= 0 .or. kk /= 0 ) ) then
+                              if (small(i+ii,j+jj,k+kk)) then
+                                 call get_neighbor_cells(flags(i+ii,j+jj,k+kk), nbr)
+                                 if (nbr(-ii,-jj,-kk) == 1) num = num + mask(i,j,k) * qhat(i+ii,j+jj,k+kk)
+                              end if
+                           end if
+                        end do
+                     end do
+                  end do
+                  div(i,j,k) = num / nrs(i,j,k)
+               end if
+            end do
+         end do
+      end do
+
+   end subroutine state_redistribution
+
 end module divop_mod
@@ -15,7 +15,8 @@ void GotoNextLine(std::istream& is)
 }
 
 void incflo::WriteHeader(
-	const std::string& name, bool is_checkpoint) const
+	const std::string& name, bool is_checkpoint, int ro_is_uniform, Real ro_uniform,
+	int eta_is_uniform, Real eta_uniform) const
 {
 	if(ParallelDescriptor::IOProcessor())
 	{
@@ -33,7 +34,9 @@ void incflo::WriteHeader(
 
 		HeaderFile.precision(17);
 
-		if(is_checkpoint)
+		if(is_checkpoint && check_minimal)
+			HeaderFile << "Checkpoint version: 2\n";
+		else if(is_checkpoint)
 			HeaderFile << "Checkpoint version: 1\n";
 		else
 			HeaderFile << "HyperCLaw-V1.1\n";
@@ -60,12 +63,20 @@ void incflo::WriteHeader(
 			boxArray(lev).writeOn(HeaderFile);
 			HeaderFile << '\n';
 		}
+
+		// Minimal checkpoints skip the density and the viscosity when they are uniform
+		if(is_checkpoint && check_minimal)
+		{
+			HeaderFile << ro_is_uniform << ' ' << ro_uniform << ' '
+			           << eta_is_uniform << ' ' << eta_uniform << '\n';
+		}
 	}
 }
 
 void incflo::WriteCheckPointFile() const
 {
 	BL_PROFILE("incflo::WriteCheckPointFile()");
+	PerfLog::Timer perf_timer(PerfLog::io);
 
 	const std::string& checkpointname = amrex::Concatenate(check_file, nstep);
 
@@ -73,10 +84,81 @@ void incflo::WriteCheckPointFile() const
 
 	amrex::PreBuildDirectorHierarchy(checkpointname, level_prefix, finest_level + 1, true);
 
+    // Check whether the density and the viscosity are uniform, in which case the
+    // minimal checkpoint stores only their value in the header. eta is not derived
+    // from the velocity again on restart: it is the average of the predictor and
+    // corrector values, and sets the viscous time step.
+    Real ro_min = ro[0]->min(0);
+    Real ro_max = ro[0]->max(0);
+    Real eta_min = eta[0]->min(0);
+    Real eta_max = eta[0]->max(0);
+    for(int lev = 1; lev <= finest_level; ++lev)
+    {
+        ro_min = amrex::min(ro_min, ro[lev]->min(0));
+        ro_max = amrex::max(ro_max, ro[lev]->max(0));
+        eta_min = amrex::min(eta_min, eta[lev]->min(0));
+        eta_max = amrex::max(eta_max, eta[lev]->max(0));
+    }
+    int ro_is_uniform = (ro_min == ro_max);
+    int eta_is_uniform = (eta_min == eta_max);
+
     bool is_checkpoint = true;
-	WriteHeader(checkpointname, is_checkpoint);
+	WriteHeader(checkpointname, is_checkpoint, ro_is_uniform, ro_min, eta_is_uniform, eta_min);
 	WriteJobInfo(checkpointname);
 
+    if(tracers) tracers->WriteTracers(checkpointname, is_checkpoint);
+
+    // Measured box costs, for load balancing on restart
+    TileCost::writeWeights(checkpointname + "/TileCost", finest_level);
+
+    if(check_minimal)
+    {
+        for(int lev = 0; lev <= finest_level; ++lev)
+        {
+            // Only the valid region is written: ghost cells are refilled on restart
+            MultiFab vel_chk(grids[lev], dmap[lev], 3, 0);
+            MultiFab::Copy(vel_chk, *vel[lev], 0, 0, 3, 0);
+            VisMF::Write(vel_chk, 
+                    amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, vecVarsName[0]));
+
+            MultiFab p_chk(p[lev]->boxArray(), dmap[lev], 1, 0);
+            MultiFab::Copy(p_chk, *p[lev], 0, 0, 1, 0);
+            VisMF::Write(p_chk,
+                    amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "p"));
+
+            // gp is the projection's own gradient, which p alone cannot reproduce to the bit
+            MultiFab gp_chk(grids[lev], dmap[lev], 3, 0);
+            MultiFab::Copy(gp_chk, *gp[lev], 0, 0, 3, 0);
+            VisMF::Write(gp_chk,
+                    amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, vecVarsName[3]));
+
+            if(!ro_is_uniform)
+            {
+                MultiFab ro_chk(grids[lev], dmap[lev], 1, 0);
+                MultiFab::Copy(ro_chk, *ro[lev], 0, 0, 1, 0);
+                VisMF::Write(ro_chk,
+                        amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "ro"));
+            }
+
+            if(!eta_is_uniform)
+            {
+                MultiFab eta_chk(grids[lev], dmap[lev], 1, 0);
+                MultiFab::Copy(eta_chk, *eta[lev], 0, 0, 1, 0);
+                VisMF::Write(eta_chk,
+                        amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "eta"));
+            }
+
+            if(nscal > 0)
+            {
+                MultiFab scal_chk(grids[lev], dmap[lev], nscal, 0);
+                MultiFab::Copy(scal_chk, *scal[lev], 0, 0, nscal, 0);
+                VisMF::Write(scal_chk,
+                        amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "scal"));
+            }
+        }
+        return;
+    }
+
 	for(int lev = 0; lev <= finest_level; ++lev)
 	{
 
@@ -97,6 +179,13 @@ void incflo::WriteCheckPointFile() const
 						 amrex::MultiFabFileFullPrefix(
 							 lev, checkpointname, level_prefix, chkscaVarsName[i]));
 		}
+
+		// All the passive scalars in one file
+		if(nscal > 0)
+		{
+			VisMF::Write(*scal[lev],
+						 amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "scal"));
+		}
 	}
 }
 
@@ -128,8 +217,9 @@ void incflo::ReadCheckpointFile()
 
     // Start reading from checkpoint file 
     
-    // Title line
+    // Title line: version 2 denotes a minimal checkpoint
     std::getline(is, line);
+    const bool restart_is_minimal = (line.find("version: 2") != std::string::npos);
 
     // Finest level
     is >> finest_level;
@@ -177,6 +267,13 @@ void incflo::ReadCheckpointFile()
                                   Geom(lev).isPeriodic()));
     }
 
+    // Measured box costs of all levels, if there are any
+    Vector<Vector<Real>> weights;
+    if(tile_cost_balance)
+    {
+        weights = TileCost::readWeights(restart_file + "/TileCost");
+    }
+
     for(int lev = 0; lev <= finest_level; ++lev)
     {
         // read in level 'lev' BoxArray from Header
@@ -184,16 +281,80 @@ void incflo::ReadCheckpointFile()
         ba.readFrom(is);
         GotoNextLine(is);
 
-        // Create distribution mapping
-        DistributionMapping dm{ba, ParallelDescriptor::NProcs()};
+        // Create distribution mapping, from the measured box costs if there are any
+        DistributionMapping dm = (lev < weights.size() && weights[lev].size() == ba.size()) ?
+                                 DistributionMapping::makeKnapSack(weights[lev]) :
+                                 DistributionMapping{ba, ParallelDescriptor::NProcs()};
 
         MakeNewLevelFromScratch(lev, cur_time, ba, dm);
     }
 
+    // Uniform density and viscosity flags and values (minimal checkpoints only)
+    int ro_is_uniform = 0;
+    Real ro_uniform = 0.0;
+    int eta_is_uniform = 0;
+    Real eta_uniform = 0.0;
+    if(restart_is_minimal)
+    {
+        is >> ro_is_uniform >> ro_uniform >> eta_is_uniform >> eta_uniform;
+        GotoNextLine(is);
+    }
+
 	/***************************************************************************
      * Load fluid data                                                         *
      ***************************************************************************/
 
+    if(restart_is_minimal)
+    {
+        for(int lev = 0; lev <= finest_level; ++lev)
+        {
+            MultiFab mf_vel;
+            VisMF::Read(mf_vel, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "velx"));
+            vel[lev]->copy(mf_vel, 0, 0, 3, 0, 0);
+
+            MultiFab mf_p;
+            VisMF::Read(mf_p, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "p"));
+            p[lev]->copy(mf_p, 0, 0, 1, 0, 0);
+
+            MultiFab mf_gp;
+            VisMF::Read(mf_gp, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "gpx"));
+            gp[lev]->copy(mf_gp, 0, 0, 3, 0, 0);
+
+            // Valid cells only, as the full format reads them
+            if(ro_is_uniform)
+            {
+                ro[lev]->setVal(ro_uniform, 0, 1, 0);
+            }
+            else
+            {
+                MultiFab mf_ro;
+                VisMF::Read(mf_ro, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "ro"));
+                ro[lev]->copy(mf_ro, 0, 0, 1, 0, 0);
+            }
+
+            if(eta_is_uniform)
+            {
+                eta[lev]->setVal(eta_uniform, 0, 1, 0);
+            }
+            else
+            {
+                MultiFab mf_eta;
+                VisMF::Read(mf_eta, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "eta"));
+                eta[lev]->copy(mf_eta, 0, 0, 1, 0, 0);
+            }
+
+            if(nscal > 0)
+            {
+                MultiFab mf_scal;
+                VisMF::Read(mf_scal, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "scal"));
+                scal[lev]->copy(mf_scal, 0, 0, nscal, 0, 0);
+            }
+        }
+
+        amrex::Print() << "Restart complete (minimal checkpoint)" << std::endl;
+        return;
+    }
+
 	// Load the field data
 	for(int lev = 0; lev <= finest_level; ++lev)
 	{
@@ -223,6 +384,13 @@ void incflo::ReadCheckpointFile()
 
             (*chkscalarVars[i])[lev]->copy(mf, 0, 0, 1, 0, 0);
 		}
+
+		if(nscal > 0)
+		{
+			MultiFab mf_scal;
+			VisMF::Read(mf_scal, MultiFabFileFullPrefix(lev, restart_file, level_prefix, "scal"));
+			scal[lev]->copy(mf_scal, 0, 0, nscal, 0, 0);
+		}
 	}
 
 	amrex::Print() << "Restart complete" << std::endl;
@@ -319,6 +487,7 @@ void incflo::WritePlotFile() const
 {
 
 	BL_PROFILE("incflo::WritePlotFile()");
+	PerfLog::Timer perf_timer(PerfLog::io);
 
 	const std::string& plotfilename = amrex::Concatenate(plot_file, nstep);
 
@@ -380,6 +549,10 @@ void incflo::WritePlotFile() const
         if(plt_vfrac == 1) 
             pltscaVarsName.push_back("vfrac");
 
+        // Passive scalars
+        for(int n = 0; n < nscal; n++)
+            pltscaVarsName.push_back(scal_names[n]);
+
         // Now fill the data at every level
 
 	for(int lev = 0; lev <= finest_level; ++lev)
@@ -486,6 +659,14 @@ void incflo::WritePlotFile() const
                 lc += 1;
             }
 
+            // Passive scalars
+            if(nscal > 0)
+            {
+                MultiFab::Copy(*mf[lev], (*scal[lev]), 0, lc, nscal, 0);
+
+                lc += nscal;
+            }
+
             // Zero out all the values in covered cells
             EB_set_covered(*mf[lev], 0.0);
         }
@@ -499,5 +680,7 @@ void incflo::WritePlotFile() const
         amrex::WriteMultiLevelPlotfile(plotfilename, finest_level + 1, GetVecOfConstPtrs(mf), 
                                    pltscaVarsName, Geom(), cur_time, istep, refRatio());
 
+        if(tracers) tracers->WriteTracers(plotfilename, false);
+
 	WriteJobInfo(plotfilename);
 }
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Analysis of the taylor_green_vortices_checkpoint regression test.
+
+A restart from a minimal checkpoint (amr.check_minimal = 1) must continue exactly as
+a restart from a full one. The test writes full checkpoints on its way to the plotfile
+it ends with; the script then runs the case again up to --restart-step writing minimal
+checkpoints, restarts from the full and from the minimal checkpoint of that step up to
+the step of the plotfile, and compares the two plotfiles byte for byte:
+
+  ./checkpoint_formats.py plt00020 [--restart-step 10] [--launcher "mpiexec -n 8"]
+
+The executable and the inputs file are found next to the plotfile, where regtest.py
+runs the test (analysisRoutine). The script exits with status 1 if the plotfiles
+differ.
+"""
+
+import argparse
+import filecmp
+import glob
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+
+def find_one(run_dir, pattern, what):
+    """The single file of run_dir matching pattern."""
+    files = glob.glob(os.path.join(run_dir, pattern))
+    if len(files) != 1:
+        sys.exit("checkpoint_formats: expected one {} in {}, found {}".format(what, run_dir, len(files)))
+    return os.path.basename(files[0])
+
+
+def run(run_dir, launcher, exe, inputs, params):
+    """Run incflo on inputs in run_dir with the extra runtime parameters."""
+    cmd = shlex.split(launcher) + ["./" + exe, inputs] + params
+    print("checkpoint_formats: " + " ".join(cmd))
+    with open(os.path.join(run_dir, "checkpoint_formats.out"), "a") as out:
+        subprocess.check_call(cmd, cwd=run_dir, stdout=out, stderr=subprocess.STDOUT)
+
+
+def compare_plotfiles(a, b):
+    """Files of plotfile a that differ from those of b (job_info holds timings and dates)."""
+    differ = []
+    for root, dirs, files in os.walk(a):
+        for name in files:
+            if name == "job_info":
+                continue
+            path = os.path.join(root, name)
+            other = os.path.join(b, os.path.relpath(path, a))
+            if not os.path.exists(other) or not filecmp.cmp(path, other, shallow=False):
+                differ.append(os.path.relpath(path, a))
+    return differ
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("plotfile", help="last plotfile of the test")
+    parser.add_argument("--restart-step", type=int, default=10, help="step of the checkpoints to restart from")
+    parser.add_argument("--launcher", default="", help="command to run incflo with, e.g. mpiexec -n 8")
+    args = parser.parse_args()
+
+    run_dir = os.path.dirname(os.path.abspath(args.plotfile))
+    plotfile = os.path.basename(os.path.normpath(args.plotfile))
+    step = int(re.search(r"(\d+)$", plotfile).group(1))
+    exe = find_one(run_dir, "*.ex", "executable")
+    inputs = find_one(run_dir, "benchmark.*", "inputs file")
+
+    full_chk = "chk{:05d}".format(args.restart_step)
+    min_chk = "chk_min{:05d}".format(args.restart_step)
+
+    # Minimal checkpoint of the same state as the full one the test wrote
+    run(run_dir, args.launcher, exe, inputs,
+        ["max_step={}".format(args.restart_step), "amr.plot_int=-1",
+         "amr.check_minimal=1", "amr.check_file=chk_min"])
+
+    # Restarts from either, without writing any more checkpoints
+    for chk, plt in [(full_chk, "plt_full"), (min_chk, "plt_min")]:
+        run(run_dir, args.launcher, exe, inputs,
+            ["max_step={}".format(step), "amr.restart=" + chk, "amr.check_int=-1",
+             "amr.plot_int={}".format(step), "amr.plot_file=" + plt])
+
+    suffix = "{:05d}".format(step)
+    plt_full = os.path.join(run_dir, "plt_full" + suffix)
+    plt_min = os.path.join(run_dir, "plt_min" + suffix)
+    for plt in [plt_full, plt_min]:
+        if not os.path.isdir(plt):
+            sys.exit("checkpoint_formats: {} was not written".format(plt))
+    differ = compare_plotfiles(plt_full, plt_min)
+    if differ:
+        print("checkpoint_formats: restarts from {} and {} differ in {}".format(
+            full_chk, min_chk, " ".join(sorted(differ))))
+        sys.exit(1)
+    print("checkpoint_formats: restarts from {} and {} are identical".format(full_chk, min_chk))
+
+
+if __name__ == "__main__":
+    main()
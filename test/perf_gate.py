@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Performance gate of the regression tests.
+
+Every test of incflo-tests.ini writes its per-step timings to perf.jsonl in its run
+directory (incflo.perf_log, set with runtime_params). After a regtest.py run, this
+script reads them, compares the time of a step and of each phase of every test with
+a baseline from the history of earlier runs, flags the tests that got slower, and
+appends the run to the history:
+
+  ./perf_gate.py ${REGTEST_SCRATCH}/test_data/incflo/incflo-tests/<date> \\
+      --history ${REGTEST_SCRATCH}/test_data/incflo/perf_history.jsonl
+
+The baseline of a test is the median of its last --runs runs in the history, or the
+run with the given --baseline label. A step or phase is flagged when it is slower than
+the baseline by more than --tolerance (relative); phases taking less than --min-time
+seconds per step are too noisy to be compared. The script exits with status 1 if a
+test was flagged, so that it can gate a merge.
+
+Only a run without flagged tests is added to the history, so that a regression does
+not become part of the baseline. A flagged run that is an accepted slowdown (e.g. for
+more accuracy) is recorded with --accept.
+
+The restart tests append both of their runs to the same perf.jsonl: the first --skip
+steps of each run are left out.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import subprocess
+import sys
+
+from scaling import PHASES, read_perf_log
+
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    return values[n // 2] if n % 2 else 0.5 * (values[n // 2 - 1] + values[n // 2])
+
+
+def read_history(filename):
+    history = []
+    if os.path.exists(filename):
+        with open(filename) as f:
+            for line in f:
+                line = line.strip()
+                if line:
+                    history.append(json.loads(line))
+    return history
+
+
+def baseline(history, test, runs, label):
+    """Step and phase times of the baseline of a test, or None without history."""
+    entries = [h for h in history if h["test"] == test]
+    if label:
+        entries = [h for h in entries if h["label"] == label]
+    entries = entries[-runs:]
+    if not entries:
+        return None
+
+    base = {"step": median([h["step"] for h in entries]), "phases": {}, "runs": len(entries)}
+    for p in PHASES:
+        times = [h["phases"][p] for h in entries if p in h["phases"]]
+        if times:
+            base["phases"][p] = median(times)
+    return base
+
+
+def default_label():
+    top = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    try:
+        return subprocess.check_output(["git", "describe", "--always", "--dirty"], cwd=top,
+                                       stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("run_dir", help="directory of a regtest.py run, with a subdirectory per test")
+    parser.add_argument("--history", default="perf_history.jsonl", help="history of the earlier runs")
+    parser.add_argument("--tolerance", type=float, default=0.10, help="relative slowdown that is flagged")
+    parser.add_argument("--runs", type=int, default=5, help="number of earlier runs in the baseline")
+    parser.add_argument("--baseline", default="", help="compare with the run of this label instead")
+    parser.add_argument("--min-time", type=float, default=1.0e-3, help="shortest phase time compared (s/step)")
+    parser.add_argument("--skip", type=int, default=1, help="number of untimed steps at the start of each run")
+    parser.add_argument("--label", default="", help="name of this run in the history (default: git commit)")
+    parser.add_argument("--no-record", action="store_true", help="do not add this run to the history")
+    parser.add_argument("--accept", action="store_true",
+                        help="add this run to the history even if tests were flagged")
+    args = parser.parse_args()
+
+    label = args.label or default_label()
+    date = datetime.datetime.now().isoformat(timespec="seconds")
+    history = read_history(args.history)
+
+    tests = sorted(d for d in os.listdir(args.run_dir)
+                   if os.path.isfile(os.path.join(args.run_dir, d, "perf.jsonl")))
+    if not tests:
+        sys.exit("no perf.jsonl found in the test directories of " + args.run_dir)
+
+    print("{:<32} {:>10} {:>10} {:>8}  {}".format("test", "s/step", "baseline", "ratio", "slower phases"))
+    flagged = []
+    records = []
+    for test in tests:
+        try:
+            summary = read_perf_log(os.path.join(args.run_dir, test, "perf.jsonl"), args.skip)
+        except (RuntimeError, ValueError, KeyError) as e:
+            print("{:<32} unreadable performance log: {}".format(test, e))
+            continue
+
+        record = {
+            "test": test,
+            "label": label,
+            "date": date,
+            "steps": summary["steps"],
+            "step": summary["step"],
+            "phases": {p: summary["phases"][p] for p in PHASES if p in summary["phases"]},
+            "solves": summary["solves"],
+        }
+        records.append(record)
+
+        base = baseline(history, test, args.runs, args.baseline)
+        if base is None:
+            print("{:<32} {:>10.4f} {:>10} {:>8}".format(test, record["step"], "-", "-"))
+            continue
+
+        ratio = record["step"] / base["step"]
+        slower = []
+        for p, t in record["phases"].items():
+            if p in base["phases"] and base["phases"][p] >= args.min_time and t > (1.0 + args.tolerance) * base["phases"][p]:
+                slower.append("{} x{:.2f}".format(p, t / base["phases"][p]))
+        if ratio > 1.0 + args.tolerance or slower:
+            flagged.append(test)
+
+        print("{:<32} {:>10.4f} {:>10.4f} {:>8.3f}  {}".format(
+            test, record["step"], base["step"], ratio, ", ".join(slower)))
+
+    record = not args.no_record and (not flagged or args.accept)
+    if record:
+        with open(args.history, "a") as f:
+            for r in records:
+                f.write(json.dumps(r) + "\n")
+
+    if flagged:
+        print("\n{} test(s) slower than the baseline by more than {:.0f}%: {}".format(
+            len(flagged), 100 * args.tolerance, " ".join(flagged)))
+        if not record and not args.no_record:
+            print("Run not added to the history (use --accept to record it)")
+        sys.exit(1)
+    print("\nNo performance regression above {:.0f}%".format(100 * args.tolerance))
+
+
+if __name__ == "__main__":
+    main()
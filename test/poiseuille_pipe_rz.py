@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""
+Analysis of the poiseuille_pipe_rz regression test.
+
+The axial velocity of the developed flow in a pipe of radius R, driven by the pressure
+gradient G = delp / length with viscosity mu, is the parabolic profile
+
+  w(r) = G / (4 mu) (R^2 - r^2)
+
+With the parameters of benchmark.poiseuille_pipe_rz (R = 1, G = 2 / 0.5, mu = 1) it
+peaks at 1 on the axis. The transient from rest decays as exp(-5.78 t), well below the
+tolerance at the stop time. The script reads the plotfile the test wrote last, and
+checks the axial velocity (vely: x is the radius, y the axis) in every cell against the
+profile at the cell centre:
+
+  ./poiseuille_pipe_rz.py plt00200 [--tolerance 0.01]
+
+regtest.py runs it through analysisRoutine; it exits with status 1 if the error,
+relative to the peak velocity, exceeds the tolerance.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+RADIUS = 1.0
+GRADIENT = 2.0 / 0.5
+MU = 1.0
+
+
+def read_header(plotfile):
+    """Variable names, domain, problem lower corner and cell size of level 0."""
+    with open(os.path.join(plotfile, "Header")) as f:
+        lines = [line.strip() for line in f]
+
+    ncomp = int(lines[1])
+    names = lines[2:2 + ncomp]
+    pos = 2 + ncomp
+    dim = int(lines[pos])
+    prob_lo = [float(x) for x in lines[pos + 3].split()]
+    domain = [int(x) for x in re.findall(r"-?\d+", lines[pos + 6])][:2 * dim]
+    dx = [float(x) for x in lines[pos + 8].split()]
+    return names, dim, domain, prob_lo, dx
+
+
+def read_level0(plotfile, comp):
+    """Values of component comp on level 0, as a dict from the cell index to the value."""
+    level_dir = os.path.join(plotfile, "Level_0")
+    with open(os.path.join(level_dir, "Cell_H")) as f:
+        fabs = re.findall(r"FabOnDisk:\s+(\S+)\s+(\d+)", f.read())
+
+    values = {}
+    for filename, offset in fabs:
+        with open(os.path.join(level_dir, filename), "rb") as f:
+            f.seek(int(offset))
+            header = f.readline().decode()
+            nbytes = int(re.search(r"FAB \(\((\d+),", header).group(1))
+            order = re.search(r"\),\(\d+, \((\d+)", header).group(1)
+            box = [int(x) for x in re.findall(r"-?\d+", header.split(")))")[1])]
+            dim = (len(box) - 1) // 3
+            lo, hi = box[:dim], box[dim:2 * dim]
+
+            shape = [hi[d] - lo[d] + 1 for d in range(dim)]
+            npts = 1
+            for n in shape:
+                npts *= n
+            fmt = ("<" if order == "1" else ">") + ("d" if nbytes == 8 else "f")
+            f.seek(comp * npts * nbytes, 1)
+            data = struct.unpack(fmt[0] + str(npts) + fmt[1], f.read(npts * nbytes))
+
+            # Fortran order: the first index runs fastest
+            for n, v in enumerate(data):
+                index = []
+                for d in range(dim):
+                    index.append(lo[d] + n % shape[d])
+                    n //= shape[d]
+                values[tuple(index)] = v
+    return values
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("plotfile", help="plotfile of the test")
+    parser.add_argument("--tolerance", type=float, default=0.01,
+                        help="largest error relative to the peak velocity")
+    args = parser.parse_args()
+
+    names, dim, domain, prob_lo, dx = read_header(args.plotfile)
+    if dim != 2:
+        sys.exit("poiseuille_pipe_rz: expected a 2D (RZ) plotfile")
+
+    peak = GRADIENT / (4.0 * MU) * RADIUS**2
+    error = 0.0
+    for (i, j), w in read_level0(args.plotfile, names.index("vely")).items():
+        r = prob_lo[0] + (i + 0.5) * dx[0]
+        exact = GRADIENT / (4.0 * MU) * (RADIUS**2 - r**2)
+        error = max(error, abs(w - exact))
+
+    print("poiseuille_pipe_rz: max |w - w_exact| / w_max = {:.3e} (tolerance {:.1e})"
+          .format(error / peak, args.tolerance))
+    sys.exit(1 if error > args.tolerance * peak else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+"""
+Strong and weak scaling harness for incflo.
+
+Runs one inputs file (test/benchmark.* or exec/inputs.*) for a number of steps over a
+list of MPI ranks x OpenMP threads configurations on the local machine, reads the
+per-step timings of the performance log (incflo.perf_log) and prints efficiency tables.
+
+  strong  amr.n_cell is kept, the same problem runs on more cores
+  weak    amr.n_cell is refined with the number of cores, so that every core keeps
+          the work of the first configuration (the domain is kept, the mesh is refined)
+
+amr.max_grid_size (and amr.max_grid_size_x/y/z) can be set with --max-grid-size and is
+the same for every run, so that in weak scaling the number of boxes grows with the
+cores. Plot files, checkpoints and the steady-state test are switched off.
+
+The results of each run are stored as <results>/<label>/<case>_<mode>.json, with the
+label defaulting to the date and the git commit of the tree, so that later builds can
+be compared:
+
+  ./scaling.py run incflo3d.gnu.MPI.OMP.ex benchmark.channel_cylinder \\
+      --mode strong --configs 1x1 2x1 4x1 4x2 --steps 20 --max-grid-size 32
+  ./scaling.py report scaling_results/<label>/channel_cylinder_strong.json
+  ./scaling.py compare scaling_results/<old>/channel_cylinder_strong.json \\
+      scaling_results/<new>/channel_cylinder_strong.json
+
+The efficiency of a configuration is relative to the first one: t0 * c0 / (t * c) in
+strong scaling and t0 / t in weak scaling, with t the time of a step (slowest rank,
+averaged over the timed steps) and c the number of cores (ranks x threads).
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import shlex
+import subprocess
+import sys
+
+# Phases of the performance log shown in the tables (see src/utilities/PerfLog.H)
+PHASES = ["ugradu", "mac_projection", "divtau", "diffusion", "nodal_projection", "fill_vel_bc"]
+
+
+def read_inputs(filename):
+    """Parameters of an AMReX inputs file, as lists of strings."""
+    params = {}
+    with open(filename) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if "=" not in line:
+                continue
+            key, value = line.split("=", 1)
+            params[key.strip()] = value.split()
+    return params
+
+
+def parse_config(text):
+    """'4x2' is 4 MPI ranks with 2 OpenMP threads each."""
+    ranks, _, threads = text.partition("x")
+    return int(ranks), int(threads or 1)
+
+
+def prime_factors(n):
+    factors = []
+    p = 2
+    while p * p <= n:
+        while n % p == 0:
+            factors.append(p)
+            n //= p
+        p += 1
+    if n > 1:
+        factors.append(n)
+    return factors
+
+
+def weak_n_cell(n_cell, factor):
+    """Refine n_cell by an integer factor in total, one prime factor at a time in the
+    direction refined least so far, so that the cells stay as close to cubes as possible."""
+    ratio = [1] * len(n_cell)
+    for p in sorted(prime_factors(factor), reverse=True):
+        d = min(range(len(n_cell)), key=lambda d: ratio[d])
+        ratio[d] *= p
+    return [n * r for n, r in zip(n_cell, ratio)]
+
+
+def read_perf_log(filename, skip):
+    """Average of the timings of the steps of a performance log, skipping the first ones.
+
+    A log appended to by several runs, as by the two runs of a restart test, is split
+    into one run wherever the step number does not increase, and the first steps of
+    each run are skipped.
+    """
+    runs = []
+    last_step = None
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                record = json.loads(line)
+                if last_step is None or record["step"] <= last_step:
+                    runs.append([])
+                runs[-1].append(record)
+                last_step = record["step"]
+    timed = [r for run in runs for r in run[skip:]]
+    if not timed:
+        raise RuntimeError("{}: no steps left to time after skipping {} per run".format(filename, skip))
+
+    def mean(values):
+        return sum(values) / len(values)
+
+    # The slowest rank sets the pace of a step: the maximum of [min, avg, max]
+    summary = {
+        "steps": len(timed),
+        "step": mean([r["phases"]["step"][2] for r in timed]),
+        "phases": {},
+        "solves": {},
+        "mem_hwm": max(r["mem_hwm"][2] for r in timed),
+    }
+    for phase in timed[0]["phases"]:
+        summary["phases"][phase] = mean([r["phases"][phase][2] for r in timed])
+        summary["phases"][phase + "_imbalance"] = mean(
+            [r["phases"][phase][2] / r["phases"][phase][1] for r in timed if r["phases"][phase][1] > 0]
+            or [1.0])
+    iters = {}
+    for r in timed:
+        for s in r["solves"]:
+            iters.setdefault(s["name"], []).append(s["iters"])
+    for name, its in iters.items():
+        summary["solves"][name] = mean(its)
+    return summary
+
+
+def default_label():
+    top = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    try:
+        commit = subprocess.check_output(["git", "describe", "--always", "--dirty"], cwd=top,
+                                         stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        commit = "unknown"
+    return datetime.datetime.now().strftime("%Y%m%d-%H%M%S") + "_" + commit
+
+
+def run(args):
+    inputs = os.path.abspath(args.inputs)
+    executable = os.path.abspath(args.executable)
+    params = read_inputs(inputs)
+    base_n_cell = [int(n) for n in params["amr.n_cell"]]
+    case = os.path.basename(inputs).split(".", 1)[-1]
+    configs = [parse_config(c) for c in args.configs]
+    base_cores = configs[0][0] * configs[0][1]
+
+    label = args.label or default_label()
+    outdir = os.path.join(os.path.abspath(args.results), label)
+    os.makedirs(outdir, exist_ok=True)
+
+    result = {
+        "label": label,
+        "date": datetime.datetime.now().isoformat(timespec="seconds"),
+        "host": platform.node(),
+        "executable": executable,
+        "inputs": inputs,
+        "case": case,
+        "mode": args.mode,
+        "steps": args.steps,
+        "skip": args.skip,
+        "runs": [],
+    }
+
+    for ranks, threads in configs:
+        cores = ranks * threads
+        n_cell = base_n_cell
+        if args.mode == "weak":
+            if cores % base_cores != 0:
+                sys.exit("weak scaling needs core counts that are multiples of the first one ({})"
+                         .format(base_cores))
+            n_cell = weak_n_cell(base_n_cell, cores // base_cores)
+
+        rundir = os.path.join(outdir, "{}_{}".format(case, args.mode), "np{}_nt{}".format(ranks, threads))
+        os.makedirs(rundir, exist_ok=True)
+        perf_log = os.path.join(rundir, "perf.jsonl")
+        if os.path.exists(perf_log):
+            os.remove(perf_log)
+
+        overrides = [
+            "amr.n_cell=" + " ".join(str(n) for n in n_cell),
+            "max_step={}".format(args.steps + args.skip),
+            "stop_time=-1",
+            "steady_state=0",
+            "amr.plot_int=-1",
+            "amr.plot_per=-1",
+            "amr.check_int=-1",
+            # ParmParse needs a value: an empty quoted string (no shell strips the quotes)
+            'amr.restart=""',
+            "incflo.perf_log=" + perf_log,
+        ]
+        if args.max_grid_size:
+            overrides.append("amr.max_grid_size={}".format(args.max_grid_size))
+            for d in "xyz":
+                if "amr.max_grid_size_" + d in params:
+                    overrides.append("amr.max_grid_size_{}={}".format(d, args.max_grid_size))
+        overrides += args.extra
+
+        command = [executable, inputs] + overrides
+        if ranks > 1 or args.mpirun_always:
+            command = shlex.split(args.mpirun.format(np=ranks)) + command
+        env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+
+        print("Running {} ranks x {} threads, n_cell = {}".format(ranks, threads, n_cell), flush=True)
+        with open(os.path.join(rundir, "output.txt"), "w") as out:
+            status = subprocess.call(command, cwd=rundir, env=env, stdout=out, stderr=subprocess.STDOUT)
+        if status != 0:
+            sys.exit("run failed with status {}, see {}".format(status, os.path.join(rundir, "output.txt")))
+
+        summary = read_perf_log(perf_log, args.skip)
+        summary.update({
+            "ranks": ranks,
+            "threads": threads,
+            "cores": cores,
+            "n_cell": n_cell,
+            "cells": product(n_cell),
+        })
+        result["runs"].append(summary)
+
+    filename = os.path.join(outdir, "{}_{}.json".format(case, args.mode))
+    with open(filename, "w") as f:
+        json.dump(result, f, indent=1)
+    print("\nResults stored in " + filename + "\n")
+
+    report(result)
+    if args.compare:
+        compare(load(args.compare), result, args.tolerance)
+
+
+def product(values):
+    p = 1
+    for v in values:
+        p *= v
+    return p
+
+
+def load(filename):
+    with open(filename) as f:
+        return json.load(f)
+
+
+def efficiency(result, run, time):
+    """Efficiency of a time of a run, relative to the same time of the first run."""
+    first = result["runs"][0]
+    t0 = time(first)
+    t = time(run)
+    if t <= 0.0:
+        return float("nan")
+    if result["mode"] == "strong":
+        return t0 * first["cores"] / (t * run["cores"])
+    return t0 / t
+
+
+def report(result):
+    print("{} scaling of {} ({}), {} timed steps".format(
+        result["mode"].capitalize(), result["case"], result["label"], result["runs"][0]["steps"]))
+    print("{:>6} {:>8} {:>6} {:>14} {:>10} {:>12} {:>8} {:>10}".format(
+        "ranks", "threads", "cores", "n_cell", "s/step", "Mcells/s/c", "eff", "mem MB"))
+    for run in result["runs"]:
+        throughput = run["cells"] / run["step"] / run["cores"] * 1.0e-6
+        print("{:>6} {:>8} {:>6} {:>14} {:>10.4f} {:>12.3f} {:>8.2f} {:>10.1f}".format(
+            run["ranks"], run["threads"], run["cores"], "x".join(str(n) for n in run["n_cell"]),
+            run["step"], throughput, efficiency(result, run, lambda r: r["step"]),
+            run["mem_hwm"] / 2.0**20))
+
+    # Efficiency and load imbalance (slowest / average rank) of each phase
+    print("\nPhase efficiency (load imbalance)")
+    phases = [p for p in PHASES if p in result["runs"][0]["phases"]]
+    print("{:>6} {:>8}".format("ranks", "threads") + "".join(" {:>17}".format(p) for p in phases))
+    for run in result["runs"]:
+        line = "{:>6} {:>8}".format(run["ranks"], run["threads"])
+        for p in phases:
+            line += " {:>9.2f} ({:>5.2f})".format(efficiency(result, run, lambda r: r["phases"][p]),
+                                                run["phases"][p + "_imbalance"])
+        print(line)
+
+    # The MLMG iterations should not change in strong scaling, and grow slowly in weak scaling
+    solves = sorted(result["runs"][0]["solves"])
+    if solves:
+        print("\nAverage MLMG iterations")
+        print("{:>6} {:>8}".format("ranks", "threads") + "".join(" {:>14}".format(s) for s in solves))
+        for run in result["runs"]:
+            print("{:>6} {:>8}".format(run["ranks"], run["threads"]) +
+                  "".join(" {:>14.1f}".format(run["solves"].get(s, float("nan"))) for s in solves))
+    print()
+
+
+def compare(old, new, tolerance):
+    """Time of a step and of the phases of new relative to old, for the configurations of both.
+    Returns the number of configurations slower than 1 + tolerance."""
+    print("Comparison of {} (new) with {} (old), time new / old".format(new["label"], old["label"]))
+    phases = [p for p in PHASES if p in new["runs"][0]["phases"]]
+    print("{:>6} {:>8} {:>8}".format("ranks", "threads", "step") + "".join(" {:>16}".format(p) for p in phases))
+    old_runs = {(r["ranks"], r["threads"], tuple(r["n_cell"])): r for r in old["runs"]}
+    slower = 0
+    for run in new["runs"]:
+        ref = old_runs.get((run["ranks"], run["threads"], tuple(run["n_cell"])))
+        if ref is None:
+            continue
+        ratio = run["step"] / ref["step"]
+        flag = ""
+        if ratio > 1.0 + tolerance:
+            flag = "  slower"
+            slower += 1
+        print("{:>6} {:>8} {:>8.3f}".format(run["ranks"], run["threads"], ratio) +
+              "".join(" {:>16.3f}".format(run["phases"][p] / ref["phases"][p] if ref["phases"][p] > 0 else float("nan"))
+                      for p in phases) + flag)
+    print()
+    return slower
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    p = sub.add_parser("run", help="run a scaling study")
+    p.add_argument("executable", help="incflo executable")
+    p.add_argument("inputs", help="inputs file (test/benchmark.* or exec/inputs.*)")
+    p.add_argument("--mode", choices=["strong", "weak"], default="strong")
+    p.add_argument("--configs", nargs="+", default=["1x1", "2x1", "4x1"],
+                   help="MPI ranks x OpenMP threads of each run, the first being the reference")
+    p.add_argument("--steps", type=int, default=10, help="number of timed steps")
+    p.add_argument("--skip", type=int, default=2, help="number of untimed steps before them")
+    p.add_argument("--max-grid-size", type=int, default=0, help="amr.max_grid_size of all the runs")
+    p.add_argument("--mpirun", default="mpiexec -n {np}", help="MPI launcher, {np} is the number of ranks")
+    p.add_argument("--mpirun-always", action="store_true", help="use the MPI launcher for a single rank too")
+    p.add_argument("--results", default="scaling_results", help="directory of the results")
+    p.add_argument("--label", default="", help="name of this build in the results (default: date and commit)")
+    p.add_argument("--compare", default="", help="results of an earlier build to compare with")
+    p.add_argument("--tolerance", type=float, default=0.05, help="relative slowdown flagged by --compare")
+    p.add_argument("extra", nargs="*", help="additional inputs parameters, e.g. incflo.verbose=0")
+
+    p = sub.add_parser("report", help="print the tables of stored results")
+    p.add_argument("results", nargs="+")
+
+    p = sub.add_parser("compare", help="compare the stored results of two builds")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("--tolerance", type=float, default=0.05, help="relative slowdown flagged as slower")
+
+    args = parser.parse_args()
+    if args.command == "run":
+        run(args)
+    elif args.command == "report":
+        for filename in args.results:
+            report(load(filename))
+    else:
+        sys.exit(1 if compare(load(args.old), load(args.new), args.tolerance) else 0)
+
+
+if __name__ == "__main__":
+    main()